@@ -0,0 +1,932 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Arena-backed configuration with interned parameter names
+ *
+ */
+
+
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <memory>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Bump allocator.
+        *
+        *  Memory is handed out from large blocks and is released all at once
+        *  when the arena is destroyed. Allocated memory never moves.
+        */
+        class bumpArena
+        {
+        public:
+
+           /*!
+            *  \param w_blockSize Size of the first block in bytes. Subsequent
+            *                     blocks double in size.
+            */
+            explicit bumpArena(size_t w_blockSize = 4096) : blockSize(w_blockSize > 64? w_blockSize : 64)
+            {
+            }
+
+            bumpArena(bumpArena&&) = default;
+            bumpArena& operator=(bumpArena&&) = default;
+
+           /*!
+            *  \brief  Allocates uninitialized memory
+            *
+            *  \param  w_size  Number of bytes
+            *  \param  w_align Alignment (power of two)
+            *  \return Pointer to the memory
+            */
+            void * allocate(size_t w_size, size_t w_align)
+            {
+                size_t pad = (w_align - (reinterpret_cast<uintptr_t>(current) & (w_align - 1))) & (w_align - 1);
+
+                if(current == nullptr || pad + w_size > left)
+                {
+                    if(!blocks.empty())
+                    {
+                        blockSize *= 2;
+                    }
+
+                    size_t size = std::max(blockSize, w_size + w_align);
+                    blocks.emplace_back(new char[size]);
+                    current  = blocks.back().get();
+                    left     = size;
+                    reserved += size;
+                    pad      = (w_align - (reinterpret_cast<uintptr_t>(current) & (w_align - 1))) & (w_align - 1);
+                }
+
+                char *ptr = current + pad;
+                current  += pad + w_size;
+                left     -= pad + w_size;
+                return ptr;
+            }
+
+           /*!
+            *  \brief  Copies an array into the arena
+            */
+            template<typename T>
+            const T * copy(const T *w_data, size_t w_count)
+            {
+                T *ptr = static_cast<T*>(allocate(w_count * sizeof(T), alignof(T)));
+
+                if(w_count > 0)
+                {
+                    memcpy(ptr, w_data, w_count * sizeof(T));
+                }
+
+                return ptr;
+            }
+
+           /*!
+            *  \brief  Copies a string into the arena
+            */
+            std::string_view copy(std::string_view w_string)
+            {
+                return std::string_view(copy(w_string.data(), w_string.size()), w_string.size());
+            }
+
+           /*!
+            *  \brief Total size of the allocated blocks in bytes
+            */
+            size_t capacity() const
+            {
+                return reserved;
+            }
+
+           /*!
+            *  \brief Number of allocated blocks
+            */
+            size_t blockCount() const
+            {
+                return blocks.size();
+            }
+
+        private:
+            std::vector<std::unique_ptr<char[]>> blocks;
+            char   *current  = nullptr;
+            size_t  left     = 0;
+            size_t  reserved = 0;
+            size_t  blockSize;
+        };
+
+       /*!
+        *  \brief Configuration value stored in a bumpArena.
+        *
+        *  Numeric and boolean scalars are stored in place. Strings and arrays
+        *  point into the arena of the owning arenaConfig.
+        */
+        struct arenaValue
+        {
+            config_struct::type_ type  = config_struct::type_::NO_VAL;
+            uint32_t             count = 0;    // Number of elements
+
+            union
+            {
+                int                     intVal;
+                float                   floatVal;
+                uint8_t                 boolVal;
+                int64_t                 int64Val;
+                uint64_t                uint64Val;
+                double                  doubleVal;
+                const void             *data;
+            };
+
+            arenaValue() : data(nullptr) {}
+
+            arrayView<int> intArray() const
+            {
+                return view(intVal);
+            }
+
+            arrayView<float> floatArray() const
+            {
+                return view(floatVal);
+            }
+
+            arrayView<uint8_t> boolArray() const
+            {
+                return view(boolVal);
+            }
+
+            arrayView<int64_t> int64Array() const
+            {
+                return view(int64Val);
+            }
+
+            arrayView<uint64_t> uint64Array() const
+            {
+                return view(uint64Val);
+            }
+
+            arrayView<double> doubleArray() const
+            {
+                return view(doubleVal);
+            }
+
+            arrayView<std::string_view> stringArray() const
+            {
+                return arrayView<std::string_view>{static_cast<const std::string_view*>(data), count};
+            }
+
+            int getInt(size_t n = 0) const
+            {
+                return intArray()[n];
+            }
+
+            float getFloat(size_t n = 0) const
+            {
+                return floatArray()[n];
+            }
+
+            bool getBool(size_t n = 0) const
+            {
+                return boolArray()[n];
+            }
+
+            // Integers of any width and (for getDouble) floats are converted (see convertNumber)
+            int64_t getInt64(size_t n = 0) const
+            {
+                return number<int64_t>(n);
+            }
+
+            uint64_t getUint64(size_t n = 0) const
+            {
+                return number<uint64_t>(n);
+            }
+
+            double getDouble(size_t n = 0) const
+            {
+                return number<double>(n);
+            }
+
+            std::string_view getString(size_t n = 0) const
+            {
+                return stringArray()[n];
+            }
+
+        private:
+
+            // Typed view of a scalar (stored in place) or an array
+            template<typename T>
+            arrayView<T> view(const T &w_scalar) const
+            {
+                if(type != typeOf<T>())
+                {
+                    return arrayView<T>();
+                }
+
+                return arrayView<T>{count == 1? &w_scalar : static_cast<const T*>(data), count};
+            }
+
+            template<typename T>
+            T number(size_t n) const
+            {
+                typedef config_struct::type_ type_;
+
+                switch(type)
+                {
+                    case type_::INTEGER: return convertNumber<T>(intArray()[n]);
+                    case type_::FLOAT:   return convertNumber<T>(floatArray()[n]);
+                    case type_::INT64:   return convertNumber<T>(int64Array()[n]);
+                    case type_::UINT64:  return convertNumber<T>(uint64Array()[n]);
+                    case type_::DOUBLE:  return convertNumber<T>(doubleArray()[n]);
+                    default:             return 0;
+                }
+            }
+        };
+
+       /*!
+        *  \brief Parsed configuration whose names and values live in a single
+        *         bumpArena.
+        *
+        *  Parameter names are stored as a tree of interned name segments. Every
+        *  segment (e.g. "GlossDiv" in "glossary.GlossDiv.title") is stored once
+        *  for all parameters sharing the same prefix. Values are looked up by
+        *  their full parameter name, or through views of subtrees (see
+        *  configView).
+        */
+        class configView;
+
+        class arenaConfig
+        {
+        public:
+            static constexpr uint32_t npos = UINT32_MAX;
+
+           /*!
+            *  \brief A segment of a parameter name
+            */
+            struct node
+            {
+                std::string_view name;
+                uint32_t         parent;                // npos for top-level parameters
+                uint32_t         value;                 // Index of the value or npos
+                uint32_t         firstChild  = npos;    // Children in the order of the text
+                uint32_t         lastChild   = npos;
+                uint32_t         nextSibling = npos;
+                uint32_t         childCount  = 0;
+            };
+
+           /*!
+            *  \param w_sizeHint Expected size of the names and values in bytes
+            */
+            explicit arenaConfig(size_t w_sizeHint = 4096) : arena(w_sizeHint)
+            {
+            }
+
+            arenaConfig(arenaConfig&&) = default;
+            arenaConfig& operator=(arenaConfig&&) = default;
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const arenaValue * find(std::string_view w_name) const
+            {
+                uint32_t n = findNode(w_name);
+                return n == npos || nodes[n].value == npos? nullptr : &values[nodes[n].value];
+            }
+
+           /*!
+            *  \brief  Finds the node of a full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Index of the node or npos if it does not exist
+            */
+            uint32_t findNode(std::string_view w_name) const
+            {
+                return findNode(npos, w_name);
+            }
+
+           /*!
+            *  \brief  Finds the node of a parameter name relative to a node
+            *
+            *  \param  w_node Node the name is relative to (npos for the root)
+            *  \param  w_name Relative parameter name, e.g. "GlossList.title"
+            *  \return Index of the node or npos if it does not exist
+            */
+            uint32_t findNode(uint32_t w_node, std::string_view w_name) const
+            {
+                uint32_t n = w_node;
+
+                while(true)
+                {
+                    size_t dot = w_name.find('.');
+                    n = child(n, w_name.substr(0, dot));
+
+                    if(n == npos || dot == std::string_view::npos)
+                    {
+                        return n;
+                    }
+
+                    w_name.remove_prefix(dot + 1);
+                }
+            }
+
+           /*!
+            *  \brief  Adds a value
+            *
+            *  \param  w_node   Node of the parameter
+            *  \param  w_config Configuration value
+            *  \return Flag indicates whether the value is added (i.e. the
+            *          parameter had no value before)
+            */
+            bool insert(uint32_t w_node, const config_struct &w_config)
+            {
+                if(nodes[w_node].value != npos)
+                {
+                    return false;
+                }
+
+                arenaValue value;
+                value.type = w_config.type;
+
+                switch(w_config.type)
+                {
+                    case config_struct::type_::STRING:
+                    {
+                        value.count = (uint32_t)w_config.stringVal.size();
+                        auto *strings = static_cast<std::string_view*>(arena.allocate(value.count * sizeof(std::string_view),
+                                                                                     alignof(std::string_view)));
+
+                        for(uint32_t n=0; n<value.count; n++)
+                        {
+                            new (&strings[n]) std::string_view(arena.copy(std::string_view(w_config.stringVal[n])));
+                        }
+
+                        value.data = strings;
+                        break;
+                    }
+                    case config_struct::type_::BOOLEAN:
+                        store(w_config.boolVal, value.boolVal, value);
+                        break;
+                    case config_struct::type_::FLOAT:
+                        store(w_config.floatVal, value.floatVal, value);
+                        break;
+                    case config_struct::type_::INTEGER:
+                        store(w_config.intVal, value.intVal, value);
+                        break;
+                    case config_struct::type_::INT64:
+                        store(w_config.int64Val, value.int64Val, value);
+                        break;
+                    case config_struct::type_::UINT64:
+                        store(w_config.uint64Val, value.uint64Val, value);
+                        break;
+                    case config_struct::type_::DOUBLE:
+                        store(w_config.doubleVal, value.doubleVal, value);
+                        break;
+                    default:
+                        break;
+                }
+
+                nodes[w_node].value = (uint32_t)values.size();
+                values.push_back(value);
+                return true;
+            }
+
+           /*!
+            *  \brief  Finds or adds the child of a node
+            *
+            *  \param  w_parent Parent node (npos for top-level parameters)
+            *  \param  w_name   Name of the child. Names containing '.' add a
+            *                   node per segment.
+            *  \return Index of the child node
+            */
+            uint32_t intern(uint32_t w_parent, std::string_view w_name)
+            {
+                size_t dot;
+
+                while((dot = w_name.find('.')) != std::string_view::npos)
+                {
+                    w_parent = intern(w_parent, w_name.substr(0, dot));
+                    w_name.remove_prefix(dot + 1);
+                }
+
+                if(2 * (nodes.size() + 1) > slots.size())
+                {
+                    rehash(slots.empty()? 64 : 2 * slots.size());
+                }
+
+                size_t mask = slots.size() - 1;
+
+                for(size_t i = hash(w_parent, w_name) & mask; ; i = (i + 1) & mask)
+                {
+                    if(slots[i] == npos)
+                    {
+                        uint32_t n = (uint32_t)nodes.size();
+                        uint32_t &last = w_parent == npos? rootLast : nodes[w_parent].lastChild;
+
+                        (last == npos? (w_parent == npos? rootFirst : nodes[w_parent].firstChild) : nodes[last].nextSibling) = n;
+                        last = n;
+                        (w_parent == npos? rootCount : nodes[w_parent].childCount)++;
+
+                        slots[i] = n;
+                        nodes.push_back({arena.copy(w_name), w_parent, npos});
+                        return n;
+                    }
+
+                    const node &n = nodes[slots[i]];
+
+                    if(n.parent == w_parent && n.name == w_name)
+                    {
+                        return slots[i];
+                    }
+                }
+            }
+
+           /*!
+            *  \brief  Full parameter name of a node
+            */
+            std::string fullName(uint32_t w_node) const
+            {
+                std::string name;
+
+                for(uint32_t n = w_node; n != npos; n = nodes[n].parent)
+                {
+                    name.insert(0, nodes[n].name);
+
+                    if(nodes[n].parent != npos)
+                    {
+                        name.insert(0, 1, '.');
+                    }
+                }
+
+                return name;
+            }
+
+           /*!
+            *  \brief Calls w_callback(fullName, value) for every parameter with a value
+            */
+            void forEach(const std::function<void(const std::string&, const arenaValue&)> &w_callback) const
+            {
+                for(uint32_t n=0; n<nodes.size(); n++)
+                {
+                    if(nodes[n].value != npos)
+                    {
+                        w_callback(fullName(n), values[nodes[n].value]);
+                    }
+                }
+            }
+
+           /*!
+            *  \brief Number of parameters with a value
+            */
+            size_t size() const
+            {
+                return values.size();
+            }
+
+            const std::vector<node> & nodeList() const
+            {
+                return nodes;
+            }
+
+            const bumpArena & memory() const
+            {
+                return arena;
+            }
+
+           /*!
+            *  \brief  View of the whole configuration
+            */
+            configView root() const;
+
+           /*!
+            *  \brief  View of the subtree of a parameter
+            *
+            *  \param  w_name Full parameter name, e.g. "glossary.GlossDiv"
+            *  \return View, which is not valid() if the parameter does not exist
+            */
+            configView view(std::string_view w_name) const;
+
+            const arenaValue & value(uint32_t w_index) const
+            {
+                return values[w_index];
+            }
+
+        private:
+            friend class configView;
+
+            // Child of a node, or npos
+            uint32_t child(uint32_t w_parent, std::string_view w_name) const
+            {
+                if(slots.empty())
+                {
+                    return npos;
+                }
+
+                size_t mask = slots.size() - 1;
+
+                for(size_t i = hash(w_parent, w_name) & mask; slots[i] != npos; i = (i + 1) & mask)
+                {
+                    const node &n = nodes[slots[i]];
+
+                    if(n.parent == w_parent && n.name == w_name)
+                    {
+                        return slots[i];
+                    }
+                }
+
+                return npos;
+            }
+
+            static size_t hash(uint32_t w_parent, std::string_view w_name)
+            {
+                return std::hash<std::string_view>()(w_name) ^ ((size_t)w_parent * 0x9E3779B97F4A7C15ull);
+            }
+
+            void rehash(size_t w_slots)
+            {
+                slots.assign(w_slots, npos);
+
+                for(uint32_t n=0; n<nodes.size(); n++)
+                {
+                    size_t i = hash(nodes[n].parent, nodes[n].name) & (w_slots - 1);
+
+                    while(slots[i] != npos)
+                    {
+                        i = (i + 1) & (w_slots - 1);
+                    }
+
+                    slots[i] = n;
+                }
+            }
+
+            // Stores a scalar in place, or an array in the arena
+            template<typename T>
+            void store(const std::vector<T> &w_vals, T &w_scalar, arenaValue &w_value)
+            {
+                w_value.count = (uint32_t)w_vals.size();
+
+                if(w_vals.size() == 1)
+                {
+                    w_scalar = w_vals[0];
+                }
+                else
+                {
+                    w_value.data = arena.copy(w_vals.data(), w_vals.size());
+                }
+            }
+
+            bumpArena               arena;
+            std::vector<node>       nodes;
+            std::vector<uint32_t>   slots;     // Open-addressing index of nodes by (parent, name)
+            std::vector<arenaValue> values;
+            uint32_t                rootFirst = npos;   // Top-level parameters
+            uint32_t                rootLast  = npos;
+            uint32_t                rootCount = 0;
+        };
+
+       /*!
+        *  \brief Non-owning view of a subtree of an arenaConfig.
+        *
+        *  A view is a pointer to the configuration and a node index: it is
+        *  copied freely and stays valid as long as the configuration exists
+        *  (and no parameters are added). Children are linked in the order of
+        *  the text, so iterating over them or looking one up does not scan
+        *  the rest of the configuration:
+        *
+        *      configView list = config.view("glossary.GlossDiv.GlossList");
+        *
+        *      for(configView entry : list)
+        *      {
+        *          const arenaValue *term = entry.find("GlossTerm");
+        *          ...
+        *      }
+        */
+        class configView
+        {
+        public:
+            static constexpr uint32_t npos = arenaConfig::npos;
+
+            configView() = default;
+
+            configView(const arenaConfig *w_config, uint32_t w_node) : config(w_config), node(w_node)
+            {
+            }
+
+           /*!
+            *  \brief Flag indicates whether the view refers to a subtree (a
+            *         lookup of a missing parameter gives an invalid view)
+            */
+            bool valid() const
+            {
+                return config != nullptr;
+            }
+
+            bool isRoot() const
+            {
+                return valid() && node == npos;
+            }
+
+           /*!
+            *  \brief Last segment of the parameter name (empty for the root)
+            */
+            std::string_view name() const
+            {
+                return isRoot()? std::string_view() : config->nodes[node].name;
+            }
+
+           /*!
+            *  \brief Full parameter name (built on every call)
+            */
+            std::string fullName() const
+            {
+                return isRoot()? std::string() : config->fullName(node);
+            }
+
+           /*!
+            *  \brief Value of the parameter, or nullptr if it has none
+            */
+            const arenaValue * value() const
+            {
+                if(!valid() || node == npos || config->nodes[node].value == npos)
+                {
+                    return nullptr;
+                }
+
+                return &config->values[config->nodes[node].value];
+            }
+
+           /*!
+            *  \brief  View of a parameter below this one
+            *
+            *  \param  w_name Relative parameter name, e.g. "GlossList.title"
+            *  \return View, which is not valid() if the parameter does not exist
+            */
+            configView at(std::string_view w_name) const
+            {
+                if(!valid())
+                {
+                    return configView();
+                }
+
+                uint32_t n = config->findNode(node, w_name);
+                return n == npos? configView() : configView(config, n);
+            }
+
+           /*!
+            *  \brief  Finds the value of a parameter below this one
+            *
+            *  \param  w_name Relative parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const arenaValue * find(std::string_view w_name) const
+            {
+                return at(w_name).value();
+            }
+
+            configView parent() const
+            {
+                return isRoot() || !valid()? configView() : configView(config, config->nodes[node].parent);
+            }
+
+            size_t childCount() const
+            {
+                return !valid()? 0 : isRoot()? config->rootCount : config->nodes[node].childCount;
+            }
+
+           /*!
+            *  \brief Iterator over the children of a view
+            */
+            class iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = configView;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = const configView*;
+                using reference         = configView;
+
+                iterator(const arenaConfig *w_config, uint32_t w_node) : config(w_config), node(w_node)
+                {
+                }
+
+                configView operator*() const
+                {
+                    return configView(config, node);
+                }
+
+                iterator & operator++()
+                {
+                    node = config->nodes[node].nextSibling;
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator it = *this;
+                    ++(*this);
+                    return it;
+                }
+
+                bool operator==(const iterator &w_other) const
+                {
+                    return node == w_other.node;
+                }
+
+                bool operator!=(const iterator &w_other) const
+                {
+                    return node != w_other.node;
+                }
+
+            private:
+                const arenaConfig *config;
+                uint32_t           node;
+            };
+
+            iterator begin() const
+            {
+                uint32_t first = !valid()? npos : isRoot()? config->rootFirst : config->nodes[node].firstChild;
+                return iterator(config, first);
+            }
+
+            iterator end() const
+            {
+                return iterator(config, npos);
+            }
+
+           /*!
+            *  \brief Calls w_callback(view) for every parameter with a value in
+            *         the subtree (this one included), in the order of the text
+            *         of their first appearance
+            */
+            template<typename Callback>
+            void forEachValue(Callback w_callback) const
+            {
+                if(!valid())
+                {
+                    return;
+                }
+
+                if(value() != nullptr)
+                {
+                    w_callback(*this);
+                }
+
+                // Pre-order walk along the child and sibling links
+                uint32_t n = isRoot()? config->rootFirst : config->nodes[node].firstChild;
+
+                while(n != npos)
+                {
+                    const arenaConfig::node &current = config->nodes[n];
+
+                    if(current.value != npos)
+                    {
+                        w_callback(configView(config, n));
+                    }
+
+                    if(current.firstChild != npos)
+                    {
+                        n = current.firstChild;
+                        continue;
+                    }
+
+                    // Climb until a node with a next sibling, without leaving the subtree
+                    while(n != npos && n != node && config->nodes[n].nextSibling == npos)
+                    {
+                        n = config->nodes[n].parent;
+                    }
+
+                    n = n == npos || n == node? npos : config->nodes[n].nextSibling;
+                }
+            }
+
+            bool operator==(const configView &w_other) const
+            {
+                return config == w_other.config && node == w_other.node;
+            }
+
+            bool operator!=(const configView &w_other) const
+            {
+                return !(*this == w_other);
+            }
+
+        private:
+            const arenaConfig *config = nullptr;
+            uint32_t           node   = npos;
+        };
+
+        inline configView arenaConfig::root() const
+        {
+            return configView(this, npos);
+        }
+
+        inline configView arenaConfig::view(std::string_view w_name) const
+        {
+            uint32_t n = findNode(w_name);
+            return n == npos? configView() : configView(this, n);
+        }
+
+       /*!
+        *  \brief Parse event handler which adds every parameter to an
+        *         arenaConfig
+        */
+        struct arenaConfigBuilder : parseHandler
+        {
+            explicit arenaConfigBuilder(arenaConfig &w_config) : config(w_config)
+            {
+            }
+
+            bool onEnterSection(std::string_view w_fullName)
+            {
+                // The last segment follows the name of the parent and a '.'
+                size_t           parentLength = nameLengths.empty()? 0 : nameLengths.back() + 1;
+                std::string_view param        = w_fullName.substr(parentLength);
+
+                nodeHistory.push_back(config.intern(nodeHistory.empty()? arenaConfig::npos : nodeHistory.back(), param));
+                nameLengths.push_back(w_fullName.size());
+                return true;
+            }
+
+            bool onLeaveSection(std::string_view)
+            {
+                nodeHistory.pop_back();
+                nameLengths.pop_back();
+                return true;
+            }
+
+            bool onValue(std::string_view, config_struct &w_value)
+            {
+                config.insert(nodeHistory.back(), w_value);
+                return true;
+            }
+
+            arenaConfig           &config;
+            std::vector<uint32_t>  nodeHistory;
+            std::vector<size_t>    nameLengths;
+        };
+
+       /*!
+        *  \brief  Parses a configuration held in memory into an arenaConfig
+        *
+        *  The result is the same as for parseBuffer, but all names and values
+        *  are stored in the arena of the returned object. Problems are
+        *  reported with their line, and a strict diagnostic collector stops
+        *  parsing at the first error, as for parseBuffer.
+        *
+        *  \param  w_buffer Configuration text (owned by the caller)
+        *  \return Parsed configuration
+        */
+        static arenaConfig parseBufferToArena(std::string_view w_buffer)
+        {
+            arenaConfig        config(w_buffer.size() / 2 + 64);
+            arenaConfigBuilder builder(config);
+
+            parseBufferEvents(w_buffer, builder);
+            return config;
+        }
+
+       /*!
+        *  \brief  Parses a configuration file into an arenaConfig
+        *
+        *  \param  w_fileName Configuration file name
+        *  \return Parsed configuration
+        */
+        static arenaConfig parseFileToArena(const std::string &w_fileName)
+        {
+            mappedFile file;
+
+            if(!file.open(w_fileName))
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return arenaConfig();
+            }
+
+            return parseBufferToArena(file.view());
+        }
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,691 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Precompiled binary configuration images
+ *
+ */
+
+
+#pragma once
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Header of a binary configuration image.
+        *
+        *  An image consists of the header followed by four regions:
+        *   - buckets: bucketCount + 1 entry indices. The entries of bucket b
+        *     are [buckets[b], buckets[b+1]).
+        *   - entries: entryCount binaryValue records, grouped by bucket
+        *   - values:  typed arrays (int32, float, uint8, int64, uint64, double
+        *     and, for strings, pairs of offset and length in the string table)
+        *   - strings: parameter names, raw value strings and string values
+        *
+        *  All numbers are in the byte order of the machine that compiled the
+        *  image; an image of the other byte order is rejected.
+        */
+        struct binaryHeader
+        {
+            char     magic[8];          // "YCONFBIN"
+            uint32_t version;
+            uint32_t byteOrder;         // 0x01020304
+            uint64_t size;              // Size of the image in bytes
+            uint64_t checksum;          // hashString() of everything after the header
+            uint32_t entryCount;
+            uint32_t bucketCount;       // Power of two
+            uint64_t bucketsOffset;
+            uint64_t entriesOffset;
+            uint64_t valuesOffset;
+            uint64_t stringsOffset;
+        };
+
+        static_assert(sizeof(binaryHeader) == 72, "binaryHeader is expected to be 72 bytes");
+
+        // Raised whenever the parser reads the same text differently (2: typed
+        // 64-bit integers, hexadecimal and suffixed numbers), so that older
+        // images and cache entries are not loaded
+        static constexpr uint32_t binaryVersion   = 2;
+        static constexpr uint32_t binaryByteOrder = 0x01020304;
+
+       /*!
+        *  \brief A parameter of a binary configuration image
+        */
+        struct binaryValue
+        {
+            uint64_t hash;              // hashString() of the name
+            uint32_t nameOffset;        // Offset of the name in the string table
+            uint32_t nameLength;
+            uint32_t rawOffset;         // Offset of the raw value string in the string table
+            uint32_t rawLength;
+            uint32_t valueOffset;       // Offset of the values in the value region
+            uint32_t count;             // Number of values
+            uint8_t  type;
+            uint8_t  reserved[7];
+        };
+
+        static_assert(sizeof(binaryValue) == 40, "binaryValue is expected to be 40 bytes");
+
+       /*!
+        *  \brief  Compiles a configuration list into a binary image
+        *
+        *  \param  w_config Configuration list
+        *  \param  w_image  Binary image
+        *  \return Flag indicates success or failure (the image would exceed
+        *          4 GiB)
+        */
+        static bool compileBinary(const configList &w_config, std::string &w_image)
+        {
+            const size_t align = 8;
+
+            auto padded = [align](size_t w_size) { return (w_size + align - 1) / align * align; };
+
+            // Buckets of about one entry each
+            uint32_t bucketCount = 1;
+
+            while(bucketCount < w_config.size())
+            {
+                bucketCount *= 2;
+            }
+
+            std::vector<binaryValue> entries;
+            std::vector<uint32_t>    bucketStart(bucketCount + 1, 0);
+            std::string              values;
+            std::string              strings;
+
+            entries.reserve(w_config.size());
+
+            auto addString = [&strings](const std::string &w_string)
+            {
+                uint32_t offset = (uint32_t)strings.size();
+                strings += w_string;
+                return offset;
+            };
+
+            auto addValues = [&values](const void *w_data, size_t w_size, size_t w_align)
+            {
+                values.resize((values.size() + w_align - 1) / w_align * w_align);
+                uint32_t offset = (uint32_t)values.size();
+                values.append(static_cast<const char*>(w_data), w_size);
+                return offset;
+            };
+
+            for(auto &c : w_config)
+            {
+                binaryValue e = {};
+                e.hash        = hashString(c.first);
+                e.nameOffset  = addString(c.first);
+                e.nameLength  = (uint32_t)c.first.size();
+                e.rawOffset   = addString(c.second.rawString);
+                e.rawLength   = (uint32_t)c.second.rawString.size();
+                e.type        = (uint8_t)c.second.type;
+
+                switch(c.second.type)
+                {
+                    case config_struct::type_::STRING:
+                    {
+                        std::vector<uint32_t> spans;
+
+                        for(auto &s : c.second.stringVal)
+                        {
+                            spans.push_back(addString(s));
+                            spans.push_back((uint32_t)s.size());
+                        }
+
+                        e.count       = (uint32_t)c.second.stringVal.size();
+                        e.valueOffset = addValues(spans.data(), spans.size() * sizeof(uint32_t), alignof(uint32_t));
+                        break;
+                    }
+                    case config_struct::type_::BOOLEAN:
+                        e.count       = (uint32_t)c.second.boolVal.size();
+                        e.valueOffset = addValues(c.second.boolVal.data(), e.count, 1);
+                        break;
+                    case config_struct::type_::FLOAT:
+                        e.count       = (uint32_t)c.second.floatVal.size();
+                        e.valueOffset = addValues(c.second.floatVal.data(), e.count * sizeof(float), alignof(float));
+                        break;
+                    case config_struct::type_::INTEGER:
+                        e.count       = (uint32_t)c.second.intVal.size();
+                        e.valueOffset = addValues(c.second.intVal.data(), e.count * sizeof(int), alignof(int));
+                        break;
+                    case config_struct::type_::INT64:
+                        e.count       = (uint32_t)c.second.int64Val.size();
+                        e.valueOffset = addValues(c.second.int64Val.data(), e.count * sizeof(int64_t), alignof(int64_t));
+                        break;
+                    case config_struct::type_::UINT64:
+                        e.count       = (uint32_t)c.second.uint64Val.size();
+                        e.valueOffset = addValues(c.second.uint64Val.data(), e.count * sizeof(uint64_t), alignof(uint64_t));
+                        break;
+                    case config_struct::type_::DOUBLE:
+                        e.count       = (uint32_t)c.second.doubleVal.size();
+                        e.valueOffset = addValues(c.second.doubleVal.data(), e.count * sizeof(double), alignof(double));
+                        break;
+                    default:
+                        e.valueOffset = (uint32_t)values.size();
+                        break;
+                }
+
+                bucketStart[(e.hash & (bucketCount - 1)) + 1]++;
+                entries.push_back(e);
+            }
+
+            if(strings.size() > UINT32_MAX || values.size() > UINT32_MAX)
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::IMAGE_TOO_LARGE, nullptr,
+                             "configuration is too large for a binary image\n");
+                return false;
+            }
+
+            binaryHeader header = {};
+            memcpy(header.magic, "YCONFBIN", sizeof(header.magic));
+            header.version       = binaryVersion;
+            header.byteOrder     = binaryByteOrder;
+            header.entryCount    = (uint32_t)entries.size();
+            header.bucketCount   = bucketCount;
+            header.bucketsOffset = padded(sizeof(binaryHeader));
+            header.entriesOffset = header.bucketsOffset + padded((bucketCount + 1) * sizeof(uint32_t));
+            header.valuesOffset  = header.entriesOffset + entries.size() * sizeof(binaryValue);
+            header.stringsOffset = header.valuesOffset + padded(values.size());
+            header.size          = header.stringsOffset + strings.size();
+
+            w_image.assign(header.size, '\0');
+            char *image = &w_image[0];
+
+            // Entries in bucket order (counting sort)
+            for(uint32_t b=0; b<bucketCount; b++)
+            {
+                bucketStart[b + 1] += bucketStart[b];
+            }
+
+            memcpy(image + header.bucketsOffset, bucketStart.data(), bucketStart.size() * sizeof(uint32_t));
+
+            for(auto &e : entries)
+            {
+                uint32_t n = bucketStart[e.hash & (bucketCount - 1)]++;
+                memcpy(image + header.entriesOffset + n * sizeof(binaryValue), &e, sizeof(binaryValue));
+            }
+
+            memcpy(image + header.valuesOffset, values.data(), values.size());
+            memcpy(image + header.stringsOffset, strings.data(), strings.size());
+
+            header.checksum = hashString(std::string_view(image + sizeof(binaryHeader), header.size - sizeof(binaryHeader)));
+            memcpy(image, &header, sizeof(binaryHeader));
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Compiles a configuration list into a binary image file
+        *
+        *  \param  w_config   Configuration list
+        *  \param  w_fileName Image file name
+        *  \return Flag indicates success or failure
+        */
+        static bool writeBinary(const configList &w_config, const std::string &w_fileName)
+        {
+            std::string image;
+
+            if(!compileBinary(w_config, image))
+            {
+                return false;
+            }
+
+            std::ofstream file (w_fileName.c_str(), std::ios::binary | std::ios::trunc);
+
+            if(!file.is_open())
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return false;
+            }
+
+            file.write(image.data(), image.size());
+            file.close();
+
+            return !file.fail();
+        }
+
+       /*!
+        *  \brief Read-only configuration served from a binary image.
+        *
+        *  Lookups hash the name and scan one bucket of the key index, which
+        *  holds about one entry. Values are read from the image in place;
+        *  nothing is parsed or allocated.
+        *
+        *  An image is validated once when it is loaded (header, checksum and
+        *  the bounds of every entry), so a corrupt image is rejected rather
+        *  than read out of bounds.
+        */
+        class binaryConfig
+        {
+        public:
+            binaryConfig() = default;
+            binaryConfig(const binaryConfig&) = delete;
+            binaryConfig& operator=(const binaryConfig&) = delete;
+
+           /*!
+            *  \brief  Maps a binary image file
+            *
+            *  \param  w_fileName Image file name
+            *  \return Flag indicates success or failure (the file cannot be
+            *          read or is not a valid image)
+            */
+            bool open(const std::string &w_fileName)
+            {
+                clear();
+
+                if(!file.open(w_fileName))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", w_fileName.c_str());
+                    return false;
+                }
+
+                std::string_view image = file.view();
+
+                if(!load(image.data(), image.size()))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::INVALID_IMAGE, nullptr,
+                                 "invalid binary configuration %s\n", w_fileName.c_str());
+                    file.close();
+                    return false;
+                }
+
+                return true;
+            }
+
+           /*!
+            *  \brief  Serves lookups from an image held in memory
+            *
+            *  \param  w_image Image, which must outlive the lookups and be
+            *                  aligned to 8 bytes
+            *  \param  w_size  Size of the image in bytes
+            *  \return Flag indicates whether the image is valid
+            */
+            bool load(const void *w_image, size_t w_size)
+            {
+                image = nullptr;
+
+                const char *data = static_cast<const char*>(w_image);
+
+                if(w_size < sizeof(binaryHeader) || reinterpret_cast<uintptr_t>(data) % 8 != 0)
+                {
+                    return false;
+                }
+
+                memcpy(&header, data, sizeof(binaryHeader));
+
+                if(memcmp(header.magic, "YCONFBIN", sizeof(header.magic)) != 0 ||
+                   header.version != binaryVersion || header.byteOrder != binaryByteOrder || header.size != w_size)
+                {
+                    return false;
+                }
+
+                // Every region has to lie inside the image (checked without
+                // overflow, since the offsets are not trusted)
+                auto inside = [this](uint64_t w_offset, uint64_t w_length)
+                {
+                    return w_offset <= header.size && w_length <= header.size - w_offset;
+                };
+
+                const uint64_t bucketsSize = (header.bucketCount + 1ull) * sizeof(uint32_t);
+                const uint64_t entriesSize = (uint64_t)header.entryCount * sizeof(binaryValue);
+
+                if(header.bucketCount == 0 || (header.bucketCount & (header.bucketCount - 1)) != 0 ||
+                   header.bucketsOffset < sizeof(binaryHeader) || header.bucketsOffset % 8 != 0 ||
+                   !inside(header.bucketsOffset, bucketsSize) ||
+                   header.entriesOffset < header.bucketsOffset + bucketsSize || header.entriesOffset % 8 != 0 ||
+                   !inside(header.entriesOffset, entriesSize) ||
+                   header.valuesOffset != header.entriesOffset + entriesSize ||
+                   header.stringsOffset < header.valuesOffset || !inside(header.stringsOffset, 0))
+                {
+                    return false;
+                }
+
+                if(hashString(std::string_view(data + sizeof(binaryHeader), w_size - sizeof(binaryHeader))) != header.checksum)
+                {
+                    return false;
+                }
+
+                buckets = reinterpret_cast<const uint32_t*>(data + header.bucketsOffset);
+                entries = reinterpret_cast<const binaryValue*>(data + header.entriesOffset);
+                values  = data + header.valuesOffset;
+                strings = data + header.stringsOffset;
+
+                for(uint32_t b=0; b<header.bucketCount; b++)
+                {
+                    if(buckets[b] > buckets[b + 1])
+                    {
+                        return false;
+                    }
+                }
+
+                if(buckets[0] != 0 || buckets[header.bucketCount] != header.entryCount)
+                {
+                    return false;
+                }
+
+                for(uint32_t n=0; n<header.entryCount; n++)
+                {
+                    if(!validate(entries[n]))
+                    {
+                        return false;
+                    }
+                }
+
+                image = data;
+                return true;
+            }
+
+           /*!
+            *  \brief Releases the image
+            */
+            void clear()
+            {
+                image = nullptr;
+                file.close();
+            }
+
+            bool loaded() const
+            {
+                return image != nullptr;
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const binaryValue * find(std::string_view w_name) const
+            {
+                if(image == nullptr)
+                {
+                    return nullptr;
+                }
+
+                uint64_t hash   = hashString(w_name);
+                uint32_t bucket = (uint32_t)(hash & (header.bucketCount - 1));
+
+                for(uint32_t n=buckets[bucket]; n<buckets[bucket + 1]; n++)
+                {
+                    if(entries[n].hash == hash && name(entries[n]) == w_name)
+                    {
+                        return &entries[n];
+                    }
+                }
+
+                return nullptr;
+            }
+
+            size_t size() const
+            {
+                return image == nullptr? 0 : header.entryCount;
+            }
+
+           /*!
+            *  \brief Parameter at an index in [0, size())
+            */
+            const binaryValue & value(size_t n) const
+            {
+                return entries[n];
+            }
+
+            std::string_view name(const binaryValue &w_value) const
+            {
+                return std::string_view(strings + w_value.nameOffset, w_value.nameLength);
+            }
+
+            std::string_view rawString(const binaryValue &w_value) const
+            {
+                return std::string_view(strings + w_value.rawOffset, w_value.rawLength);
+            }
+
+            static config_struct::type_ type(const binaryValue &w_value)
+            {
+                return (config_struct::type_)w_value.type;
+            }
+
+            arrayView<int> intArray(const binaryValue &w_value) const
+            {
+                return view<int>(w_value);
+            }
+
+            arrayView<float> floatArray(const binaryValue &w_value) const
+            {
+                return view<float>(w_value);
+            }
+
+            arrayView<uint8_t> boolArray(const binaryValue &w_value) const
+            {
+                return view<uint8_t>(w_value);
+            }
+
+            arrayView<int64_t> int64Array(const binaryValue &w_value) const
+            {
+                return view<int64_t>(w_value);
+            }
+
+            arrayView<uint64_t> uint64Array(const binaryValue &w_value) const
+            {
+                return view<uint64_t>(w_value);
+            }
+
+            arrayView<double> doubleArray(const binaryValue &w_value) const
+            {
+                return view<double>(w_value);
+            }
+
+            int getInt(const binaryValue &w_value, size_t n = 0) const
+            {
+                return intArray(w_value)[n];
+            }
+
+            float getFloat(const binaryValue &w_value, size_t n = 0) const
+            {
+                return floatArray(w_value)[n];
+            }
+
+            bool getBool(const binaryValue &w_value, size_t n = 0) const
+            {
+                return boolArray(w_value)[n];
+            }
+
+            // Integers of any width and (for getDouble) floats are converted (see convertNumber)
+            int64_t getInt64(const binaryValue &w_value, size_t n = 0) const
+            {
+                return number<int64_t>(w_value, n);
+            }
+
+            uint64_t getUint64(const binaryValue &w_value, size_t n = 0) const
+            {
+                return number<uint64_t>(w_value, n);
+            }
+
+            double getDouble(const binaryValue &w_value, size_t n = 0) const
+            {
+                return number<double>(w_value, n);
+            }
+
+            std::string_view getString(const binaryValue &w_value, size_t n = 0) const
+            {
+                const uint32_t *span = reinterpret_cast<const uint32_t*>(values + w_value.valueOffset) + 2 * n;
+                return std::string_view(strings + span[0], span[1]);
+            }
+
+           /*!
+            *  \brief  Converts a value back to a configuration value
+            */
+            config_struct expand(const binaryValue &w_value) const
+            {
+                config_struct config;
+                config.type      = type(w_value);
+                config.rawString = std::string(rawString(w_value));
+
+                switch(config.type)
+                {
+                    case config_struct::type_::STRING:
+                        for(size_t n=0; n<w_value.count; n++)
+                        {
+                            config.stringVal.emplace_back(getString(w_value, n));
+                        }
+                        break;
+                    case config_struct::type_::BOOLEAN:
+                        config.boolVal.assign(boolArray(w_value).begin(), boolArray(w_value).end());
+                        break;
+                    case config_struct::type_::FLOAT:
+                        config.floatVal.assign(floatArray(w_value).begin(), floatArray(w_value).end());
+                        break;
+                    case config_struct::type_::INTEGER:
+                        config.intVal.assign(intArray(w_value).begin(), intArray(w_value).end());
+                        break;
+                    case config_struct::type_::INT64:
+                        config.int64Val.assign(int64Array(w_value).begin(), int64Array(w_value).end());
+                        break;
+                    case config_struct::type_::UINT64:
+                        config.uint64Val.assign(uint64Array(w_value).begin(), uint64Array(w_value).end());
+                        break;
+                    case config_struct::type_::DOUBLE:
+                        config.doubleVal.assign(doubleArray(w_value).begin(), doubleArray(w_value).end());
+                        break;
+                    default:
+                        break;
+                }
+
+                return config;
+            }
+
+           /*!
+            *  \brief  Converts the image back to a configuration list
+            */
+            configList list() const
+            {
+                configList config;
+
+                #ifndef USE_ORDERED_MAP
+                config.reserve(size());
+                #endif
+
+                for(size_t n=0; n<size(); n++)
+                {
+                    config.emplace(std::string(name(entries[n])), expand(entries[n]));
+                }
+
+                return config;
+            }
+
+        private:
+
+            template<typename T>
+            arrayView<T> view(const binaryValue &w_value) const
+            {
+                arrayView<T> retVal;
+
+                if(type(w_value) != typeOf<T>())
+                {
+                    return retVal;
+                }
+
+                retVal.count = w_value.count;
+                retVal.ptr   = reinterpret_cast<const T*>(values + w_value.valueOffset);
+                return retVal;
+            }
+
+            template<typename T>
+            T number(const binaryValue &w_value, size_t n) const
+            {
+                typedef config_struct::type_ type_;
+
+                switch(type(w_value))
+                {
+                    case type_::INTEGER: return convertNumber<T>(intArray(w_value)[n]);
+                    case type_::FLOAT:   return convertNumber<T>(floatArray(w_value)[n]);
+                    case type_::INT64:   return convertNumber<T>(int64Array(w_value)[n]);
+                    case type_::UINT64:  return convertNumber<T>(uint64Array(w_value)[n]);
+                    case type_::DOUBLE:  return convertNumber<T>(doubleArray(w_value)[n]);
+                    default:             return 0;
+                }
+            }
+
+            // Checks that an entry refers to data inside the image
+            bool validate(const binaryValue &w_value) const
+            {
+                uint64_t stringsSize = header.size - header.stringsOffset;
+                uint64_t valuesSize  = header.stringsOffset - header.valuesOffset;
+
+                if((uint64_t)w_value.nameOffset + w_value.nameLength > stringsSize ||
+                   (uint64_t)w_value.rawOffset + w_value.rawLength > stringsSize)
+                {
+                    return false;
+                }
+
+                size_t element;
+                size_t align;
+
+                switch(type(w_value))
+                {
+                    case config_struct::type_::STRING:  element = 2 * sizeof(uint32_t); align = alignof(uint32_t); break;
+                    case config_struct::type_::BOOLEAN: element = sizeof(uint8_t);      align = 1;                 break;
+                    case config_struct::type_::FLOAT:   element = sizeof(float);        align = alignof(float);    break;
+                    case config_struct::type_::INTEGER: element = sizeof(int);          align = alignof(int);      break;
+                    case config_struct::type_::INT64:   element = sizeof(int64_t);      align = alignof(int64_t);  break;
+                    case config_struct::type_::UINT64:  element = sizeof(uint64_t);     align = alignof(uint64_t); break;
+                    case config_struct::type_::DOUBLE:  element = sizeof(double);       align = alignof(double);   break;
+                    case config_struct::type_::NO_VAL:  element = 0;                    align = 1;                 break;
+                    default:
+                        return false;
+                }
+
+                if(w_value.valueOffset % align != 0 ||
+                   (uint64_t)w_value.valueOffset + (uint64_t)w_value.count * element > valuesSize)
+                {
+                    return false;
+                }
+
+                for(size_t n=0; type(w_value) == config_struct::type_::STRING && n<w_value.count; n++)
+                {
+                    const uint32_t *span = reinterpret_cast<const uint32_t*>(values + w_value.valueOffset) + 2 * n;
+
+                    if((uint64_t)span[0] + span[1] > stringsSize)
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            mappedFile         file;
+            binaryHeader       header  = {};
+            const char        *image   = nullptr;
+            const uint32_t    *buckets = nullptr;
+            const binaryValue *entries = nullptr;
+            const char        *values  = nullptr;
+            const char        *strings = nullptr;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,221 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief On-disk cache of parsed configuration files
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "YConfParser.hpp"
+#include "YConfBinary.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Cache of parsed configuration files, kept as binary images
+        *         in a directory.
+        *
+        *  A cache entry is named after the hash and the size of the file
+        *  contents, so an edited file never matches a stale entry, and the
+        *  text file stays the only source of truth. Entries are written to a
+        *  temporary file and renamed, so a reader never sees a partial entry.
+        *  An entry which fails validation (see binaryConfig) is deleted and
+        *  the file is parsed again.
+        *
+        *  Only contents parsed without any warning or error are stored, so a
+        *  cache hit has no problem to report, and a parse stopped by a strict
+        *  collector is never kept.
+        *
+        *  Several threads and processes may share a cache directory. Entries
+        *  are never deleted automatically otherwise.
+        */
+        class parseCache
+        {
+        public:
+
+           /*!
+            *  \param w_directory Existing directory which holds the cache entries
+            */
+            explicit parseCache(const std::string &w_directory) : directory(w_directory)
+            {
+                if(!directory.empty() && directory.back() != '/')
+                {
+                    directory += '/';
+                }
+            }
+
+           /*!
+            *  \brief  Parses a configuration file, or loads the result of an
+            *          earlier parse of the same contents from the cache
+            *
+            *  \param  w_fileName Configuration file name
+            *  \return A dictionary of paramter names and associated values (the
+            *          same as from parseFile())
+            */
+            configList parseFile(const std::string &w_fileName)
+            {
+                mappedFile file;
+
+                if(!file.open(w_fileName))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", w_fileName.c_str());
+                    return configList();
+                }
+
+                std::string entryName = entryOf(file.view());
+                configList  config;
+
+                if(load(entryName, config))
+                {
+                    hitCount++;
+                    return config;
+                }
+
+                missCount++;
+
+                // Problems are checked on a part of the caller's collector
+                diagnosticCollector *collector = diagnosticCollector::active();
+                diagnosticCollector  part      = collector != nullptr? collector->part() : diagnosticCollector();
+
+                {
+                    diagnosticScope scope(part);
+                    config = parseBuffer(file.view());
+                }
+
+                bool clean = part.errors() == 0 && part.warnings() == 0;
+
+                if(collector != nullptr)
+                {
+                    collector->merge(std::move(part));
+                }
+                else
+                {
+                    for(auto &d : part.records())
+                    {
+                        fprintf(stderr, "%s\n", d.message.c_str());
+                    }
+                }
+
+                if(clean)
+                {
+                    store(entryName, config);
+                }
+
+                return config;
+            }
+
+            // Number of files loaded from the cache
+            size_t hits() const
+            {
+                return hitCount.load();
+            }
+
+            // Number of files parsed (no valid cache entry)
+            size_t misses() const
+            {
+                return missCount.load();
+            }
+
+            // Number of cache entries deleted because they failed validation
+            size_t corrupted() const
+            {
+                return corruptCount.load();
+            }
+
+           /*!
+            *  \brief  Name of the cache entry of some file contents
+            */
+            std::string entryOf(std::string_view w_contents) const
+            {
+                char name[64];
+                snprintf(name, sizeof(name), "%016llx-%llu.v%u.ycb", (unsigned long long)hashString(w_contents),
+                         (unsigned long long)w_contents.size(), (unsigned)binaryVersion);
+                return directory + name;
+            }
+
+        private:
+
+            // Loads a cache entry. Returns false if there is no valid entry.
+            bool load(const std::string &w_entryName, configList &w_config)
+            {
+                mappedFile entry;
+
+                if(!entry.open(w_entryName))
+                {
+                    return false;
+                }
+
+                binaryConfig binary;
+
+                if(!binary.load(entry.view().data(), entry.view().size()))
+                {
+                    corruptCount++;
+                    parseMessage(parseDiagnostic::WARNING, parseDiagnostic::INVALID_IMAGE, nullptr,
+                                 "deleting invalid cache entry %s\n", w_entryName.c_str());
+                    std::remove(w_entryName.c_str());
+                    return false;
+                }
+
+                w_config = binary.list();
+                return true;
+            }
+
+            // Writes a cache entry atomically (failures are not fatal)
+            void store(const std::string &w_entryName, const configList &w_config)
+            {
+                // Unique among threads and processes sharing the directory
+                uint64_t unique = mixHash(std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                                          (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count() ^
+                                          mixHash(tmpCount++));
+
+                char suffix[32];
+                snprintf(suffix, sizeof(suffix), ".%016llx.tmp", (unsigned long long)unique);
+
+                std::string tmpName = w_entryName + suffix;
+
+                if(!writeBinary(w_config, tmpName) || std::rename(tmpName.c_str(), w_entryName.c_str()) != 0)
+                {
+                    parseMessage(parseDiagnostic::WARNING, parseDiagnostic::FILE_WRITE, nullptr,
+                                 "error while writing cache entry %s\n", w_entryName.c_str());
+                    std::remove(tmpName.c_str());
+                }
+            }
+
+            std::string           directory;
+            std::atomic<size_t>   hitCount{0};
+            std::atomic<size_t>   missCount{0};
+            std::atomic<size_t>   corruptCount{0};
+            std::atomic<uint64_t> tmpCount{0};
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,484 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Compact storage of parsed configuration values
+ *
+ */
+
+
+#pragma once
+
+#include <cstring>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Compact (16 bytes) configuration value.
+        *
+        *  Scalars are stored in place. Strings of up to 7 characters are
+        *  stored in place too. Longer strings and arrays are stored in the
+        *  arena of the owning compactConfig, and the value keeps their offset.
+        *
+        *  The raw value string is not kept. Use the accessors of compactConfig
+        *  to read the value.
+        */
+        struct compactValue
+        {
+            uint8_t  type    = (uint8_t)config_struct::type_::NO_VAL;
+            uint8_t  inlined = 0;       // String stored in place
+            uint16_t reserved = 0;
+            uint32_t count   = 0;       // Number of elements
+
+            union
+            {
+                int      intVal;
+                float    floatVal;
+                uint8_t  boolVal;
+                int64_t  int64Val;
+                uint64_t uint64Val;
+                double   doubleVal;
+                char     chars[8];      // In-place string, the last byte is the length
+
+                struct
+                {
+                    uint32_t offset;    // Offset in the arena
+                    uint32_t length;    // String length (single string only)
+                } span;
+            };
+
+            compactValue() : span{0, 0} {}
+        };
+
+        static_assert(sizeof(compactValue) == 16, "compactValue is expected to be 16 bytes");
+
+       /*!
+        *  \brief A dictionary of compact configuration values
+        */
+        #ifdef USE_ORDERED_MAP
+        typedef std::map<std::string, compactValue> compactList;
+        #else
+        typedef std::unordered_map<std::string, compactValue> compactList;
+        #endif
+
+       /*!
+        *  \brief Configuration list with compact value storage.
+        *
+        *  Array elements and long strings of all entries are stored in one
+        *  shared arena. Offsets into the arena are 32-bit, hence the arena is
+        *  limited to 4 GiB; entries which do not fit are not added.
+        */
+        class compactConfig
+        {
+        public:
+            compactConfig() = default;
+
+           /*!
+            *  \brief Builds a compact copy of a configuration list
+            *
+            *  Entries which do not fit in the arena are left out (see
+            *  skipped()).
+            *
+            *  \param w_config Configuration list
+            */
+            explicit compactConfig(const configList &w_config)
+            {
+                #ifndef USE_ORDERED_MAP
+                values.reserve(w_config.size());
+                #endif
+
+                for(auto &c: w_config)
+                {
+                    if(!insert(c.first, c.second))
+                    {
+                        skippedCount++;
+                    }
+                }
+
+                arena.shrink_to_fit();
+            }
+
+           /*!
+            *  \brief  Adds a configuration entry
+            *
+            *  \param  w_name   Full parameter name
+            *  \param  w_config Configuration value
+            *  \return Flag indicates whether the entry is added (i.e. it did
+            *          not exist before, and it fits in the arena)
+            */
+            bool insert(const std::string &w_name, const config_struct &w_config)
+            {
+                if(values.count(w_name) > 0)
+                {
+                    return false;
+                }
+
+                compactValue value;
+                size_t       arenaUsed = arena.size();
+                bool         fits      = true;
+
+                value.type = (uint8_t)w_config.type;
+
+                switch(w_config.type)
+                {
+                    case config_struct::type_::STRING:
+                        fits = w_config.stringVal.size() <= UINT32_MAX;
+                        value.count = (uint32_t)w_config.stringVal.size();
+
+                        if(!fits)
+                        {
+                            break;
+                        }
+
+                        if(value.count == 1)
+                        {
+                            const std::string &str = w_config.stringVal[0];
+
+                            if(str.size() < sizeof(value.chars))
+                            {
+                                value.inlined = 1;
+                                memcpy(value.chars, str.data(), str.size());
+                                value.chars[sizeof(value.chars) - 1] = (char)str.size();
+                            }
+                            else
+                            {
+                                fits = append(str.data(), str.size(), 1, value.span.offset);
+                                value.span.length = (uint32_t)str.size();
+                            }
+                        }
+                        else
+                        {
+                            // A table of (offset, length) pairs followed by the strings
+                            std::vector<uint32_t> table(2 * value.count);
+
+                            for(size_t n=0; n<value.count && fits; n++)
+                            {
+                                const std::string &str = w_config.stringVal[n];
+
+                                fits         = append(str.data(), str.size(), 1, table[2*n]);
+                                table[2*n+1] = (uint32_t)str.size();
+                            }
+
+                            fits = fits && append(table.data(), table.size() * sizeof(uint32_t), alignof(uint32_t),
+                                                  value.span.offset);
+                        }
+                        break;
+
+                    case config_struct::type_::BOOLEAN:
+                        fits = store(w_config.boolVal, value.boolVal, value);
+                        break;
+
+                    case config_struct::type_::FLOAT:
+                        fits = store(w_config.floatVal, value.floatVal, value);
+                        break;
+
+                    case config_struct::type_::INTEGER:
+                        fits = store(w_config.intVal, value.intVal, value);
+                        break;
+
+                    case config_struct::type_::INT64:
+                        fits = store(w_config.int64Val, value.int64Val, value);
+                        break;
+
+                    case config_struct::type_::UINT64:
+                        fits = store(w_config.uint64Val, value.uint64Val, value);
+                        break;
+
+                    case config_struct::type_::DOUBLE:
+                        fits = store(w_config.doubleVal, value.doubleVal, value);
+                        break;
+
+                    default:
+                        break;
+                }
+
+                if(!fits)
+                {
+                    arena.resize(arenaUsed);
+                    return false;
+                }
+
+                values.emplace(w_name, value);
+                return true;
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const compactValue * find(const std::string &w_name) const
+            {
+                auto it = values.find(w_name);
+                return it == values.end()? nullptr : &it->second;
+            }
+
+            size_t size() const
+            {
+                return values.size();
+            }
+
+            const compactList & list() const
+            {
+                return values;
+            }
+
+           /*!
+            *  \brief Size of the shared arena in bytes
+            */
+            size_t arenaSize() const
+            {
+                return arena.size();
+            }
+
+           /*!
+            *  \brief Number of entries the constructor left out because they
+            *         did not fit in the arena
+            */
+            size_t skipped() const
+            {
+                return skippedCount;
+            }
+
+            static config_struct::type_ type(const compactValue &w_value)
+            {
+                return (config_struct::type_)w_value.type;
+            }
+
+            arrayView<int> intArray(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.intVal);
+            }
+
+            arrayView<float> floatArray(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.floatVal);
+            }
+
+            arrayView<uint8_t> boolArray(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.boolVal);
+            }
+
+            arrayView<int64_t> int64Array(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.int64Val);
+            }
+
+            arrayView<uint64_t> uint64Array(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.uint64Val);
+            }
+
+            arrayView<double> doubleArray(const compactValue &w_value) const
+            {
+                return view(w_value, w_value.doubleVal);
+            }
+
+            int getInt(const compactValue &w_value, size_t n = 0) const
+            {
+                return intArray(w_value)[n];
+            }
+
+            float getFloat(const compactValue &w_value, size_t n = 0) const
+            {
+                return floatArray(w_value)[n];
+            }
+
+            bool getBool(const compactValue &w_value, size_t n = 0) const
+            {
+                return boolArray(w_value)[n];
+            }
+
+            // Integers of any width and (for getDouble) floats are converted (see convertNumber)
+            int64_t getInt64(const compactValue &w_value, size_t n = 0) const
+            {
+                return number<int64_t>(w_value, n);
+            }
+
+            uint64_t getUint64(const compactValue &w_value, size_t n = 0) const
+            {
+                return number<uint64_t>(w_value, n);
+            }
+
+            double getDouble(const compactValue &w_value, size_t n = 0) const
+            {
+                return number<double>(w_value, n);
+            }
+
+           /*!
+            *  \brief  Reads a string value
+            *
+            *  \param  w_value String value
+            *  \param  n       Index of the array element
+            *  \return View of the string (valid as long as this object is)
+            */
+            std::string_view getString(const compactValue &w_value, size_t n = 0) const
+            {
+                if(w_value.inlined)
+                {
+                    return std::string_view(w_value.chars, (size_t)w_value.chars[sizeof(w_value.chars) - 1]);
+                }
+                else if(w_value.count == 1)
+                {
+                    return std::string_view(arena.data() + w_value.span.offset, w_value.span.length);
+                }
+                else
+                {
+                    uint32_t entry[2];
+                    memcpy(entry, arena.data() + w_value.span.offset + 2 * n * sizeof(uint32_t), sizeof(entry));
+                    return std::string_view(arena.data() + entry[0], entry[1]);
+                }
+            }
+
+           /*!
+            *  \brief  Converts a compact value back to a configuration value
+            *
+            *  \param  w_value Compact value
+            *  \return Configuration value (without the raw string)
+            */
+            config_struct expand(const compactValue &w_value) const
+            {
+                config_struct config;
+                config.type = type(w_value);
+
+                switch(config.type)
+                {
+                    case config_struct::type_::STRING:
+                        for(size_t n=0; n<w_value.count; n++)
+                        {
+                            config.stringVal.emplace_back(getString(w_value, n));
+                        }
+                        break;
+                    case config_struct::type_::BOOLEAN:
+                        config.boolVal.assign(boolArray(w_value).begin(), boolArray(w_value).end());
+                        break;
+                    case config_struct::type_::FLOAT:
+                        config.floatVal.assign(floatArray(w_value).begin(), floatArray(w_value).end());
+                        break;
+                    case config_struct::type_::INTEGER:
+                        config.intVal.assign(intArray(w_value).begin(), intArray(w_value).end());
+                        break;
+                    case config_struct::type_::INT64:
+                        config.int64Val.assign(int64Array(w_value).begin(), int64Array(w_value).end());
+                        break;
+                    case config_struct::type_::UINT64:
+                        config.uint64Val.assign(uint64Array(w_value).begin(), uint64Array(w_value).end());
+                        break;
+                    case config_struct::type_::DOUBLE:
+                        config.doubleVal.assign(doubleArray(w_value).begin(), doubleArray(w_value).end());
+                        break;
+                    default:
+                        break;
+                }
+
+                return config;
+            }
+
+        private:
+
+            // Appends w_size bytes aligned to w_align to the arena and sets their
+            // offset. Fails if the bytes would end beyond the 32-bit offsets.
+            bool append(const void *w_data, size_t w_size, size_t w_align, uint32_t &w_offset)
+            {
+                size_t offset = (arena.size() + w_align - 1) / w_align * w_align;
+
+                if(offset > UINT32_MAX || w_size > UINT32_MAX - offset)
+                {
+                    return false;
+                }
+
+                arena.resize(offset + w_size);
+
+                if(w_size > 0)
+                {
+                    memcpy(arena.data() + offset, w_data, w_size);
+                }
+
+                w_offset = (uint32_t)offset;
+                return true;
+            }
+
+            // Stores a scalar in place, or an array in the arena
+            template<typename T>
+            bool store(const std::vector<T> &w_vals, T &w_scalar, compactValue &w_value)
+            {
+                if(w_vals.size() > UINT32_MAX)
+                {
+                    return false;
+                }
+
+                w_value.count = (uint32_t)w_vals.size();
+
+                if(w_vals.size() == 1)
+                {
+                    w_scalar = w_vals[0];
+                    return true;
+                }
+
+                return append(w_vals.data(), w_vals.size() * sizeof(T), alignof(T), w_value.span.offset);
+            }
+
+            // Typed view of a scalar or an array
+            template<typename T>
+            arrayView<T> view(const compactValue &w_value, const T &w_scalar) const
+            {
+                arrayView<T> retVal;
+
+                if(type(w_value) != typeOf<T>())
+                {
+                    return retVal;
+                }
+
+                retVal.count = w_value.count;
+                retVal.ptr   = w_value.count == 1? &w_scalar : reinterpret_cast<const T*>(arena.data() + w_value.span.offset);
+                return retVal;
+            }
+
+            template<typename T>
+            T number(const compactValue &w_value, size_t n) const
+            {
+                typedef config_struct::type_ type_;
+
+                switch(type(w_value))
+                {
+                    case type_::INTEGER: return convertNumber<T>(intArray(w_value)[n]);
+                    case type_::FLOAT:   return convertNumber<T>(floatArray(w_value)[n]);
+                    case type_::INT64:   return convertNumber<T>(int64Array(w_value)[n]);
+                    case type_::UINT64:  return convertNumber<T>(uint64Array(w_value)[n]);
+                    case type_::DOUBLE:  return convertNumber<T>(doubleArray(w_value)[n]);
+                    default:             return 0;
+                }
+            }
+
+            compactList       values;
+            std::vector<char> arena;
+            size_t            skippedCount = 0;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,533 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Immutable read-optimized configuration index
+ *
+ */
+
+
+#pragma once
+
+#include <stdexcept>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Full parameter name together with its hash.
+        *
+        *  For names known at compile time the hash is computed by the
+        *  compiler:
+        *
+        *      constexpr paramKey year("glossary.year");
+        *      using namespace ylibs::yconfparser::literals;
+        *      auto title = config.resolve("glossary.title"_param);
+        */
+        struct paramKey
+        {
+            std::string_view name;
+            uint64_t         hash;
+
+            constexpr paramKey(std::string_view w_name) : name(w_name), hash(hashString(w_name))
+            {
+            }
+        };
+
+        namespace literals
+        {
+            constexpr paramKey operator""_param(const char *w_name, size_t w_length)
+            {
+                return paramKey(std::string_view(w_name, w_length));
+            }
+        }
+
+       /*!
+        *  \brief Resolved parameter of a frozenConfig.
+        *
+        *  A handle stays valid for the lifetime of the frozenConfig which
+        *  resolved it. Reading through a handle does not hash the name.
+        */
+        struct paramHandle
+        {
+            uint32_t index = UINT32_MAX;
+
+            bool valid() const
+            {
+                return index != UINT32_MAX;
+            }
+        };
+
+       /*!
+        *  \brief Immutable configuration list indexed by a minimal perfect hash.
+        *
+        *  The parameter names are stored in one contiguous buffer, and the
+        *  values in one contiguous array. A lookup hashes the name once, reads
+        *  one displacement seed and compares a single candidate entry; no
+        *  temporary std::string is built.
+        *
+        *  The hash function is "hash and displace": names are grouped into
+        *  buckets, and every bucket gets a seed (or, for buckets of a single
+        *  name, a slot) such that all names land in distinct slots.
+        */
+        class frozenConfig
+        {
+        public:
+            frozenConfig() = default;
+
+           /*!
+            *  \brief Builds the index of a configuration list
+            *
+            *  \param w_config Configuration list
+            */
+            explicit frozenConfig(const configList &w_config)
+            {
+                build(w_config, [](const config_struct &w_value) { return w_value; });
+            }
+
+           /*!
+            *  \brief Builds the index of a configuration list. The values are
+            *         moved out of w_config.
+            *
+            *  \param w_config Configuration list
+            */
+            explicit frozenConfig(configList &&w_config)
+            {
+                build(w_config, [](config_struct &w_value) { return std::move(w_value); });
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const config_struct * find(std::string_view w_name) const
+            {
+                size_t n = indexOf(w_name);
+                return n == npos? nullptr : &values[n];
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name hashed in advance
+            *
+            *  \param  w_key Full parameter name and its hash
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const config_struct * find(const paramKey &w_key) const
+            {
+                size_t n = indexOf(w_key);
+                return n == npos? nullptr : &values[n];
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return The value. std::out_of_range is thrown if it does not exist
+            */
+            const config_struct & at(std::string_view w_name) const
+            {
+                const config_struct *value = find(w_name);
+
+                if(value == nullptr)
+                {
+                    throw std::out_of_range("frozenConfig::at");
+                }
+
+                return *value;
+            }
+
+            size_t count(std::string_view w_name) const
+            {
+                return indexOf(w_name) == npos? 0 : 1;
+            }
+
+           /*!
+            *  \brief  Slot index of a parameter
+            *
+            *  \param  w_name Full parameter name
+            *  \return Index (see key() and value()) or npos if it does not exist
+            */
+            size_t indexOf(std::string_view w_name) const
+            {
+                return values.empty()? npos : indexOf(w_name, hashString(w_name, salt));
+            }
+
+           /*!
+            *  \brief  Slot index of a parameter whose name is hashed in advance
+            *
+            *  \param  w_key Full parameter name and its hash
+            *  \return Index (see key() and value()) or npos if it does not exist
+            */
+            size_t indexOf(const paramKey &w_key) const
+            {
+                return values.empty()? npos : indexOf(w_key.name, salt == 0? w_key.hash : hashString(w_key.name, salt));
+            }
+
+           /*!
+            *  \brief  Resolves a parameter name into a handle
+            *
+            *  \param  w_name Full parameter name
+            *  \return Handle, which is not valid() if the parameter does not exist
+            */
+            paramHandle resolve(std::string_view w_name) const
+            {
+                return handleOf(indexOf(w_name));
+            }
+
+           /*!
+            *  \brief  Resolves a parameter name hashed in advance into a handle
+            *
+            *  \param  w_key Full parameter name and its hash
+            *  \return Handle, which is not valid() if the parameter does not exist
+            */
+            paramHandle resolve(const paramKey &w_key) const
+            {
+                return handleOf(indexOf(w_key));
+            }
+
+           /*!
+            *  \brief Value of a resolved parameter
+            */
+            const config_struct & value(paramHandle w_handle) const
+            {
+                return values[w_handle.index];
+            }
+
+            // Typed accessors of resolved parameters. The parameter is expected to
+            // be of the type being read.
+
+            int getInt(paramHandle w_handle, size_t n = 0) const
+            {
+                return values[w_handle.index].intVal[n];
+            }
+
+            float getFloat(paramHandle w_handle, size_t n = 0) const
+            {
+                return values[w_handle.index].floatVal[n];
+            }
+
+            bool getBool(paramHandle w_handle, size_t n = 0) const
+            {
+                return values[w_handle.index].boolVal[n];
+            }
+
+            // Integers of any width and (for getDouble) floats are converted (see convertNumber)
+            int64_t getInt64(paramHandle w_handle, size_t n = 0) const
+            {
+                return number<int64_t>(values[w_handle.index], n);
+            }
+
+            uint64_t getUint64(paramHandle w_handle, size_t n = 0) const
+            {
+                return number<uint64_t>(values[w_handle.index], n);
+            }
+
+            double getDouble(paramHandle w_handle, size_t n = 0) const
+            {
+                return number<double>(values[w_handle.index], n);
+            }
+
+            const std::string & getString(paramHandle w_handle, size_t n = 0) const
+            {
+                return values[w_handle.index].stringVal[n];
+            }
+
+            const std::vector<int> & getIntArray(paramHandle w_handle) const
+            {
+                return values[w_handle.index].intVal;
+            }
+
+            const std::vector<float> & getFloatArray(paramHandle w_handle) const
+            {
+                return values[w_handle.index].floatVal;
+            }
+
+            const std::vector<uint8_t> & getBoolArray(paramHandle w_handle) const
+            {
+                return values[w_handle.index].boolVal;
+            }
+
+            const std::vector<int64_t> & getInt64Array(paramHandle w_handle) const
+            {
+                return values[w_handle.index].int64Val;
+            }
+
+            const std::vector<uint64_t> & getUint64Array(paramHandle w_handle) const
+            {
+                return values[w_handle.index].uint64Val;
+            }
+
+            const std::vector<double> & getDoubleArray(paramHandle w_handle) const
+            {
+                return values[w_handle.index].doubleVal;
+            }
+
+            const std::vector<std::string> & getStringArray(paramHandle w_handle) const
+            {
+                return values[w_handle.index].stringVal;
+            }
+
+            size_t size() const
+            {
+                return values.size();
+            }
+
+           /*!
+            *  \brief Full parameter name at a slot
+            */
+            std::string_view key(size_t n) const
+            {
+                return std::string_view(names.data() + entries[n].offset, entries[n].length);
+            }
+
+           /*!
+            *  \brief Value at a slot
+            */
+            const config_struct & value(size_t n) const
+            {
+                return values[n];
+            }
+
+            static constexpr size_t npos = SIZE_MAX;
+
+        private:
+
+            struct entry
+            {
+                uint64_t hash;
+                uint32_t offset;    // Offset of the name in names
+                uint32_t length;    // Name length
+            };
+
+            template<typename T>
+            static T number(const config_struct &w_value, size_t n)
+            {
+                typedef config_struct::type_ type_;
+
+                switch(w_value.type)
+                {
+                    case type_::INTEGER: return convertNumber<T>(w_value.intVal[n]);
+                    case type_::FLOAT:   return convertNumber<T>(w_value.floatVal[n]);
+                    case type_::INT64:   return convertNumber<T>(w_value.int64Val[n]);
+                    case type_::UINT64:  return convertNumber<T>(w_value.uint64Val[n]);
+                    case type_::DOUBLE:  return convertNumber<T>(w_value.doubleVal[n]);
+                    default:             return 0;
+                }
+            }
+
+            static paramHandle handleOf(size_t n)
+            {
+                paramHandle handle;
+
+                if(n != npos)
+                {
+                    handle.index = (uint32_t)n;
+                }
+
+                return handle;
+            }
+
+            size_t indexOf(std::string_view w_name, uint64_t w_hash) const
+            {
+                size_t n = slotOf(w_hash, seeds[reduce(w_hash, seeds.size())], values.size());
+
+                const entry &e = entries[n];
+                return e.hash == w_hash && key(n) == w_name? n : npos;
+            }
+
+            static constexpr uint32_t directSlot = 0x80000000u;   // Seed flag: the rest is the slot
+
+            // Maps a hash uniformly into [0, w_range)
+            static size_t reduce(uint64_t w_hash, size_t w_range)
+            {
+                return (size_t)(((w_hash >> 32) * (uint64_t)w_range) >> 32);
+            }
+
+            // Slot of a hash, given the seed of its bucket
+            static size_t slotOf(uint64_t w_hash, uint32_t w_seed, size_t w_slots)
+            {
+                if(w_seed & directSlot)
+                {
+                    return w_seed & ~directSlot;
+                }
+
+                return reduce(mixHash(w_hash ^ (w_seed * 0x9e3779b97f4a7c15ull)), w_slots);
+            }
+
+            template<typename List, typename Extract>
+            void build(List &w_config, Extract w_extract)
+            {
+                size_t count = w_config.size();
+
+                std::vector<uint64_t> hashes(count);
+                std::vector<uint32_t> slots(count);
+
+                // Retry with another salt in the (unlikely) case that two names
+                // cannot be separated
+                for(salt = 0; ; salt++)
+                {
+                    size_t n = 0;
+
+                    for(auto &c: w_config)
+                    {
+                        hashes[n++] = hashString(c.first, salt);
+                    }
+
+                    if(assignSlots(hashes, slots))
+                    {
+                        break;
+                    }
+                }
+
+                size_t length = 0;
+
+                for(auto &c: w_config)
+                {
+                    length += c.first.size();
+                }
+
+                entries.resize(count);
+                values.resize(count);
+                names.reserve(length);
+
+                size_t n = 0;
+
+                for(auto &c: w_config)
+                {
+                    entry &e = entries[slots[n]];
+                    e.hash   = hashes[n];
+                    e.offset = (uint32_t)names.size();
+                    e.length = (uint32_t)c.first.size();
+                    names   += c.first;
+                    values[slots[n]] = w_extract(c.second);
+                    n++;
+                }
+            }
+
+            // Finds the seed of every bucket. Returns false if it fails.
+            bool assignSlots(const std::vector<uint64_t> &w_hashes, std::vector<uint32_t> &w_slots)
+            {
+                size_t count   = w_hashes.size();
+                size_t buckets = count / 2 + 1;
+
+                std::vector<std::vector<uint32_t>> bucketKeys(buckets);
+
+                for(uint32_t n=0; n<count; n++)
+                {
+                    bucketKeys[reduce(w_hashes[n], buckets)].push_back(n);
+                }
+
+                std::vector<uint32_t> order(buckets);
+
+                for(uint32_t b=0; b<buckets; b++)
+                {
+                    order[b] = b;
+                }
+
+                // Largest buckets first
+                std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                    return bucketKeys[a].size() > bucketKeys[b].size();
+                });
+
+                std::vector<uint8_t>  taken(count, 0);
+                std::vector<uint32_t> candidate;
+                size_t                nextFree = 0;
+
+                seeds.assign(buckets, 0);
+
+                for(uint32_t b : order)
+                {
+                    const std::vector<uint32_t> &keys = bucketKeys[b];
+
+                    if(keys.empty())
+                    {
+                        break;
+                    }
+
+                    if(keys.size() == 1)
+                    {
+                        while(taken[nextFree])
+                        {
+                            nextFree++;
+                        }
+
+                        seeds[b]         = directSlot | (uint32_t)nextFree;
+                        taken[nextFree]  = 1;
+                        w_slots[keys[0]] = (uint32_t)nextFree;
+                        continue;
+                    }
+
+                    bool found = false;
+
+                    for(uint32_t seed = 0; seed < (1u << 20) && !found; seed++)
+                    {
+                        candidate.clear();
+                        found = true;
+
+                        for(uint32_t k : keys)
+                        {
+                            size_t slot = slotOf(w_hashes[k], seed, count);
+
+                            if(taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end())
+                            {
+                                found = false;
+                                break;
+                            }
+
+                            candidate.push_back((uint32_t)slot);
+                        }
+
+                        if(found)
+                        {
+                            seeds[b] = seed;
+
+                            for(size_t k=0; k<keys.size(); k++)
+                            {
+                                taken[candidate[k]] = 1;
+                                w_slots[keys[k]]    = candidate[k];
+                            }
+                        }
+                    }
+
+                    if(!found)
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            uint64_t                   salt = 0;
+            std::vector<uint32_t>      seeds;
+            std::vector<entry>         entries;
+            std::string                names;
+            std::vector<config_struct> values;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
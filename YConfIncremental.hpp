@@ -0,0 +1,428 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Incremental re-parsing of changed top-level sections
+ *
+ */
+
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+#include "YConfParser.hpp"
+#include "YConfParallel.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Parameters changed by an update of a configuration
+        */
+        struct configDiff
+        {
+            std::vector<std::string> added;
+            std::vector<std::string> removed;
+            std::vector<std::string> changed;   // Present before and after, with a different value
+
+            bool empty() const
+            {
+                return added.empty() && removed.empty() && changed.empty();
+            }
+        };
+
+       /*!
+        *  \brief Configuration list which is updated by re-parsing only the
+        *         top-level sections that changed.
+        *
+        *  A top-level section is the text from a parameter with zero
+        *  indentation up to the next one. Every section is identified by the
+        *  hash of its text. An update parses only the sections whose hash is
+        *  not known from the previous text; the entries of all other sections
+        *  are kept as they are.
+        *
+        *  If a parameter name is defined by more than one section, the update
+        *  falls back to re-parsing all sections (the first definition wins, as
+        *  for parseFile).
+        *
+        *  Problems are reported with their line in the whole text, for the
+        *  sections parsed by an update only. A strict diagnostic collector
+        *  stops the update at the first error of the parsed sections: the
+        *  list then holds what parseBuffer would keep, and the sections from
+        *  the one with the error on are parsed again by the next update.
+        */
+        class incrementalConfig
+        {
+        public:
+            typedef std::function<void(const configDiff&, const configList&)> subscriber;
+
+           /*!
+            *  \brief  Updates the configuration from a new version of its text
+            *
+            *  Subscribers are notified if anything changed.
+            *
+            *  \param  w_text Configuration text
+            *  \return Changed parameters
+            */
+            configDiff update(std::string_view w_text)
+            {
+                std::vector<std::string_view> texts = splitAtTopLevel(w_text, 0);
+                std::vector<section>          updated(texts.size());
+
+                // Match the new sections with the current ones by hash
+                std::unordered_multimap<uint64_t, size_t> known;
+
+                for(size_t n=0; n<sections.size(); n++)
+                {
+                    if(!sections[n].partial)
+                    {
+                        known.emplace(sections[n].hash, n);
+                    }
+                }
+
+                std::vector<uint8_t> kept(sections.size(), 0);
+                std::vector<size_t>  origin(texts.size(), SIZE_MAX);  // Current section of a kept one
+                std::vector<size_t>  fresh;
+
+                for(size_t n=0; n<texts.size(); n++)
+                {
+                    updated[n].hash = hashString(texts[n]);
+                    auto it = known.find(updated[n].hash);
+
+                    if(it != known.end())
+                    {
+                        updated[n].keys  = std::move(sections[it->second].keys);
+                        updated[n].lines = sections[it->second].lines;
+                        kept[it->second] = 1;
+                        origin[n]        = it->second;
+                        known.erase(it);
+                    }
+                    else
+                    {
+                        fresh.push_back(n);
+                    }
+                }
+
+                lastReparsed = fresh.size();
+
+                configDiff diff;
+
+                if(!hasDuplicates && mergeSections(texts, fresh, kept, origin, updated, diff))
+                {
+                    sections = std::move(updated);
+                }
+                else
+                {
+                    diff = rebuild(texts);
+                }
+
+                if(!diff.empty())
+                {
+                    for(auto &s : subscribers)
+                    {
+                        s(diff, config);
+                    }
+                }
+
+                return diff;
+            }
+
+           /*!
+            *  \brief  Updates the configuration from a file
+            *
+            *  \param  w_fileName Configuration file name
+            *  \param  w_diff     Changed parameters
+            *  \return Flag indicates success or failure (the file could not be
+            *          read, in which case the configuration is not changed)
+            */
+            bool updateFromFile(const std::string &w_fileName, configDiff &w_diff)
+            {
+                mappedFile file;
+
+                if(!file.open(w_fileName))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", w_fileName.c_str());
+                    return false;
+                }
+
+                w_diff = update(file.view());
+                return true;
+            }
+
+           /*!
+            *  \brief  Registers a function which is called after every update
+            *          that changed something
+            */
+            void subscribe(subscriber w_subscriber)
+            {
+                subscribers.push_back(std::move(w_subscriber));
+            }
+
+            const configList & list() const
+            {
+                return config;
+            }
+
+           /*!
+            *  \brief  Number of sections parsed by the last update
+            */
+            size_t reparsedSections() const
+            {
+                return lastReparsed;
+            }
+
+           /*!
+            *  \brief  Number of sections of the current text
+            */
+            size_t sectionCount() const
+            {
+                return sections.size();
+            }
+
+        private:
+
+            struct section
+            {
+                uint64_t                 hash;
+                std::vector<std::string> keys;              // Names of the parameters defined by the section
+                size_t                   lines   = 0;
+                bool                     partial = false;   // Stopped by a strict collector (parsed again next time)
+            };
+
+            // Parses a section whose first line is line w_line + 1 of the text.
+            // Returns false if a strict diagnostic collector stopped it.
+            static bool parseSection(std::string_view w_text, size_t w_line, configList &w_entries, size_t &w_lines)
+            {
+                paramPath path;
+                path.lines = w_line;
+
+                bool complete = parseBuffer(w_text, path, w_entries);
+                w_lines = path.lines - w_line;
+                return complete;
+            }
+
+            // Replaces the entries of the removed sections by those of the fresh
+            // ones. Returns false (with the configuration unchanged and nothing
+            // reported) if a name is defined by more than one section.
+            bool mergeSections(const std::vector<std::string_view> &w_texts, const std::vector<size_t> &w_fresh,
+                               std::vector<uint8_t> &w_kept, const std::vector<size_t> &w_origin,
+                               std::vector<section> &w_updated, configDiff &w_diff)
+            {
+                // Problems are passed on only if the sections are merged
+                diagnosticCollector *collector = diagnosticCollector::active();
+                diagnosticCollector  part      = collector != nullptr? collector->part() : diagnosticCollector();
+                diagnosticScope      scope(part);
+
+                // Entries of the fresh sections
+                configList freshEntries;
+                size_t     line = 0;
+
+                for(size_t n=0, f=0; f<w_fresh.size(); line += w_updated[n++].lines)
+                {
+                    if(n != w_fresh[f])
+                    {
+                        continue;
+                    }
+
+                    configList entries;
+                    bool       complete = parseSection(w_texts[n], line, entries, w_updated[n].lines);
+
+                    for(auto &e : entries)
+                    {
+                        w_updated[n].keys.push_back(e.first);
+                    }
+
+                    size_t count = freshEntries.size() + entries.size();
+                    freshEntries.merge(entries);
+
+                    if(freshEntries.size() != count)
+                    {
+                        return false;
+                    }
+
+                    f++;
+
+                    // The sections after a strict error are removed
+                    if(!complete)
+                    {
+                        for(size_t k=n+1; k<w_updated.size(); k++)
+                        {
+                            if(w_origin[k] != SIZE_MAX)
+                            {
+                                sections[w_origin[k]].keys = std::move(w_updated[k].keys);
+                                w_kept[w_origin[k]]        = 0;
+                            }
+                        }
+
+                        w_updated.resize(n + 1);
+                        w_updated[n].partial = true;
+                        lastReparsed         = f;
+                        break;
+                    }
+                }
+
+                // A fresh name that exists already must belong to a removed section
+                std::unordered_map<std::string_view, bool> removedKeys;
+
+                for(size_t n=0; n<sections.size(); n++)
+                {
+                    if(!w_kept[n])
+                    {
+                        for(auto &key : sections[n].keys)
+                        {
+                            removedKeys.emplace(key, false);
+                        }
+                    }
+                }
+
+                for(auto &e : freshEntries)
+                {
+                    if(config.count(e.first) > 0 && removedKeys.count(e.first) == 0)
+                    {
+                        return false;
+                    }
+                }
+
+                // Apply
+                for(auto &e : freshEntries)
+                {
+                    auto it = config.find(e.first);
+
+                    if(it == config.end())
+                    {
+                        w_diff.added.push_back(e.first);
+                        config.emplace(e.first, std::move(e.second));
+                    }
+                    else
+                    {
+                        removedKeys[e.first] = true;    // Still defined
+
+                        if(it->second != e.second)
+                        {
+                            w_diff.changed.push_back(e.first);
+                            it->second = std::move(e.second);
+                        }
+                    }
+                }
+
+                for(auto &k : removedKeys)
+                {
+                    if(!k.second)
+                    {
+                        w_diff.removed.emplace_back(k.first);
+                    }
+                }
+
+                for(auto &key : w_diff.removed)
+                {
+                    config.erase(key);
+                }
+
+                if(collector != nullptr)
+                {
+                    collector->merge(std::move(part));
+                }
+                else
+                {
+                    for(auto &d : part.records())
+                    {
+                        fprintf(stderr, "%s\n", d.message.c_str());
+                    }
+                }
+
+                return true;
+            }
+
+            // Re-parses all sections
+            configDiff rebuild(const std::vector<std::string_view> &w_texts)
+            {
+                configList updatedConfig;
+                configDiff diff;
+
+                sections.assign(w_texts.size(), section());
+                hasDuplicates = false;
+
+                for(size_t n=0, line=0; n<w_texts.size(); line += sections[n++].lines)
+                {
+                    configList entries;
+                    bool       complete = parseSection(w_texts[n], line, entries, sections[n].lines);
+                    sections[n].hash    = hashString(w_texts[n]);
+
+                    for(auto &e : entries)
+                    {
+                        sections[n].keys.push_back(e.first);
+                    }
+
+                    size_t count = updatedConfig.size() + entries.size();
+                    updatedConfig.merge(entries);
+                    hasDuplicates |= updatedConfig.size() != count;
+
+                    // The sections after a strict error are dropped
+                    if(!complete)
+                    {
+                        sections[n].partial = true;
+                        sections.resize(n + 1);
+                        break;
+                    }
+                }
+
+                lastReparsed = sections.size();
+
+                for(auto &e : updatedConfig)
+                {
+                    auto it = config.find(e.first);
+
+                    if(it == config.end())
+                    {
+                        diff.added.push_back(e.first);
+                    }
+                    else if(it->second != e.second)
+                    {
+                        diff.changed.push_back(e.first);
+                    }
+                }
+
+                for(auto &e : config)
+                {
+                    if(updatedConfig.count(e.first) == 0)
+                    {
+                        diff.removed.push_back(e.first);
+                    }
+                }
+
+                config = std::move(updatedConfig);
+                return diff;
+            }
+
+            configList              config;
+            std::vector<section>    sections;
+            std::vector<subscriber> subscribers;
+            bool                    hasDuplicates = false;
+            size_t                  lastReparsed  = 0;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
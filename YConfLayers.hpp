@@ -0,0 +1,482 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Configuration made of several files which override each other
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Configuration made of layers of files, e.g. a base file and
+        *         files of an environment, a region and a host.
+        *
+        *  Files given later override files given earlier. A file can include
+        *  other files with a top-level "include" parameter holding a file name
+        *  or an array of file names (relative to the including file):
+        *
+        *      include: ["common.conf", "limits.conf"]
+        *
+        *  Included files are layers placed right before the file including
+        *  them, so the including file overrides them, and a later include
+        *  overrides an earlier one.
+        *
+        *  Files are parsed concurrently: the files given to load(), then all
+        *  files they include, and so on. Layers are merged by moving their
+        *  nodes into the result; nothing is copied. Which layer a value comes
+        *  from is decided while loading and kept with the value, so find()
+        *  is a single lookup.
+        *
+        *  Problems found in any of the files are passed to the diagnostic
+        *  collector attached to the calling thread, with their file name.
+        */
+        class layeredConfig
+        {
+        public:
+            static constexpr uint32_t npos     = UINT32_MAX;
+            static constexpr size_t   maxDepth = 16;    // Maximum nesting of includes
+
+            struct layer
+            {
+                std::string fileName;
+                uint32_t    includedBy;     // Layer including the file (npos for files given to load())
+                size_t      params;         // Number of parameters of the file
+                size_t      overridden;     // Parameters overridden by a later layer
+                bool        loaded;         // Flag indicates whether the file could be read
+            };
+
+            layeredConfig() = default;
+            layeredConfig(const layeredConfig&) = delete;
+            layeredConfig& operator=(const layeredConfig&) = delete;
+            layeredConfig(layeredConfig&&) = default;
+            layeredConfig& operator=(layeredConfig&&) = default;
+
+           /*!
+            *  \brief  Loads the layers of a configuration
+            *
+            *  \param  w_fileNames Files in the order of precedence (the last
+            *                      one overrides all others)
+            *  \param  w_threads   Number of threads. 0 uses one per hardware
+            *                      thread.
+            *  \return Flag indicates whether all files could be read and all
+            *          include directives are valid. The files which could
+            *          be read are merged in any case.
+            */
+            bool load(const std::vector<std::string> &w_fileNames, unsigned w_threads = 0)
+            {
+                std::vector<fileNode> nodes;
+                std::vector<uint32_t> wave;
+                bool                  complete = true;
+                diagnosticCollector  *collector = diagnosticCollector::active();
+
+                clear();
+
+                for(auto &f : w_fileNames)
+                {
+                    wave.push_back((uint32_t)nodes.size());
+                    nodes.push_back({f, npos, 0, {}, {}, false, diagnosticCollector()});
+                }
+
+                std::vector<uint32_t> roots = wave;
+
+                // Every file of a wave is included by a file of the previous one
+                while(!wave.empty())
+                {
+                    parseWave(nodes, wave, w_threads, collector);
+
+                    std::vector<uint32_t> next;
+
+                    for(uint32_t n : wave)
+                    {
+                        fileNode &node = nodes[n];
+
+                        complete &= node.loaded;
+
+                        if(collector != nullptr)
+                        {
+                            collector->merge(std::move(node.diagnostics), 0, node.fileName);
+                        }
+
+                        std::vector<std::string> includes;
+
+                        if(!takeIncludes(node, includes))
+                        {
+                            complete = false;
+                        }
+
+                        for(auto &i : includes)
+                        {
+                            std::string fileName = resolve(nodes[n].fileName, i);
+
+                            if(!checkInclude(nodes, n, fileName))
+                            {
+                                complete = false;
+                                continue;
+                            }
+
+                            nodes[n].includes.push_back((uint32_t)nodes.size());
+                            next.push_back((uint32_t)nodes.size());
+                            nodes.push_back({fileName, n, nodes[n].depth + 1, {}, {}, false, diagnosticCollector()});
+                        }
+                    }
+
+                    wave.swap(next);
+                }
+
+                // Layers in the order of precedence: the includes of a file, then the file
+                std::vector<uint32_t> order;
+                std::vector<uint32_t> layerIndex(nodes.size(), npos);
+
+                for(uint32_t r : roots)
+                {
+                    addLayers(nodes, r, order);
+                }
+
+                for(uint32_t n : order)
+                {
+                    layerIndex[n] = (uint32_t)layerList.size();
+                    layerList.push_back({nodes[n].fileName, npos, nodes[n].values.size(), 0, nodes[n].loaded});
+                }
+
+                for(uint32_t n : order)
+                {
+                    if(nodes[n].parent != npos)
+                    {
+                        layerList[layerIndex[n]].includedBy = layerIndex[nodes[n].parent];
+                    }
+                }
+
+                merge(nodes, order);
+                return complete;
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist
+            */
+            const config_struct * find(std::string_view w_name) const
+            {
+                auto it = index.find(w_name);
+                return it == index.end()? nullptr : it->second.value;
+            }
+
+           /*!
+            *  \brief  Layer a value comes from
+            *
+            *  \param  w_name Full parameter name
+            *  \return Index of the layer in layers(), or npos if the parameter
+            *          does not exist
+            */
+            uint32_t layerOf(std::string_view w_name) const
+            {
+                auto it = index.find(w_name);
+                return it == index.end()? npos : it->second.layer;
+            }
+
+            size_t count(std::string_view w_name) const
+            {
+                return index.count(w_name);
+            }
+
+            size_t size() const
+            {
+                return values.size();
+            }
+
+           /*!
+            *  \brief  Layers in the order of precedence (the last one
+            *          overrides all others)
+            */
+            const std::vector<layer> & layers() const
+            {
+                return layerList;
+            }
+
+           /*!
+            *  \brief  Merged configuration
+            */
+            const configList & list() const
+            {
+                return values;
+            }
+
+           /*!
+            *  \brief  Moves the merged configuration out; the object is left
+            *          empty
+            */
+            configList release()
+            {
+                configList config = std::move(values);
+                clear();
+                return config;
+            }
+
+        private:
+
+            // A file and the files it includes
+            struct fileNode
+            {
+                std::string                  fileName;
+                uint32_t                     parent;        // Including file (npos for files given to load())
+                size_t                       depth;
+                configList                   values;
+                std::vector<uint32_t>        includes;
+                bool                         loaded;
+                diagnosticCollector          diagnostics;   // Problems found by the worker thread
+            };
+
+            struct source
+            {
+                const config_struct *value;
+                uint32_t             layer;
+            };
+
+            void clear()
+            {
+                index.clear();
+                values.clear();
+                layerList.clear();
+            }
+
+            // Parses the files of a wave concurrently
+            static void parseWave(std::vector<fileNode> &w_nodes, const std::vector<uint32_t> &w_wave,
+                                  unsigned w_threads, const diagnosticCollector *w_collector)
+            {
+                if(w_threads == 0)
+                {
+                    w_threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+
+                std::atomic<size_t>      next(0);
+                std::vector<std::thread> workers;
+
+                auto work = [&]()
+                {
+                    for(size_t n = next++; n < w_wave.size(); n = next++)
+                    {
+                        fileNode &node = w_nodes[w_wave[n]];
+
+                        // Problems are collected per file and passed on in order
+                        if(w_collector != nullptr)
+                        {
+                            node.diagnostics = w_collector->part();
+
+                            diagnosticScope scope(node.diagnostics);
+                            node.loaded = parseLayer(node.fileName, node.values);
+                        }
+                        else
+                        {
+                            node.loaded = parseLayer(node.fileName, node.values);
+                        }
+                    }
+                };
+
+                for(unsigned t=1; t<std::min<size_t>(w_threads, w_wave.size()); t++)
+                {
+                    workers.emplace_back(work);
+                }
+
+                work();
+
+                for(auto &worker : workers)
+                {
+                    worker.join();
+                }
+            }
+
+            static bool parseLayer(const std::string &w_fileName, configList &w_config)
+            {
+                mappedFile file;
+
+                if(!file.open(w_fileName))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", w_fileName.c_str());
+                    return false;
+                }
+
+                configListBuilder builder(w_config);
+
+                parseBufferEvents(file.view(), builder);
+                return true;
+            }
+
+            // Removes the include directive of a file and returns its file names
+            static bool takeIncludes(fileNode &w_node, std::vector<std::string> &w_includes)
+            {
+                auto it = w_node.values.find("include");
+
+                if(it == w_node.values.end())
+                {
+                    return true;
+                }
+
+                bool valid = it->second.type == config_struct::type_::STRING;
+
+                if(valid)
+                {
+                    w_includes = std::move(it->second.stringVal);
+                }
+                else
+                {
+                    reportInclude(parseDiagnostic::INCLUDE_VALUE, w_node.fileName,
+                                  "include of %s is not a file name or an array of file names\n",
+                                  w_node.fileName.c_str());
+                }
+
+                w_node.values.erase(it);
+                return valid;
+            }
+
+            // Checks that an included file is not one of the files including it
+            static bool checkInclude(const std::vector<fileNode> &w_nodes, uint32_t w_parent,
+                                     const std::string &w_fileName)
+            {
+                if(w_nodes[w_parent].depth + 1 >= maxDepth)
+                {
+                    reportInclude(parseDiagnostic::INCLUDE_CYCLE, w_nodes[w_parent].fileName,
+                                  "includes nested too deeply at %s\n", w_fileName.c_str());
+                    return false;
+                }
+
+                for(uint32_t n = w_parent; n != npos; n = w_nodes[n].parent)
+                {
+                    if(w_nodes[n].fileName == w_fileName)
+                    {
+                        reportInclude(parseDiagnostic::INCLUDE_CYCLE, w_nodes[w_parent].fileName,
+                                      "%s includes itself\n", w_fileName.c_str());
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            static void reportInclude(parseDiagnostic::code_ w_code, const std::string &w_fileName,
+                                      const char *w_format, const char *w_arg)
+            {
+                diagnosticCollector *collector = diagnosticCollector::active();
+
+                if(collector == nullptr)
+                {
+                    fprintf(stderr, w_format, w_arg);
+                    return;
+                }
+
+                std::string message(strlen(w_format) + strlen(w_arg), '\0');
+
+                message.resize((size_t)std::max(0, snprintf(&message[0], message.size(), w_format, w_arg)));
+
+                if(!message.empty() && message.back() == '\n')
+                {
+                    message.pop_back();
+                }
+
+                collector->add(parseDiagnostic{parseDiagnostic::ERROR, w_code, 0, 0, message, w_fileName});
+            }
+
+            // Name of an included file, relative to the directory of the including file
+            static std::string resolve(const std::string &w_including, const std::string &w_included)
+            {
+                size_t slash = w_including.rfind('/');
+
+                if(w_included.empty() || w_included[0] == '/' || slash == std::string::npos)
+                {
+                    return w_included;
+                }
+
+                return w_including.substr(0, slash + 1) + w_included;
+            }
+
+            static void addLayers(const std::vector<fileNode> &w_nodes, uint32_t w_node, std::vector<uint32_t> &w_order)
+            {
+                for(uint32_t i : w_nodes[w_node].includes)
+                {
+                    addLayers(w_nodes, i, w_order);
+                }
+
+                w_order.push_back(w_node);
+            }
+
+            // Moves the values of the layers into the result, starting with the
+            // layer of highest precedence. Names which are in the result already
+            // are overridden and stay behind.
+            void merge(std::vector<fileNode> &w_nodes, const std::vector<uint32_t> &w_order)
+            {
+
+                for(size_t l = w_order.size(); l-- > 0; )
+                {
+                    configList &layerValues = w_nodes[w_order[l]].values;
+
+                    // The layer of highest precedence becomes the result
+                    if(values.empty())
+                    {
+                        values.swap(layerValues);
+                        index.reserve(values.size());
+
+                        for(auto &v : values)
+                        {
+                            index.emplace(v.first, source{&v.second, (uint32_t)l});
+                        }
+
+                        continue;
+                    }
+
+                    for(auto it = layerValues.begin(); it != layerValues.end(); )
+                    {
+                        auto next   = std::next(it);
+                        auto result = values.insert(layerValues.extract(it));
+
+                        if(result.inserted)
+                        {
+                            index.emplace(result.position->first, source{&result.position->second, (uint32_t)l});
+                        }
+                        else
+                        {
+                            layerList[l].overridden++;
+                        }
+
+                        it = next;
+                    }
+                }
+            }
+
+            configList                                   values;
+            std::unordered_map<std::string_view, source> index;     // Views of the names in values
+            std::vector<layer>                           layerList;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
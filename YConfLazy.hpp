@@ -0,0 +1,329 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Configuration whose values are decoded on first access
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Configuration whose values are decoded when they are first
+        *         read.
+        *
+        *  Loading only splits the lines into parameter names and raw value
+        *  strings; the type of a value is detected and its elements converted
+        *  (see parseValue) on the first find() of its name, and the result is
+        *  kept for later reads. Services which read a small part of a large
+        *  configuration skip the conversion of the rest.
+        *
+        *  find() may be called from several threads: a value is decoded once,
+        *  under a lock, and read without a lock afterwards. Loading is not
+        *  thread-safe.
+        *
+        *  Lines are checked while loading; problems of values (e.g. unknown
+        *  array elements) are reported when they are decoded, with the line
+        *  they come from. Results are the same as from parseFile. A strict
+        *  diagnostic collector stops loading at the first error of a line.
+        */
+        class lazyConfig
+        {
+        public:
+            lazyConfig() = default;
+            lazyConfig(const lazyConfig&) = delete;
+            lazyConfig& operator=(const lazyConfig&) = delete;
+
+            ~lazyConfig()
+            {
+                clear();
+            }
+
+           /*!
+            *  \brief  Loads a configuration file (memory-mapped where
+            *          possible)
+            *
+            *  \param  w_fileName Configuration file name
+            *  \return Flag indicates success or failure (the file could not be
+            *          read)
+            */
+            bool open(const std::string &w_fileName)
+            {
+                clear();
+
+                if(!file.open(w_fileName))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", w_fileName.c_str());
+                    return false;
+                }
+
+                index(file.view());
+                return true;
+            }
+
+           /*!
+            *  \brief  Loads a configuration held in memory (the text is kept
+            *          by the object)
+            */
+            void load(std::string w_text)
+            {
+                clear();
+                text = std::move(w_text);
+                index(text);
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name, decoding it
+            *          on the first access
+            *
+            *  \param  w_name Full parameter name
+            *  \return Pointer to the value or nullptr if it does not exist.
+            *          It stays valid until the configuration is reloaded.
+            */
+            const config_struct * find(std::string_view w_name) const
+            {
+                auto it = names.find(w_name);
+
+                if(it == names.end())
+                {
+                    return nullptr;
+                }
+
+                const config_struct *value = decode(entries[it->second]);
+                return value->type == config_struct::type_::NO_VAL? nullptr : value;
+            }
+
+            size_t count(std::string_view w_name) const
+            {
+                return find(w_name) != nullptr? 1 : 0;
+            }
+
+           /*!
+            *  \brief  Number of distinct parameter names with a value string
+            *          (values which turn out to be invalid when decoded
+            *          included)
+            */
+            size_t size() const
+            {
+                return names.size();
+            }
+
+           /*!
+            *  \brief  Number of parameters decoded so far
+            */
+            size_t decoded() const
+            {
+                return decodeCount.load();
+            }
+
+           /*!
+            *  \brief  Decodes all values into a configuration list
+            */
+            configList list() const
+            {
+                configList config;
+
+                for(auto &n : names)
+                {
+                    const config_struct *value = decode(entries[n.second]);
+
+                    if(value->type != config_struct::type_::NO_VAL)
+                    {
+                        config.emplace(std::string(n.first), *value);
+                    }
+                }
+
+                return config;
+            }
+
+        private:
+
+            struct entry
+            {
+                std::string_view raw;       // Trimmed value string
+                uint32_t         line;
+                uint32_t         column;    // Position of the value in its line
+                uint32_t         next;      // Next value of the same name (npos if none)
+
+                // Decoded value of the first entry of a name
+                mutable std::atomic<config_struct*> value{nullptr};
+            };
+
+            static constexpr uint32_t npos = UINT32_MAX;
+
+            void clear()
+            {
+                for(size_t n=0; n<entryCount; n++)
+                {
+                    delete entries[n].value.load();
+                }
+
+                entries.reset();
+                entryCount = 0;
+                names.clear();
+                nameBuffer.clear();
+                text.clear();
+                file.close();
+                decodeCount.store(0);
+            }
+
+            struct span
+            {
+                size_t           nameOffset;
+                size_t           nameLength;
+                std::string_view raw;
+                uint32_t         line;
+                uint32_t         column;
+            };
+
+            // Parse event handler which keeps the names and value strings
+            struct indexBuilder : parseHandler
+            {
+                static constexpr bool decodeValues = false;
+
+                indexBuilder(std::vector<span> &w_spans, std::string &w_names) : spans(w_spans), names(w_names)
+                {
+                }
+
+                bool onValue(std::string_view w_fullName, config_struct &w_value)
+                {
+                    const parseLocation *location = parseLocation::active();
+
+                    spans.push_back({names.size(), w_fullName.size(),
+                                     location->text.substr(location->valueColumn, w_value.rawString.size()),
+                                     (uint32_t)location->line, (uint32_t)location->valueColumn});
+                    names += w_fullName;
+                    return true;
+                }
+
+                std::vector<span> &spans;
+                std::string       &names;
+            };
+
+            // Splits w_text into names and value strings
+            void index(std::string_view w_text)
+            {
+                std::vector<span> spans;
+                indexBuilder      builder(spans, nameBuffer);
+
+                parseBufferEvents(w_text, builder);
+
+                entries.reset(new entry[spans.size()]);
+                entryCount = spans.size();
+                names.reserve(spans.size());
+
+                for(size_t n=0; n<spans.size(); n++)
+                {
+                    entry &e = entries[n];
+                    e.raw    = spans[n].raw;
+                    e.line   = spans[n].line;
+                    e.column = spans[n].column;
+                    e.next   = npos;
+
+                    auto inserted = names.emplace(std::string_view(nameBuffer).substr(spans[n].nameOffset, spans[n].nameLength),
+                                                  (uint32_t)n);
+
+                    if(!inserted.second)
+                    {
+                        // The first valid value of a name is kept (as by parseFile)
+                        uint32_t last = inserted.first->second;
+
+                        while(entries[last].next != npos)
+                        {
+                            last = entries[last].next;
+                        }
+
+                        entries[last].next = (uint32_t)n;
+                    }
+                }
+            }
+
+            // Decoded value of a name, given its first entry
+            const config_struct * decode(const entry &w_entry) const
+            {
+                config_struct *value = w_entry.value.load(std::memory_order_acquire);
+
+                if(value != nullptr)
+                {
+                    return value;
+                }
+
+                std::lock_guard<std::mutex> lock(locks[(&w_entry - entries.get()) % lockCount]);
+                value = w_entry.value.load(std::memory_order_relaxed);
+
+                if(value != nullptr)
+                {
+                    return value;
+                }
+
+                value = new config_struct();
+
+                parseLocation      location;
+                parseLocationScope locationScope(location);
+
+                for(const entry *e = &w_entry; ; e = &entries[e->next])
+                {
+                    location.line        = e->line;
+                    location.valueColumn = e->column;
+
+                    resetValue(*value);
+                    value->rawString.assign(e->raw);
+                    location.value = value->rawString;
+                    parseValue(*value);
+
+                    if(value->type != config_struct::type_::NO_VAL || e->next == npos)
+                    {
+                        break;
+                    }
+                }
+
+                decodeCount++;
+                w_entry.value.store(value, std::memory_order_release);
+                return value;
+            }
+
+            static constexpr size_t lockCount = 64;
+
+            mappedFile                                      file;
+            std::string                                     text;
+            std::string                                     nameBuffer;
+            std::unique_ptr<entry[]>                        entries;
+            size_t                                          entryCount = 0;
+            std::unordered_map<std::string_view, uint32_t>  names;      // First entry of every name
+            mutable std::mutex                              locks[lockCount];
+            mutable std::atomic<size_t>                     decodeCount{0};
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
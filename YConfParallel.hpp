@@ -0,0 +1,269 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Multi-threaded parsing of large configurations
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief  Checks whether a line holds a top-level parameter.
+        *
+        *          A top-level (zero indentation) parameter rewinds the full
+        *          parameter name completely. Hence, the text starting at such
+        *          a line can be parsed independently of the text before it.
+        *
+        *  \param  w_line A view of the single-line string
+        *  \return Flag indicates whether the line is a top-level parameter
+        */
+        static bool isTopLevelParam(std::string_view w_line)
+        {
+            if(w_line.empty())
+            {
+                return false;
+            }
+
+            switch(w_line[0])
+            {
+                case ' ':
+                case '\t':
+                case '#':
+                case ':':
+                    return false;
+                default:
+                    return w_line.find(':') != std::string_view::npos;
+            }
+        }
+
+       /*!
+        *  \brief  Splits a configuration into chunks which can be parsed
+        *          independently.
+        *
+        *          Every chunk (except the first one) starts with a top-level
+        *          parameter.
+        *
+        *  \param  w_buffer    Configuration text
+        *  \param  w_chunkSize Minimum size of a chunk in bytes
+        *  \return Chunks in the order they appear in w_buffer
+        */
+        static std::vector<std::string_view> splitAtTopLevel(std::string_view w_buffer, size_t w_chunkSize)
+        {
+            std::vector<std::string_view> chunks;
+            size_t                        start = 0;
+            size_t                        pos   = w_chunkSize;
+
+            while(pos < w_buffer.size())
+            {
+                // Find the next top-level parameter after pos
+                size_t n = w_buffer.find('\n', pos);
+
+                while(n != std::string_view::npos)
+                {
+                    std::string_view line = w_buffer.substr(n + 1, w_buffer.find('\n', n + 1) - (n + 1));
+
+                    if(isTopLevelParam(line))
+                    {
+                        break;
+                    }
+
+                    n = w_buffer.find('\n', n + 1);
+                }
+
+                if(n == std::string_view::npos)
+                {
+                    break;
+                }
+
+                chunks.push_back(w_buffer.substr(start, n + 1 - start));
+                start = n + 1;
+                pos   = start + w_chunkSize;
+            }
+
+            chunks.push_back(w_buffer.substr(start));
+            return chunks;
+        }
+
+       /*!
+        *  \brief  Parses a configuration held in memory using several threads
+        *
+        *  The buffer is split at top-level parameters, and the chunks are
+        *  parsed concurrently. The result is the same as for parseBuffer
+        *  (including which value is kept for duplicated parameter names);
+        *  only the order of messages printed to stderr may differ.
+        *
+        *  If a diagnostic collector is attached to the calling thread, every
+        *  chunk is parsed with a collector of its own, and the problems are
+        *  passed on in the order of the text, with their line in the whole
+        *  buffer. A strict collector stops at the first error of the text:
+        *  chunks after it are dropped (or not parsed at all).
+        *
+        *  \param  w_buffer       Configuration text (owned by the caller)
+        *  \param  w_threads      Number of threads. 0 uses one per hardware
+        *                         thread.
+        *  \param  w_minChunkSize Minimum size of a chunk in bytes (smaller
+        *                         chunks are only useful for testing)
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseBufferParallel(std::string_view w_buffer, unsigned w_threads = 0,
+                                              size_t w_minChunkSize = 1 << 20)
+        {
+            if(w_threads == 0)
+            {
+                w_threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+
+            // A few chunks per thread balances the load, and very small chunks
+            // are not worth a thread
+            size_t chunkSize = std::max(w_minChunkSize, w_buffer.size() / (4 * w_threads));
+
+            std::vector<std::string_view> chunks = splitAtTopLevel(w_buffer, chunkSize);
+
+            if(w_threads == 1 || chunks.size() == 1)
+            {
+                return parseBuffer(w_buffer);
+            }
+
+            std::vector<configList>  results(chunks.size());
+            std::atomic<size_t>      next(0);
+            std::vector<std::thread> workers;
+
+            // Problems are collected per chunk and passed on in order
+            diagnosticCollector              *collector = diagnosticCollector::active();
+            std::vector<diagnosticCollector>  parts(collector != nullptr? chunks.size() : 0,
+                                                    collector != nullptr? collector->part() : diagnosticCollector());
+            std::vector<size_t>               lines(chunks.size(), 0);
+            std::atomic<size_t>               stopped(chunks.size());  // First chunk with a strict error
+
+            auto work = [&]()
+            {
+                for(size_t n = next++; n < chunks.size(); n = next++)
+                {
+                    paramPath path;
+
+                    if(collector == nullptr)
+                    {
+                        parseBuffer(chunks[n], path, results[n]);
+                        continue;
+                    }
+
+                    // Chunks after a strict error are dropped anyway
+                    if(n > stopped.load())
+                    {
+                        continue;
+                    }
+
+                    {
+                        diagnosticScope scope(parts[n]);
+                        parseBuffer(chunks[n], path, results[n]);
+                    }
+
+                    lines[n] = path.lines;
+
+                    for(size_t first = stopped.load(); parts[n].stopped() && n < first; )
+                    {
+                        stopped.compare_exchange_weak(first, n);
+                    }
+                }
+            };
+
+            for(unsigned t=1; t<std::min<size_t>(w_threads, chunks.size()); t++)
+            {
+                workers.emplace_back(work);
+            }
+
+            work();
+
+            for(auto &worker : workers)
+            {
+                worker.join();
+            }
+
+            size_t chunkCount = std::min(stopped.load() + 1, chunks.size());
+            size_t lineOffset = 0;
+
+            for(size_t n=0; collector != nullptr && n<chunkCount; n++)
+            {
+                collector->merge(std::move(parts[n]), lineOffset);
+                lineOffset += lines[n];
+            }
+
+            results.resize(chunkCount);
+
+            // Merge in order. Nodes are moved; names already in the result
+            // (i.e. defined in an earlier chunk) stay in the chunk and are dropped.
+            configList config = std::move(results[0]);
+
+            #ifndef USE_ORDERED_MAP
+            size_t total = 0;
+
+            for(auto &result : results)
+            {
+                total += result.size();
+            }
+
+            config.reserve(total);
+            #endif
+
+            for(size_t n=1; n<results.size(); n++)
+            {
+                config.merge(results[n]);
+            }
+
+            return config;
+        }
+
+       /*!
+        *  \brief  Parses a configuration file using several threads
+        *
+        *  \param  w_fileName Configuration file name
+        *  \param  w_threads  Number of threads. 0 uses one per hardware thread.
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseFileParallel(const std::string &w_fileName, unsigned w_threads = 0)
+        {
+            mappedFile file;
+
+            if(!file.open(w_fileName))
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return configList();
+            }
+
+            return parseBufferParallel(file.view(), w_threads);
+        }
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -24,10 +24,36 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cfloat>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "YConfScan.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define YCONFPARSER_HAS_MMAP
+#endif
+
 #ifdef USE_ORDERED_MAP
 #include <map>
 #else
@@ -62,6 +88,13 @@ namespace ylibs
         *    point number. The parser tries to cast the value string as
         *    a floating-point number if it contains a decimal point, and as
         *    an integer otherwise.
+        *  - Numbers get the narrowest type which keeps their value: integers
+        *    out of the range of int are 64-bit (INT64, or UINT64 above the
+        *    range of int64_t), and floating-point numbers which float does
+        *    not keep as written are DOUBLE. Hexadecimal integers (0x1f) and
+        *    byte sizes (64MiB, 4kB) are UINT64.
+        *  - The elements of an array of numbers take the widest type among
+        *    them (e.g. [1, 0x10] is a UINT64 array).
         *
         *  - If the parser fails to cast the value string to one of the above
         *    types, then the parser sets the type of the value string as "NO_VAL"
@@ -85,6 +118,10 @@ namespace ylibs
             *   BOOLEAN: TRUE / FALSE
             *   FLOAT:   A number with decimal point
             *   INTEGER: A number without decimal point
+            *   INT64:   An integer out of the range of int
+            *   UINT64:  An integer above the range of int64_t, a hexadecimal
+            *            integer or a byte size
+            *   DOUBLE:  A number with decimal point which float does not keep
             *
             *   A value can be scalar or array of elements (enclosed in square
             *   brackets, and separated by comma).
@@ -94,7 +131,10 @@ namespace ylibs
                 STRING,
                 BOOLEAN,
                 FLOAT,
-                INTEGER
+                INTEGER,
+                INT64,
+                UINT64,
+                DOUBLE
             } type;
             
             std::string rawString; // Leading and trailing double quotes (if any) are trimmed.
@@ -103,8 +143,97 @@ namespace ylibs
             std::vector<uint8_t>     boolVal;   // std::vector seams to have specialized implementation for bool type
             std::vector<float>       floatVal;
             std::vector<int>         intVal;
+            std::vector<int64_t>     int64Val;
+            std::vector<uint64_t>    uint64Val;
+            std::vector<double>      doubleVal;
+
+            bool operator==(const config_struct_ &w_other) const
+            {
+                return type      == w_other.type      &&
+                       rawString == w_other.rawString &&
+                       stringVal == w_other.stringVal &&
+                       boolVal   == w_other.boolVal   &&
+                       floatVal  == w_other.floatVal  &&
+                       intVal    == w_other.intVal    &&
+                       int64Val  == w_other.int64Val  &&
+                       uint64Val == w_other.uint64Val &&
+                       doubleVal == w_other.doubleVal;
+            }
+
+            bool operator!=(const config_struct_ &w_other) const
+            {
+                return !(*this == w_other);
+            }
         } config_struct;
         
+       /*!
+        *  \brief Read-only view of a contiguous array of values
+        */
+        template<typename T>
+        struct arrayView
+        {
+            const T *ptr   = nullptr;
+            size_t   count = 0;
+
+            const T* begin() const { return ptr; }
+            const T* end() const { return ptr + count; }
+            size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+            const T& operator[](size_t n) const { return ptr[n]; }
+        };
+
+       /*!
+        *  \brief  Finalizes a 64-bit hash value (MurmurHash3 fmix64)
+        */
+        static constexpr uint64_t mixHash(uint64_t w_hash)
+        {
+            w_hash ^= w_hash >> 33;
+            w_hash *= 0xff51afd7ed558ccdull;
+            w_hash ^= w_hash >> 33;
+            w_hash *= 0xc4ceb9fe1a85ec53ull;
+            w_hash ^= w_hash >> 33;
+            return w_hash;
+        }
+
+       /*!
+        *  \brief  Fast non-cryptographic 64-bit hash of a string.
+        *
+        *          The string is consumed 8 bytes at a time. The function is
+        *          constexpr, so hashes of string literals can be computed at
+        *          compile time.
+        *
+        *  \param  w_string String to be hashed
+        *  \param  w_seed   Seed
+        *  \return Hash value
+        */
+        static constexpr uint64_t hashString(std::string_view w_string, uint64_t w_seed = 0)
+        {
+            uint64_t hash = mixHash(w_seed ^ 0x9e3779b97f4a7c15ull) ^ w_string.size();
+            size_t   n    = 0;
+
+            for(; n + 8 <= w_string.size(); n += 8)
+            {
+                uint64_t word = 0;
+
+                for(size_t b=0; b<8; b++)
+                {
+                    word |= (uint64_t)(uint8_t)w_string[n+b] << (8*b);
+                }
+
+                hash  = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+                hash ^= hash >> 29;
+            }
+
+            uint64_t word = 0;
+
+            for(size_t b=0; n+b < w_string.size(); b++)
+            {
+                word |= (uint64_t)(uint8_t)w_string[n+b] << (8*b);
+            }
+
+            return mixHash(hash ^ word);
+        }
+
        /*!
         *  \brief A pair of parameter name and value 
         */
@@ -128,395 +257,2628 @@ namespace ylibs
         #else
         typedef std::unordered_map<std::string, config_struct> configList;
         #endif
-        
+
        /*!
-        *  \brief Removes all leading white-spaces until it finds a non-white space
-        *         character. TABs are not considered as white spaces
-        *
-        *  \param  w_string A raw string to be trimmed.
-        *  \return Trimmed string
+        *  \brief A warning or error met while parsing
         */
-        static std::string trimmLeadingSpaces(std::string w_string)
+        struct parseDiagnostic
         {
-            if(w_string.empty())
+            enum severity_
             {
-                return "";
-            }
-            else
+                WARNING,
+                ERROR
+            };
+
+            enum code_
+            {
+                SPACE_AFTER_TAB,    // Indentation with white space(s) after TAB(s) (error)
+                TAB_AFTER_SPACE,    // Indentation with TAB(s) after white space(s) (warning)
+                MISSING_COLON,      // Line without a colon, or starting with one
+                MISSING_PARAM,      // Empty parameter name
+                UNKNOWN_TYPE,       // Array element of unknown type
+                MIXED_ARRAY_TYPES,  // Array elements of different types
+                FILE_OPEN,          // File could not be opened
+                FILE_READ,          // Error while reading a file
+                FILE_WRITE,         // Error while writing a file
+                INCLUDE_VALUE,      // Include directive whose value is not a file name
+                INCLUDE_CYCLE,      // File which includes itself (directly or not)
+                INVALID_IMAGE,      // Binary image which fails validation
+                IMAGE_TOO_LARGE,    // Configuration too large for a binary image
+                MISSING_FIELD,      // Required schema field without a parameter
+                FIELD_TYPE,         // Schema field whose parameter has another type
+                UNWRITABLE_PARAM    // Parameter which cannot be written as configuration text
+            };
+
+            severity_   severity;
+            code_       code;
+            size_t      line;       // Line number (1 for the first line, 0 if not related to a line)
+            size_t      column;     // Column (1 for the first character, 0 if unknown)
+            std::string message;
+            std::string file;       // File of the problem (only set where several files are loaded)
+
+            static const char * codeName(code_ w_code)
             {
-                size_t n = w_string.find_first_not_of(' ');
-                return n==std::string::npos? "" : w_string.substr(n);
+                static const char *names[] = {"space-after-tab", "tab-after-space", "missing-colon", "missing-param",
+                                              "unknown-type", "mixed-array-types", "file-open", "file-read", "file-write",
+                                              "include-value", "include-cycle", "invalid-image", "image-too-large",
+                                              "missing-field", "field-type", "unwritable-param"};
+                return names[w_code];
             }
-        }
-        
+        };
+
        /*!
-        *  \brief Removes all leading TABs
+        *  \brief Collects the warnings and errors of the parses made while it
+        *         is attached to a thread (see diagnosticScope). Nothing is
+        *         printed to stderr meanwhile.
         *
-        *  \param  w_string A raw string to be trimmed.
-        *  \return Trimmed string
+        *  Diagnostics are only built when a problem is found, so parsing a
+        *  valid configuration costs the same with or without a collector.
         */
-        static std::string trimmLeadingTabs(std::string w_string)
+        class diagnosticCollector
         {
-            if(w_string.empty())
+        public:
+
+           /*!
+            *  \param w_limit  Maximum number of records kept; further problems
+            *                  are only counted
+            *  \param w_strict Stops parsing at the first error (parse functions
+            *                  then return what was parsed before the error)
+            */
+            explicit diagnosticCollector(size_t w_limit = SIZE_MAX, bool w_strict = false)
+                : limit(w_limit), strictMode(w_strict)
             {
-                return "";
             }
-            else
+
+            const std::vector<parseDiagnostic> & records() const
             {
-                size_t n = w_string.find_first_not_of('\t');
-                return n==std::string::npos? "" : w_string.substr(n);
+                return diagnostics;
             }
-        }
-        
-       /*!
-        *  \brief Removes all trailing white-spaces until it finds a non-white space
-        *         character. TABs are not considered as white spaces
-        *
-        *  \param  w_string A raw string to be trimmed.
-        *  \return Trimmed string
-        */
-        static std::string trimmTrailingSpaces(std::string w_string)
-        {
-            if(w_string.empty())
+
+            size_t errors() const
             {
-                return "";
+                return errorCount;
             }
-            else
+
+            size_t warnings() const
             {
-                size_t n = w_string.find_last_not_of(' ');
-                return n==std::string::npos? "" : w_string.substr(0,n+1);
+                return warningCount;
             }
-        }
-        
-       /*!
-        *  \brief  Removes leading and trailing white-spaces.
-        *
-        *  \param  w_string A raw string to be trimmed.
-        *  \return Trimmed string
-        */
-        static std::string trimmWhiteSpaces(std::string w_string)
-        {
-            return trimmTrailingSpaces(trimmLeadingSpaces(w_string));
-        }
-        
-       /*!
-        *  \brief  Parses a raw string as string type
-        *
-        *  \param  w_string A raw string to be parsed.
-        *  \param  w_val    Parsed string value (if successful)
-        *  \return          Flag indicates success or failure
-        */
-        static bool parseAsString(std::string & w_string, std::string & w_val)
-        {
-            bool retVal = false;
-            
-            if(w_string[0] == '\"')
+
+            // Number of problems not recorded because of the limit
+            size_t dropped() const
+            {
+                return errorCount + warningCount - diagnostics.size();
+            }
+
+            bool strict() const
+            {
+                return strictMode;
+            }
+
+            // Flag indicates whether an error stopped parsing (strict mode)
+            bool stopped() const
+            {
+                return strictMode && errorCount > 0;
+            }
+
+            void clear()
+            {
+                diagnostics.clear();
+                errorCount   = 0;
+                warningCount = 0;
+            }
+
+            // Flag indicates whether another record is kept
+            bool accepts() const
+            {
+                return diagnostics.size() < limit;
+            }
+
+           /*!
+            *  \brief  Counts a problem, and records it if the limit allows
+            *
+            *  \return Flag indicates whether parsing should continue
+            */
+            bool add(parseDiagnostic &&w_diagnostic)
+            {
+                (w_diagnostic.severity == parseDiagnostic::ERROR? errorCount : warningCount)++;
+
+                if(accepts())
+                {
+                    diagnostics.push_back(std::move(w_diagnostic));
+                }
+
+                return !stopped();
+            }
+
+           /*!
+            *  \brief  Collector for a part of a parse made separately (e.g. by
+            *          another thread), to be merged into this one. It keeps
+            *          at most the records still left under the limit.
+            */
+            diagnosticCollector part() const
+            {
+                return diagnosticCollector(limit - std::min(limit, diagnostics.size()), strictMode);
+            }
+
+           /*!
+            *  \brief  Passes on the problems of a part, with their line moved
+            *          by a number of lines and their file set (if not empty).
+            *          The problems the part dropped are counted as dropped.
+            *
+            *  \return Flag indicates whether parsing should continue
+            */
+            bool merge(diagnosticCollector &&w_part, size_t w_lineOffset = 0, const std::string &w_file = std::string())
             {
-                if(w_string.size() > 2)
+                size_t errors   = w_part.errorCount;
+                size_t warnings = w_part.warningCount;
+
+                for(auto &d : w_part.diagnostics)
                 {
-                    if(w_string.back() == '\"')
+                    (d.severity == parseDiagnostic::ERROR? errors : warnings)--;
+                    d.line += d.line > 0? w_lineOffset : 0;
+
+                    if(!w_file.empty())
                     {
-                        w_val  = w_string.substr(1,w_string.size()-2);
-                        retVal = true;
+                        d.file = w_file;
                     }
+
+                    add(std::move(d));
                 }
+
+                errorCount   += errors;
+                warningCount += warnings;
+                w_part.clear();
+
+                return !stopped();
             }
-            
-            return retVal;
-        }
-        
-        
+
+           /*!
+            *  \brief Collector attached to the calling thread (if any)
+            */
+            static diagnosticCollector *& active()
+            {
+                static thread_local diagnosticCollector *collector = nullptr;
+                return collector;
+            }
+
+        private:
+            std::vector<parseDiagnostic> diagnostics;
+            size_t                       limit;
+            bool                         strictMode;
+            size_t                       errorCount   = 0;
+            size_t                       warningCount = 0;
+        };
+
        /*!
-        *  \brief  Parses a raw string as boolean type
+        *  \brief Attaches a diagnostic collector to the calling thread while the
+        *         scope exists. Scopes can be nested.
         *
-        *  \param  w_string A raw string to be parsed.
-        *  \param  w_val    Parsed boolean value (if successful)
-        *  \return          Flag indicates success or failure
+        *  Only parses on the calling thread are collected, and those of the
+        *  worker threads of parseBufferParallel (which passes their problems
+        *  on).
         */
-        static bool parseAsBoolean(std::string & w_string, uint8_t &w_val)
+        class diagnosticScope
         {
-            bool retVal = false;
-            
-            if(w_string.find("TRUE") != std::string::npos)
+        public:
+            explicit diagnosticScope(diagnosticCollector &w_collector) : previous(diagnosticCollector::active())
             {
-                // Boolean TRUE
-                w_val  = true;
-                retVal = true;
+                diagnosticCollector::active() = &w_collector;
             }
-            else if(w_string.find("FALSE") != std::string::npos)
+
+            ~diagnosticScope()
             {
-                // Boolean FALSE
-                w_val  = false;
-                retVal = true;
+                diagnosticCollector::active() = previous;
             }
-            
-            return retVal;
-        }
-        
+
+            diagnosticScope(const diagnosticScope&) = delete;
+            diagnosticScope& operator=(const diagnosticScope&) = delete;
+
+        private:
+            diagnosticCollector *previous;
+        };
+
        /*!
-        *  \brief  Parses a raw string as floating-point type
+        *  \brief Position of the line being parsed, used to locate problems.
         *
-        *  \param  w_string A raw string to be parsed.
-        *  \param  w_val    Parsed floating-point value (if successful)
-        *  \return          Flag indicates success or failure
+        *  The parse loops keep it on their stack and update it per line;
+        *  it is read only when a problem is reported.
         */
-        static bool parseAsFloat(std::string & w_string, float &w_val)
+        struct parseLocation
         {
-            bool retVal = false;
-        
-            if(w_string.find(".") != std::string::npos)
+            size_t           line = 0;          // Line number (0 if unknown)
+            std::string_view text;              // The line
+            std::string_view value;             // Copy of the value being parsed (rawString)
+            size_t           valueColumn = 0;   // Position of the value in the line
+            bool             stop = false;      // Set when a strict collector meets an error
+
+            static parseLocation *& active()
+            {
+                static thread_local parseLocation *location = nullptr;
+                return location;
+            }
+
+           /*!
+            *  \brief  Column of a character of the line or of the value copy
+            *          (0 if it is in neither)
+            */
+            size_t columnOf(const char *w_where) const
             {
-                try
+                std::less_equal<const char*> le;
+
+                if(w_where == nullptr)
+                {
+                    return 0;
+                }
+
+                if(le(text.data(), w_where) && le(w_where, text.data() + text.size()))
+                {
+                    return (size_t)(w_where - text.data()) + 1;
+                }
+
+                if(le(value.data(), w_where) && le(w_where, value.data() + value.size()))
                 {
-                    w_val  = std::stof (w_string);
-                    retVal = true;
+                    return valueColumn + (size_t)(w_where - value.data()) + 1;
                 }
-                catch(...) {}
+
+                return 0;
             }
-            
-            return retVal;
-        }
-        
+        };
+
        /*!
-        *  \brief  Parses a raw string as integer type
-        *
-        *  \param  w_string A raw string to be parsed.
-        *  \param  w_val    Parsed integer value (if successful)
-        *  \return          Flag indicated success or failure
+        *  \brief Makes a parse location the active one of the calling thread
+        *         while the scope exists
         */
-        static bool parseAsInteger(std::string & w_string, int &w_val)
+        class parseLocationScope
         {
-            bool retVal = false;
-        
-            if(w_string.find(".") != std::string::npos)
+        public:
+            explicit parseLocationScope(parseLocation &w_location) : previous(parseLocation::active())
             {
-                try
-                {
-                    w_val  = std::stoi (w_string);
-                    retVal = true;
-                }
-                catch(...) {}
+                parseLocation::active() = &w_location;
             }
-            
-            return retVal;
-        }  
-        
+
+            ~parseLocationScope()
+            {
+                parseLocation::active() = previous;
+            }
+
+            parseLocationScope(const parseLocationScope&) = delete;
+            parseLocationScope& operator=(const parseLocationScope&) = delete;
+
+        private:
+            parseLocation *previous;
+        };
+
        /*!
-        *  \brief  Parses a single line and returns a paramtername-value pair.
-        *          Parameters names can be made up of multiple words separated
-        *          by white spaces. Indentations can be with white spaces or TABs.
-        *          TABS between white spaces (or vice versa) are not allowed.
-        *          Every TAB in indentations is counted as one white space.
+        *  \brief Statistics of the parses made while it is attached to a
+        *         thread (see parseStatsScope).
         *
-        *          Every parameter-value pair is separated with a colon.
-        *          A field might not be followed by a value after the colon
-        *          in which case the type is set to "NO_VAL", and a sub-field is
-        *          expected to exist.
+        *  Statistics are collected only if YCONFPARSER_STATS is defined;
+        *  otherwise the parser has no instrumentation at all. While a
+        *  statistics object is attached, warnings and errors are recorded in
+        *  it instead of being printed to stderr.
         *
-        *          Note: Every parameter name & value (including arrays) pair is
-        *                expected to span a single line.
+        *  Files parsed by parseFileMapped are read on first access of their
+        *  pages, so most of their read time shows up in the scan phase.
         *
-        *  \param  w_line A pointer to the single-line string
-        *  \param  w_padding Number of indentation white spaces / TABs
-        *  \return An std::pair of paramter name & value
+        *  Phase timings take a clock reading around every measured step, so
+        *  they slow parsing down noticeably; they are meant for finding where
+        *  the time goes, not for exact totals.
         */
-        static paramValuePair  parseLine(std::string *w_line, size_t &w_padding)
+        struct parseStats
         {
-            // Set default values
-            config_struct config;
-            w_padding        = 0;
-            config.type      = config_struct::type_::NO_VAL;
-            config.rawString = "";
-            
-            paramValuePair pvPair = std::make_pair("", config);
-            
-            // Check if it is empty
-            if(w_line->empty())
+            enum phase_
             {
-                return pvPair;
-            }
-            
-            std::string trimmed_  = trimmLeadingSpaces(*w_line);
-            std::string trimmed  = trimmLeadingTabs(trimmed_);
-            w_padding = w_line->size() - trimmed.size();
-            
-            if(trimmed.empty())
+                READ,           // Reading or mapping files and streams
+                SCAN,           // Building structural indexes
+                TOKENIZE,       // Splitting lines into indentation, name and value
+                CLASSIFY,       // Parsing scalar values
+                ARRAYS,         // Splitting and parsing arrays
+                INSERT,         // Handing values to the parse event handler (e.g. map insertion)
+                PHASE_COUNT
+            };
+
+            uint64_t phaseNanos[PHASE_COUNT] = {};
+            uint64_t bytes         = 0;     // Bytes of the lines parsed
+            uint64_t lines         = 0;
+            uint64_t params        = 0;     // Lines holding a parameter
+            uint64_t typeCounts[8] = {};    // Values per config_struct::type_ (NO_VAL: parameters without value)
+            uint64_t arrays        = 0;
+            uint64_t arrayElements = 0;
+            uint64_t allocations   = 0;     // Sampled from allocationCounter (if set)
+
+            std::vector<parseDiagnostic> warnings;
+            std::vector<parseDiagnostic> errors;
+
+            // Returns the number of heap allocations so far (e.g. from a
+            // counting operator new). Allocations are not counted without it.
+            size_t (*allocationCounter)() = nullptr;
+
+            static const char * phaseName(size_t w_phase)
             {
-                return pvPair;
+                static const char *names[PHASE_COUNT] = {"read", "scan", "tokenize", "classify", "arrays", "insert"};
+                return w_phase < PHASE_COUNT? names[w_phase] : "";
             }
-            
-            if(trimmed[0] == ' ')
+
+           /*!
+            *  \brief Statistics object attached to the calling thread (if any)
+            */
+            static parseStats *& active()
             {
-                fprintf(stderr, "Mixing of TAB(s) and white space(s) is not allowed\n");
-                return pvPair;
+                static thread_local parseStats *stats = nullptr;
+                return stats;
             }
-            
-            if(trimmed_.size() != trimmed.size() && trimmed_.size() != w_line->size())
+        };
+
+       /*!
+        *  \brief Attaches a statistics object to the calling thread while the
+        *         scope exists. Scopes can be nested.
+        *
+        *  Only parses on the calling thread are recorded; the worker threads
+        *  of parseFileParallel are not. Does nothing unless YCONFPARSER_STATS
+        *  is defined.
+        */
+        #ifdef YCONFPARSER_STATS
+        class parseStatsScope
+        {
+        public:
+            explicit parseStatsScope(parseStats &w_stats) : previous(parseStats::active())
             {
-                fprintf(stderr, "Warning: mix of TAB(s) and white space(s)\n");
-            }
-            
+                parseStats::active() = &w_stats;
+
+                if(w_stats.allocationCounter != nullptr)
+                {
+                    allocations = w_stats.allocationCounter();
+                }
+            }
+
+            ~parseStatsScope()
+            {
+                parseStats *stats = parseStats::active();
+
+                if(stats->allocationCounter != nullptr)
+                {
+                    stats->allocations += stats->allocationCounter() - allocations;
+                }
+
+                parseStats::active() = previous;
+            }
+
+            parseStatsScope(const parseStatsScope&) = delete;
+            parseStatsScope& operator=(const parseStatsScope&) = delete;
+
+        private:
+            parseStats *previous;
+            size_t      allocations = 0;
+        };
+        #else
+        struct parseStatsScope
+        {
+            explicit parseStatsScope(parseStats &) {}
+        };
+        #endif
+
+       /*!
+        *  \brief Adds the time until it is destroyed to a phase of the
+        *         attached statistics object. Does nothing unless
+        *         YCONFPARSER_STATS is defined.
+        */
+        #ifdef YCONFPARSER_STATS
+        class statsTimer
+        {
+        public:
+            explicit statsTimer(parseStats::phase_ w_phase) : stats(parseStats::active()), phase(w_phase)
+            {
+                if(stats != nullptr)
+                {
+                    start = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~statsTimer()
+            {
+                if(stats != nullptr)
+                {
+                    stats->phaseNanos[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    std::chrono::steady_clock::now() - start).count();
+                }
+            }
+
+        private:
+            parseStats                            *stats;
+            parseStats::phase_                     phase;
+            std::chrono::steady_clock::time_point  start;
+        };
+        #else
+        struct statsTimer
+        {
+            explicit statsTimer(parseStats::phase_) {}
+        };
+        #endif
+
+       /*!
+        *  \brief Counts a line in the attached statistics object
+        */
+        static inline void statsCountLine(size_t w_length)
+        {
+            #ifdef YCONFPARSER_STATS
+            if(parseStats *stats = parseStats::active())
+            {
+                stats->lines++;
+                stats->bytes += w_length + 1;
+            }
+            #else
+            (void)w_length;
+            #endif
+        }
+
+       /*!
+        *  \brief Counts a parsed parameter in the attached statistics object
+        */
+        static inline void statsCountParam(const config_struct &w_value)
+        {
+            #ifdef YCONFPARSER_STATS
+            if(parseStats *stats = parseStats::active())
+            {
+                size_t count = w_value.intVal.size() + w_value.floatVal.size() +
+                               w_value.boolVal.size() + w_value.stringVal.size() +
+                               w_value.int64Val.size() + w_value.uint64Val.size() + w_value.doubleVal.size();
+
+                stats->params++;
+                stats->typeCounts[(size_t)w_value.type]++;
+
+                if(!w_value.rawString.empty() && w_value.rawString[0] == '[')
+                {
+                    stats->arrays++;
+                    stats->arrayElements += count;
+                }
+            }
+            #else
+            (void)w_value;
+            #endif
+        }
+
+       /*!
+        *  \brief  Reports a warning or an error met while parsing.
+        *
+        *  It is recorded in the attached diagnostic collector and statistics
+        *  object (if any), or printed to stderr otherwise.
+        *
+        *  \param  w_severity Severity of the problem
+        *  \param  w_code     Kind of the problem
+        *  \param  w_where    Character of the current line or value where the
+        *                     problem is found (nullptr if unknown)
+        *  \param  w_format   printf format of the message
+        */
+        #if defined(__GNUC__)
+        __attribute__((format(printf, 4, 5)))
+        #endif
+        static void parseMessage(parseDiagnostic::severity_ w_severity, parseDiagnostic::code_ w_code,
+                                 const char *w_where, const char *w_format, ...)
+        {
+            diagnosticCollector *collector = diagnosticCollector::active();
+            parseStats          *stats     = nullptr;
+
+            #ifdef YCONFPARSER_STATS
+            stats = parseStats::active();
+            #endif
+
+            va_list args;
+            va_start(args, w_format);
+
+            if(collector == nullptr && stats == nullptr)
+            {
+                vfprintf(stderr, w_format, args);
+                va_end(args);
+                return;
+            }
+
+            parseLocation  *location = parseLocation::active();
+            parseDiagnostic diagnostic{w_severity, w_code, location? location->line : 0,
+                                       location? location->columnOf(w_where) : 0, std::string(), std::string()};
+
+            // The message is formatted only if it is kept
+            if(stats != nullptr || collector->accepts())
+            {
+                va_list copy;
+                va_copy(copy, args);
+                int length = vsnprintf(nullptr, 0, w_format, copy);
+                va_end(copy);
+
+                diagnostic.message.resize(length > 0? (size_t)length + 1 : 1);
+                vsnprintf(&diagnostic.message[0], diagnostic.message.size(), w_format, args);
+                diagnostic.message.resize(length > 0? (size_t)length : 0);
+
+                while(!diagnostic.message.empty() && diagnostic.message.back() == '\n')
+                {
+                    diagnostic.message.pop_back();
+                }
+            }
+
+            va_end(args);
+
+            #ifdef YCONFPARSER_STATS
+            if(stats != nullptr)
+            {
+                (w_severity == parseDiagnostic::ERROR? stats->errors : stats->warnings).push_back(diagnostic);
+            }
+            #endif
+
+            if(collector != nullptr && !collector->add(std::move(diagnostic)) && location != nullptr)
+            {
+                location->stop = true;
+            }
+        }
+        
+       /*!
+        *  \brief Removes all leading white-spaces until it finds a non-white space
+        *         character. TABs are not considered as white spaces
+        *
+        *  \param  w_string A view of the raw string to be trimmed.
+        *  \return View of the trimmed string (no copy is made)
+        */
+        static std::string_view trimmLeadingSpacesView(std::string_view w_string)
+        {
+            size_t n = w_string.find_first_not_of(' ');
+            return n==std::string_view::npos? std::string_view() : w_string.substr(n);
+        }
+        
+       /*!
+        *  \brief Removes all leading TABs
+        *
+        *  \param  w_string A view of the raw string to be trimmed.
+        *  \return View of the trimmed string (no copy is made)
+        */
+        static std::string_view trimmLeadingTabsView(std::string_view w_string)
+        {
+            size_t n = w_string.find_first_not_of('\t');
+            return n==std::string_view::npos? std::string_view() : w_string.substr(n);
+        }
+        
+       /*!
+        *  \brief Removes all trailing white-spaces until it finds a non-white space
+        *         character. TABs are not considered as white spaces
+        *
+        *  \param  w_string A view of the raw string to be trimmed.
+        *  \return View of the trimmed string (no copy is made)
+        */
+        static std::string_view trimmTrailingSpacesView(std::string_view w_string)
+        {
+            size_t n = w_string.find_last_not_of(' ');
+            return n==std::string_view::npos? std::string_view() : w_string.substr(0,n+1);
+        }
+        
+       /*!
+        *  \brief  Removes leading and trailing white-spaces.
+        *
+        *  \param  w_string A view of the raw string to be trimmed.
+        *  \return View of the trimmed string (no copy is made)
+        */
+        static std::string_view trimmWhiteSpacesView(std::string_view w_string)
+        {
+            return trimmTrailingSpacesView(trimmLeadingSpacesView(w_string));
+        }
+        
+       /*!
+        *  \brief Removes all leading white-spaces until it finds a non-white space
+        *         character. TABs are not considered as white spaces
+        *
+        *  \param  w_string A raw string to be trimmed.
+        *  \return Trimmed string
+        */
+        static std::string trimmLeadingSpaces(std::string w_string)
+        {
+            return std::string(trimmLeadingSpacesView(w_string));
+        }
+        
+       /*!
+        *  \brief Removes all leading TABs
+        *
+        *  \param  w_string A raw string to be trimmed.
+        *  \return Trimmed string
+        */
+        static std::string trimmLeadingTabs(std::string w_string)
+        {
+            return std::string(trimmLeadingTabsView(w_string));
+        }
+        
+       /*!
+        *  \brief Removes all trailing white-spaces until it finds a non-white space
+        *         character. TABs are not considered as white spaces
+        *
+        *  \param  w_string A raw string to be trimmed.
+        *  \return Trimmed string
+        */
+        static std::string trimmTrailingSpaces(std::string w_string)
+        {
+            return std::string(trimmTrailingSpacesView(w_string));
+        }
+        
+       /*!
+        *  \brief  Removes leading and trailing white-spaces.
+        *
+        *  \param  w_string A raw string to be trimmed.
+        *  \return Trimmed string
+        */
+        static std::string trimmWhiteSpaces(std::string w_string)
+        {
+            return std::string(trimmWhiteSpacesView(w_string));
+        }
+        
+       /*!
+        *  \brief  Parses a raw string as string type
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    View of the string value without the double quotes
+        *                   (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsString(std::string_view w_string, std::string_view &w_val)
+        {
+            bool retVal = false;
+
+            if(w_string.size() > 2 && w_string[0] == '\"' && w_string.back() == '\"')
+            {
+                w_val  = w_string.substr(1,w_string.size()-2);
+                retVal = true;
+            }
+
+            return retVal;
+        }
+
+       /*!
+        *  \brief  Parses a raw string as string type
+        *
+        *  \param  w_string A raw string to be parsed.
+        *  \param  w_val    Parsed string value (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsString(std::string & w_string, std::string & w_val)
+        {
+            std::string_view val;
+            bool             retVal = parseAsString(std::string_view(w_string), val);
+
+            if(retVal)
+            {
+                w_val.assign(val);
+            }
+
+            return retVal;
+        }
+
+       /*!
+        *  \brief  Parses a raw string as boolean type
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    Parsed boolean value (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsBoolean(std::string_view w_string, uint8_t &w_val)
+        {
+            bool retVal = false;
+
+            if(w_string.find("TRUE") != std::string_view::npos)
+            {
+                // Boolean TRUE
+                w_val  = true;
+                retVal = true;
+            }
+            else if(w_string.find("FALSE") != std::string_view::npos)
+            {
+                // Boolean FALSE
+                w_val  = false;
+                retVal = true;
+            }
+
+            return retVal;
+        }
+
+       /*!
+        *  \brief  Parses a raw string as boolean type
+        *
+        *  \param  w_string A raw string to be parsed.
+        *  \param  w_val    Parsed boolean value (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsBoolean(std::string & w_string, uint8_t &w_val)
+        {
+            return parseAsBoolean(std::string_view(w_string), w_val);
+        }
+
+       /*!
+        *  \brief  Finds the first character of the number in a raw string
+        *          (skipping leading white-spaces and a '+' sign)
+        *
+        *  \param  w_string A view of the raw string
+        *  \param  w_first  First character of the number (if successful)
+        *  \return          Flag indicates whether the string can hold a number
+        */
+        static bool numberStart(std::string_view w_string, const char *&w_first)
+        {
+            size_t n = w_string.find_first_not_of(" \t\n\v\f\r");
+
+            if(n == std::string_view::npos)
+            {
+                return false;
+            }
+
+            const char *last = w_string.data() + w_string.size();
+
+            w_first = w_string.data() + n;
+
+            if(*w_first == '+')
+            {
+                if(++w_first == last || *w_first == '-')
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Parses the number at the beginning of a raw string
+        *
+        *  Similar to std::stof / std::stoi, leading white-spaces and a '+' sign
+        *  are accepted, and any characters following the number are ignored.
+        *  Unlike them, no exception is thrown and no copy is made.
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    Parsed number (if successful)
+        *  \return          Flag indicates success or failure (including
+        *                   values out of the range of T)
+        */
+        template<typename T>
+        static bool parseNumber(std::string_view w_string, T &w_val)
+        {
+            const char *first;
+
+            if(!numberStart(w_string, first))
+            {
+                return false;
+            }
+
+            return std::from_chars(first, w_string.data() + w_string.size(), w_val).ec == std::errc();
+        }
+
+       /*!
+        *  \brief  Parses a raw string as floating-point type
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    Parsed floating-point value (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsFloat(std::string_view w_string, float &w_val)
+        {
+            return w_string.find('.') != std::string_view::npos && parseNumber(w_string, w_val);
+        }
+
+       /*!
+        *  \brief  Parses a raw string as floating-point type
+        *
+        *  \param  w_string A raw string to be parsed.
+        *  \param  w_val    Parsed floating-point value (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        static bool parseAsFloat(std::string & w_string, float &w_val)
+        {
+            return parseAsFloat(std::string_view(w_string), w_val);
+        }
+
+       /*!
+        *  \brief  Parses a raw string as integer type
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    Parsed integer value (if successful)
+        *  \return          Flag indicated success or failure
+        */
+        static bool parseAsInteger(std::string_view w_string, int &w_val)
+        {
+            return w_string.find('.') == std::string_view::npos && parseNumber(w_string, w_val);
+        }
+
+       /*!
+        *  \brief  Parses a raw string as integer type
+        *
+        *  \param  w_string A raw string to be parsed.
+        *  \param  w_val    Parsed integer value (if successful)
+        *  \return          Flag indicated success or failure
+        */
+        static bool parseAsInteger(std::string & w_string, int &w_val)
+        {
+            return parseAsInteger(std::string_view(w_string), w_val);
+        }
+
+       /*!
+        *  \brief A number parsed by parseAsNumber. The member of its type is set.
+        */
+        union numberValue
+        {
+            int      intVal;
+            float    floatVal;
+            int64_t  int64Val;
+            uint64_t uint64Val;
+            double   doubleVal;
+        };
+
+       /*!
+        *  \brief  Converts a float to the double of its shortest decimal form.
+        *
+        *          Unlike a cast, 0.1f becomes 0.1 rather than
+        *          0.100000001490116. A FLOAT value parsed from text gives the
+        *          double of that text.
+        */
+        static double widenFloat(float w_val)
+        {
+            char   buffer[32];
+            double retVal = w_val;
+            auto   result = std::to_chars(buffer, buffer + sizeof(buffer), w_val, std::chars_format::scientific);
+
+            if(result.ec == std::errc())
+            {
+                std::from_chars(buffer, result.ptr, retVal);
+            }
+
+            return retVal;
+        }
+
+       /*!
+        *  \brief  Tells whether an integer is in the range of the integer type T
+        */
+        template<typename T, typename S>
+        static bool integerInRange(S w_val)
+        {
+            if constexpr(std::is_signed<S>::value)
+            {
+                if(w_val < 0)
+                {
+                    return std::is_signed<T>::value && (int64_t)w_val >= (int64_t)std::numeric_limits<T>::min();
+                }
+            }
+
+            return (uint64_t)w_val <= (uint64_t)std::numeric_limits<T>::max();
+        }
+
+       /*!
+        *  \brief  Converts a number to T (int64_t, uint64_t or double), for the
+        *          64-bit and double getters of the configuration engines
+        *
+        *          Integers convert to integer types whose range holds them.
+        *          Everything converts to double, where a float gives the
+        *          double of its text (see widenFloat). Other conversions
+        *          (e.g. of a negative number to uint64_t) give 0.
+        */
+        template<typename T, typename S>
+        static T convertNumber(S w_val)
+        {
+            if constexpr(std::is_floating_point<T>::value)
+            {
+                if constexpr(std::is_same<S, float>::value)
+                {
+                    return widenFloat(w_val);
+                }
+                else
+                {
+                    return (T)w_val;
+                }
+            }
+            else if constexpr(std::is_floating_point<S>::value)
+            {
+                return 0;
+            }
+            else
+            {
+                return integerInRange<T>(w_val)? (T)w_val : 0;
+            }
+        }
+
+       /*!
+        *  \brief  Type of the values stored as T (e.g. INTEGER for int)
+        */
+        template<typename T>
+        static constexpr config_struct::type_ typeOf()
+        {
+            typedef config_struct::type_ type_;
+
+            return std::is_same<T, int>::value?      type_::INTEGER :
+                   std::is_same<T, float>::value?    type_::FLOAT :
+                   std::is_same<T, uint8_t>::value?  type_::BOOLEAN :
+                   std::is_same<T, int64_t>::value?  type_::INT64 :
+                   std::is_same<T, uint64_t>::value? type_::UINT64 :
+                   std::is_same<T, double>::value?   type_::DOUBLE : type_::STRING;
+        }
+
+       /*!
+        *  \brief  Reads the significant digits and the decimal exponent of the
+        *          decimal number starting at w_first (which std::from_chars
+        *          parses), e.g. "0.0150e3" gives "15" and exponent 1.
+        *
+        *  \param  w_digits   Significant digits without leading and trailing
+        *                     zeros (none for zero)
+        *  \param  w_count    Number of significant digits
+        *  \param  w_exponent Decimal exponent of the first significant digit
+        *  \return            Flag indicates success or failure (more than
+        *                     sizeof(w_digits) significant digits, or an
+        *                     exponent out of the range of int)
+        */
+        template<size_t N>
+        static bool decimalDigits(const char *w_first, const char *w_last, char (&w_digits)[N],
+                                  size_t &w_count, int &w_exponent)
+        {
+            size_t count    = 0;    // Digits, including inner zeros
+            size_t integers = 0;    // Digits before the point
+            size_t leading  = 0;    // Zeros before the first significant digit
+            bool   point    = false;
+
+            w_count = 0;
+
+            if(w_first != w_last && *w_first == '-')
+            {
+                w_first++;
+            }
+
+            for(; w_first != w_last; w_first++)
+            {
+                if(*w_first == '.' && !point)
+                {
+                    point = true;
+                    continue;
+                }
+
+                if(*w_first < '0' || *w_first > '9')
+                {
+                    break;
+                }
+
+                integers += point? 0 : 1;
+
+                if(count == 0 && *w_first == '0')
+                {
+                    leading++;
+                    continue;
+                }
+
+                if(count == N)
+                {
+                    if(*w_first != '0')
+                    {
+                        return false;
+                    }
+
+                    continue;   // Trailing zeros are checked for below
+                }
+
+                w_digits[count++] = *w_first;
+
+                if(*w_first != '0')
+                {
+                    w_count = count;
+                }
+            }
+
+            int exponent = 0;
+
+            if(w_first != w_last && (*w_first == 'e' || *w_first == 'E') && ++w_first != w_last)
+            {
+                // As std::from_chars, an exponent without digits is not a part of the number
+                if(*w_first == '+' && w_first + 1 != w_last && w_first[1] >= '0' && w_first[1] <= '9')
+                {
+                    w_first++;
+                }
+
+                if(*w_first != '+' && std::from_chars(w_first, w_last, exponent).ec == std::errc::result_out_of_range)
+                {
+                    return false;
+                }
+            }
+
+            w_exponent = (int)integers - (int)leading - 1 + exponent;
+            return true;
+        }
+
+       /*!
+        *  \brief  Tells whether a decimal number w_digits * 10^w_scale is the
+        *          shortest decimal form of the float parsed from it (that of
+        *          std::to_chars), without formatting the float.
+        *
+        *          The number is the shortest form unless a number of fewer
+        *          digits is in the rounding interval of the float (it suffices
+        *          to test those next to it), or the next number of as many
+        *          digits on the side of the float is in the interval and
+        *          closer to the float. Powers of ten up to 10^22 are doubles,
+        *          so that every number tested is a single rounding away from
+        *          its value.
+        *
+        *  \param  w_val      Normal float parsed from the number
+        *  \param  w_digits   Significant digits (at most DBL_DIG, the last
+        *                     one not zero)
+        *  \param  w_scale    Decimal exponent of the last digit
+        *  \param  w_shortest Result (if successful)
+        *  \return            Flag indicates whether the test is conclusive (it
+        *                     is not for scales out of [-22, 22] and numbers
+        *                     next to the bounds of the interval)
+        */
+        static bool isShortestFloat(float w_val, uint64_t w_digits, int w_scale, bool &w_shortest)
+        {
+            static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+            if(w_scale < -22 || w_scale > 22 || std::fpclassify(w_val) != FP_NORMAL)
+            {
+                return false;
+            }
+
+            const double power = powers[w_scale < 0? -w_scale : w_scale];
+            const float  val   = std::fabs(w_val);
+            uint32_t     bits;
+            float        below, above;
+
+            // Floats next to a positive float are those of the next bit patterns
+            memcpy(&bits, &val, sizeof(bits));
+            bits--;
+            memcpy(&below, &bits, sizeof(bits));
+            bits += 2;
+            memcpy(&above, &bits, sizeof(bits));
+
+            const double lower  = ((double)val + (double)below) / 2;       // Exact
+            const double upper  = ((double)val + (double)above) / 2;
+            const double margin = upper * 0x1p-50;
+            bool         conclusive = true;
+
+            auto value = [w_scale, power](uint64_t w_number)
+            {
+                return w_scale < 0? (double)w_number / power : (double)w_number * power;
+            };
+
+            auto inside = [&](uint64_t w_number)
+            {
+                double number = value(w_number);
+
+                if(std::fabs(number - lower) <= margin || std::fabs(number - upper) <= margin)
+                {
+                    conclusive = false;
+                }
+
+                return number > lower && number < upper;
+            };
+
+            const uint64_t shorter = w_digits / 10 * 10;
+            const double   offset  = value(w_digits) - (double)val;
+            const double   half    = value(1) / 2;
+
+            w_shortest = !inside(shorter) && !inside(shorter + 10);
+
+            if(std::fabs(std::fabs(offset) - half) <= margin)
+            {
+                conclusive = false;
+            }
+            else if(w_shortest && std::fabs(offset) > half)
+            {
+                w_shortest = !inside(offset > 0? w_digits - 1 : w_digits + 1);
+            }
+
+            return conclusive;
+        }
+
+       /*!
+        *  \brief  Tells whether float keeps a decimal number as written: the
+        *          shortest decimal form of the float parsed from it (that of
+        *          std::to_chars) has the same value.
+        *
+        *  \param  w_val   Float parsed from [w_first, w_last)
+        */
+        static bool floatKeeps(float w_val, const char *w_first, const char *w_last)
+        {
+            char   digits[DBL_DIG];
+            size_t count;
+            int    exponent;
+
+            // Distinct numbers of up to DBL_DIG digits are distinct doubles,
+            // hence their digits are compared instead of their values.
+            // Longer numbers are compared by value.
+            if(!decimalDigits(w_first, w_last, digits, count, exponent))
+            {
+                double val;
+                return std::from_chars(w_first, w_last, val).ec == std::errc() && widenFloat(w_val) == val;
+            }
+
+            // Up to FLT_DIG digits are kept by any normal float
+            if(count <= FLT_DIG && std::fpclassify(w_val) != FP_SUBNORMAL)
+            {
+                return true;
+            }
+
+            uint64_t number = 0;
+            bool     shortestForm;
+
+            for(size_t n=0; n<count; n++)
+            {
+                number = number * 10 + (uint64_t)(digits[n] - '0');
+            }
+
+            if(isShortestFloat(w_val, number, exponent - (int)count + 1, shortestForm))
+            {
+                return shortestForm;
+            }
+
+            char   shortest[32];
+            char   shortestDigits[DBL_DIG];
+            size_t shortestCount;
+            int    shortestExponent;
+            auto   result = std::to_chars(shortest, shortest + sizeof(shortest), w_val, std::chars_format::scientific);
+
+            return result.ec == std::errc() &&
+                   decimalDigits(shortest, result.ptr, shortestDigits, shortestCount, shortestExponent) &&
+                   shortestCount == count && shortestExponent == exponent && memcmp(shortestDigits, digits, count) == 0;
+        }
+
+       /*!
+        *  \brief  Parses the unit of a byte size
+        *
+        *          Binary (KiB, MiB, GiB, TiB, PiB, EiB) and decimal (kB or KB,
+        *          MB, GB, TB, PB, EB) units and plain bytes (B) are known.
+        *          Spaces around the unit are ignored.
+        *
+        *  \param  w_suffix Characters following the number
+        *  \param  w_factor Bytes per unit (if successful)
+        *  \return          Flag indicates whether w_suffix is a unit
+        */
+        static bool parseSizeSuffix(std::string_view w_suffix, uint64_t &w_factor)
+        {
+            static const struct
+            {
+                std::string_view unit;
+                uint64_t         factor;
+            } units[] = {
+                {"B",   1ull},
+                {"KiB", 1ull << 10}, {"MiB", 1ull << 20}, {"GiB", 1ull << 30},
+                {"TiB", 1ull << 40}, {"PiB", 1ull << 50}, {"EiB", 1ull << 60},
+                {"kB",  1000ull},    {"KB",  1000ull},    {"MB",  1000000ull},
+                {"GB",  1000000000ull},          {"TB", 1000000000000ull},
+                {"PB",  1000000000000000ull},    {"EB", 1000000000000000000ull}
+            };
+
+            w_suffix = trimmWhiteSpacesView(w_suffix);
+
+            for(auto &u : units)
+            {
+                if(w_suffix == u.unit)
+                {
+                    w_factor = u.factor;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+       /*!
+        *  \brief  Parses a raw string as a number of the narrowest type which
+        *          keeps its value
+        *
+        *          With a decimal point, the number is FLOAT if float keeps it
+        *          as written (its shortest decimal form has the same value),
+        *          and DOUBLE otherwise. Without, it is INTEGER if it is in the
+        *          range of int, INT64 if it is in the range of int64_t and
+        *          UINT64 otherwise. Hexadecimal integers (0x...) and byte sizes
+        *          (e.g. 64MiB, see parseSizeSuffix) are UINT64.
+        *
+        *          Like parseNumber, characters following the number are
+        *          ignored (except for a size unit). Negative and fractional
+        *          sizes (e.g. 1.5GiB) are not numbers.
+        *
+        *  \param  w_string A view of the raw string to be parsed.
+        *  \param  w_val    Parsed number (if successful)
+        *  \return          Type of the number ("NO_VAL" if it is not a number)
+        */
+        static config_struct::type_ parseAsNumber(std::string_view w_string, numberValue &w_val)
+        {
+            const char *first;
+            const char *last = w_string.data() + w_string.size();
+
+            if(!numberStart(w_string, first))
+            {
+                return config_struct::type_::NO_VAL;
+            }
+
+            uint64_t factor;
+
+            if(w_string.find('.') != std::string_view::npos)
+            {
+                float floatVal;
+                auto  result = std::from_chars(first, last, floatVal);
+
+                if(result.ptr != last && parseSizeSuffix(std::string_view(result.ptr, last - result.ptr), factor))
+                {
+                    return config_struct::type_::NO_VAL;
+                }
+
+                if(result.ec == std::errc() && floatKeeps(floatVal, first, last))
+                {
+                    w_val.floatVal = floatVal;
+                    return config_struct::type_::FLOAT;
+                }
+
+                if(std::from_chars(first, last, w_val.doubleVal).ec == std::errc())
+                {
+                    return config_struct::type_::DOUBLE;
+                }
+
+                return config_struct::type_::NO_VAL;
+            }
+
+            if(last - first > 2 && first[0] == '0' && (first[1] == 'x' || first[1] == 'X'))
+            {
+                return std::from_chars(first + 2, last, w_val.uint64Val, 16).ec == std::errc()?
+                       config_struct::type_::UINT64 : config_struct::type_::NO_VAL;
+            }
+
+            if(*first == '-')
+            {
+                auto result = std::from_chars(first, last, w_val.int64Val);
+
+                if(result.ec != std::errc() || (result.ptr != last && parseSizeSuffix(std::string_view(result.ptr, last - result.ptr), factor)))
+                {
+                    return config_struct::type_::NO_VAL;
+                }
+
+                if(w_val.int64Val < INT_MIN)
+                {
+                    return config_struct::type_::INT64;
+                }
+
+                w_val.intVal = (int)w_val.int64Val;
+                return config_struct::type_::INTEGER;
+            }
+
+            auto result = std::from_chars(first, last, w_val.uint64Val);
+
+            if(result.ec != std::errc())
+            {
+                return config_struct::type_::NO_VAL;
+            }
+
+            if(result.ptr != last && parseSizeSuffix(std::string_view(result.ptr, last - result.ptr), factor))
+            {
+                if(w_val.uint64Val > UINT64_MAX / factor)
+                {
+                    return config_struct::type_::NO_VAL;
+                }
+
+                w_val.uint64Val *= factor;
+                return config_struct::type_::UINT64;
+            }
+
+            if(w_val.uint64Val > (uint64_t)INT64_MAX)
+            {
+                return config_struct::type_::UINT64;
+            }
+
+            if(w_val.uint64Val > (uint64_t)INT_MAX)
+            {
+                w_val.int64Val = (int64_t)w_val.uint64Val;
+                return config_struct::type_::INT64;
+            }
+
+            w_val.intVal = (int)w_val.uint64Val;
+            return config_struct::type_::INTEGER;
+        }
+
+       /*!
+        *  \brief  Tells whether numbers of type w_from can be widened to w_to
+        *          (INTEGER to INT64 or UINT64, INT64 to UINT64, FLOAT to DOUBLE)
+        */
+        static bool widensTo(config_struct::type_ w_from, config_struct::type_ w_to)
+        {
+            switch(w_from)
+            {
+                case config_struct::type_::INTEGER:
+                    return w_to == config_struct::type_::INT64 || w_to == config_struct::type_::UINT64;
+                case config_struct::type_::INT64:
+                    return w_to == config_struct::type_::UINT64;
+                case config_struct::type_::FLOAT:
+                    return w_to == config_struct::type_::DOUBLE;
+                default:
+                    return false;
+            }
+        }
+
+       /*!
+        *  \brief  Widens a number (see widensTo)
+        *
+        *  \param  w_val  Number of type w_from, replaced by the number of type w_to
+        *  \return        Flag indicates success or failure (a negative number
+        *                 does not widen to UINT64)
+        */
+        static bool widenNumber(numberValue &w_val, config_struct::type_ w_from, config_struct::type_ w_to)
+        {
+            if(!widensTo(w_from, w_to))
+            {
+                return false;
+            }
+
+            switch(w_from)
+            {
+                case config_struct::type_::INTEGER:
+                    w_val.int64Val = w_val.intVal;
+                    break;
+                case config_struct::type_::FLOAT:
+                    w_val.doubleVal = widenFloat(w_val.floatVal);
+                    return true;
+                default:
+                    break;
+            }
+
+            if(w_to == config_struct::type_::UINT64)
+            {
+                if(w_val.int64Val < 0)
+                {
+                    return false;
+                }
+
+                w_val.uint64Val = (uint64_t)w_val.int64Val;
+            }
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Widens the values of a configuration entry (see widensTo)
+        *
+        *  \param  w_config Configuration entry, whose type is set to w_type if
+        *                   successful
+        *  \param  w_type   Wider type
+        *  \return          Flag indicates success or failure
+        */
+        static bool widenValues(config_struct &w_config, config_struct::type_ w_type)
+        {
+            if(!widensTo(w_config.type, w_type))
+            {
+                return false;
+            }
+
+            if(w_type == config_struct::type_::DOUBLE)
+            {
+                w_config.doubleVal.reserve(w_config.floatVal.capacity());
+
+                for(float f : w_config.floatVal)
+                {
+                    w_config.doubleVal.push_back(widenFloat(f));
+                }
+
+                w_config.floatVal.clear();
+            }
+            else if(w_type == config_struct::type_::INT64)
+            {
+                w_config.int64Val.assign(w_config.intVal.begin(), w_config.intVal.end());
+                w_config.int64Val.reserve(w_config.intVal.capacity());
+                w_config.intVal.clear();
+            }
+            else if(w_config.type == config_struct::type_::INTEGER)
+            {
+                if(std::any_of(w_config.intVal.begin(), w_config.intVal.end(), [](int v) { return v < 0; }))
+                {
+                    return false;
+                }
+
+                w_config.uint64Val.assign(w_config.intVal.begin(), w_config.intVal.end());
+                w_config.uint64Val.reserve(w_config.intVal.capacity());
+                w_config.intVal.clear();
+            }
+            else
+            {
+                if(std::any_of(w_config.int64Val.begin(), w_config.int64Val.end(), [](int64_t v) { return v < 0; }))
+                {
+                    return false;
+                }
+
+                w_config.uint64Val.assign(w_config.int64Val.begin(), w_config.int64Val.end());
+                w_config.int64Val.clear();
+            }
+
+            w_config.type = w_type;
+            return true;
+        }
+
+       /*!
+        *  \brief  Splits a single line whose first colon is known (e.g. from a
+        *          structuralIndex) into its indentation, parameter name and
+        *          value string.
+        *
+        *  \param  w_line    View of the single-line string
+        *  \param  w_colon   Position of the first ':' in w_line (npos if none)
+        *  \param  w_padding Number of indentation white spaces / TABs
+        *  \param  w_param   Trimmed parameter name (if successful)
+        *  \param  w_value   Trimmed value string (if successful)
+        *  \return Flag indicates whether the line holds a parameter
+        */
+        static bool tokenizeLine(std::string_view w_line, size_t w_colon, size_t &w_padding,
+                                 std::string_view &w_param, std::string_view &w_value)
+        {
+            w_padding = 0;
+
+            // Check if it is empty
+            if(w_line.empty())
+            {
+                return false;
+            }
+
+            std::string_view trimmed_ = trimmLeadingSpacesView(w_line);
+            std::string_view trimmed  = trimmLeadingTabsView(trimmed_);
+            w_padding = w_line.size() - trimmed.size();
+
+            if(trimmed.empty())
+            {
+                return false;
+            }
+
+            if(trimmed[0] == ' ')
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::SPACE_AFTER_TAB, trimmed.data(),
+                             "Mixing of TAB(s) and white space(s) is not allowed\n");
+                return false;
+            }
+
+            if(trimmed_.size() != trimmed.size() && trimmed_.size() != w_line.size())
+            {
+                parseMessage(parseDiagnostic::WARNING, parseDiagnostic::TAB_AFTER_SPACE, trimmed_.data(),
+                             "Warning: mix of TAB(s) and white space(s)\n");
+            }
+
             // Check if it is a comment
-            if(trimmed.find('#') == 0)
+            if(trimmed[0] == '#')
+            {
+                return false;
+            }
+
+            // Every valid parameter-value pair should be separated by a colon (:)
+            if(w_colon == std::string_view::npos || w_colon == w_padding)
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::MISSING_COLON, w_line.data() + w_padding,
+                             "Invalid    ---%.*s\n", (int)w_line.size(), w_line.data());
+                return false;  // Invalid
+            }
+
+            w_param = trimmWhiteSpacesView(w_line.substr(w_padding, w_colon - w_padding));
+            w_value = trimmWhiteSpacesView(w_line.substr(w_colon+1));
+
+            if(w_param.empty())
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::MISSING_PARAM, w_line.data() + w_colon,
+                             "Invalid: Missing param");
+                return false;
+            }
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Splits a single line into its indentation, parameter name and
+        *          value string. No copy is made; the returned views point into
+        *          w_line.
+        *
+        *          Comments, empty lines and invalid lines carry no parameter.
+        *
+        *  \param  w_line    View of the single-line string
+        *  \param  w_padding Number of indentation white spaces / TABs
+        *  \param  w_param   Trimmed parameter name (if successful)
+        *  \param  w_value   Trimmed value string (if successful)
+        *  \return           Flag indicates whether the line carries a parameter
+        */
+        static bool tokenizeLine(std::string_view w_line, size_t &w_padding,
+                                 std::string_view &w_param, std::string_view &w_value)
+        {
+            return tokenizeLine(w_line, w_line.find(':'), w_padding, w_param, w_value);
+        }
+
+       /*!
+        *  \brief  Parses a single (non-array) value and appends it to the
+        *          value list of its type.
+        *
+        *          The value is appended only if its type matches w_type.
+        *          A number of a narrower type is widened to w_type, and the
+        *          values of w_config are widened to the type of a wider
+        *          number (see widensTo).
+        *
+        *  \param  w_string Trimmed value string
+        *  \param  w_type   Expected type. Any type is accepted if it is "NO_VAL"
+        *  \param  w_config Configuration entry to be updated
+        *  \return          Type of the value ("NO_VAL" if it is unknown)
+        */
+        static config_struct::type_ appendValue(std::string_view w_string, config_struct::type_ w_type,
+                                                config_struct &w_config)
+        {
+            std::string_view     stringVal;
+            uint8_t              boolVal = false;
+            numberValue          number  = {};
+            config_struct::type_ type;
+
+            if(parseAsString(w_string, stringVal))
+            {
+                type = config_struct::type_::STRING;
+            }
+            else if(parseAsBoolean(w_string, boolVal))
+            {
+                type = config_struct::type_::BOOLEAN;
+            }
+            else if((type = parseAsNumber(w_string, number)) == config_struct::type_::NO_VAL)
+            {
+                return type;
+            }
+
+            if(w_type != config_struct::type_::NO_VAL && w_type != type)
+            {
+                if(widenNumber(number, type, w_type))
+                {
+                    type = w_type;
+                }
+                else if(!widenValues(w_config, type))
+                {
+                    return type;
+                }
+            }
+
+            switch(type)
+            {
+                case config_struct::type_::STRING:
+                    w_config.stringVal.emplace_back(stringVal);
+                    break;
+                case config_struct::type_::BOOLEAN:
+                    w_config.boolVal.push_back(boolVal);
+                    break;
+                case config_struct::type_::FLOAT:
+                    w_config.floatVal.push_back(number.floatVal);
+                    break;
+                case config_struct::type_::INTEGER:
+                    w_config.intVal.push_back(number.intVal);
+                    break;
+                case config_struct::type_::INT64:
+                    w_config.int64Val.push_back(number.int64Val);
+                    break;
+                case config_struct::type_::UINT64:
+                    w_config.uint64Val.push_back(number.uint64Val);
+                    break;
+                default: // config_struct::type_::DOUBLE:
+                    w_config.doubleVal.push_back(number.doubleVal);
+                    break;
+            }
+
+            return type;
+        }
+
+       /*!
+        *  \brief  Reserves space in the value list of w_config's type
+        *
+        *  \param  w_config Configuration entry with its type already set
+        *  \param  w_count  Number of values
+        */
+        static void reserveValues(config_struct &w_config, size_t w_count)
+        {
+            switch(w_config.type)
+            {
+                case config_struct::type_::STRING:
+                    w_config.stringVal.reserve(w_count);
+                    break;
+                case config_struct::type_::BOOLEAN:
+                    w_config.boolVal.reserve(w_count);
+                    break;
+                case config_struct::type_::FLOAT:
+                    w_config.floatVal.reserve(w_count);
+                    break;
+                case config_struct::type_::INTEGER:
+                    w_config.intVal.reserve(w_count);
+                    break;
+                case config_struct::type_::INT64:
+                    w_config.int64Val.reserve(w_count);
+                    break;
+                case config_struct::type_::UINT64:
+                    w_config.uint64Val.reserve(w_count);
+                    break;
+                case config_struct::type_::DOUBLE:
+                    w_config.doubleVal.reserve(w_count);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+       /*!
+        *  \brief  Parses the raw value string of a configuration entry.
+        *
+        *          The type and typed values of w_config are set from
+        *          w_config.rawString according to the rules described in
+        *          config_struct. The value string is parsed in a single pass,
+        *          and only the value list of the detected type is filled.
+        *
+        *          Parsing of an array stops at the first element which is of
+        *          unknown type or whose type differs from that of the first
+        *          element. The elements preceeding it are kept.
+        *
+        *  \param  w_config Configuration entry with rawString already set
+        *  \param  w_commas Finds the commas of rawString (see valueCommas)
+        */
+        template<typename Commas>
+        static void parseValue(config_struct &w_config, Commas w_commas)
+        {
+            std::string_view valString = w_config.rawString;
+            std::string_view stringVal;
+
+            // Parse value
+            if(valString.empty())
+            {
+                // No val
+            }
+            else if (parseAsString(valString, stringVal))
+            {
+                w_config.type = config_struct::type_::STRING;
+                w_config.stringVal.emplace_back(stringVal);
+            }
+            else if(valString[0] == '[' && valString.back() == ']')
+            {
+                // Array
+                if(valString.size() < 3)
+                {
+                    return; // Empty array
+                }
+
+                std::string_view elements = valString.substr(1,valString.size()-2);
+                size_t           pos      = 0;
+
+                while(true)
+                {
+                    // Positions in elements are one less than in valString
+                    std::string_view::size_type n = w_commas.next(pos+1);
+                    n = n==std::string_view::npos? n : n-1;
+
+                    std::string_view element = trimmWhiteSpacesView(elements.substr(pos, n==std::string_view::npos? n : n-pos));
+
+                    config_struct::type_ elementType = appendValue(element, w_config.type, w_config);
+
+                    if(elementType == config_struct::type_::NO_VAL)
+                    {
+                        parseMessage(parseDiagnostic::ERROR, parseDiagnostic::UNKNOWN_TYPE, element.data(),
+                                     "Unknown type: %.*s\n", (int)element.size(), element.data());
+                        break;
+                    }
+
+                    if(w_config.type == config_struct::type_::NO_VAL)
+                    {
+                        w_config.type = elementType;
+                        reserveValues(w_config, 1 + w_commas.count(pos+1));
+                    }
+                    else if(w_config.type != elementType)
+                    {
+                        parseMessage(parseDiagnostic::ERROR, parseDiagnostic::MIXED_ARRAY_TYPES, element.data(),
+                                     "Array entries should have the same type\n");
+                        break;
+                    }
+
+                    if(n==std::string_view::npos)
+                    {
+                        break;
+                    }
+
+                    if((n+1) >= elements.size())
+                    {
+                        break;
+                    }
+
+                    pos = n+1;
+                }
+            }
+            else
+            {
+                w_config.type = appendValue(valString, config_struct::type_::NO_VAL, w_config);
+            }
+        }
+
+       /*!
+        *  \brief Finds the commas of a value string by scanning it
+        */
+        struct valueCommas
+        {
+            std::string_view value;
+
+            // Position of the first comma at or after w_pos (npos if none)
+            size_t next(size_t w_pos) const
+            {
+                return value.find(',', w_pos);
+            }
+
+            // Number of commas at or after w_pos
+            size_t count(size_t w_pos) const
+            {
+                return std::count(value.begin() + w_pos, value.end(), ',');
+            }
+        };
+
+       /*!
+        *  \brief Finds the commas of a value string in a structural index
+        */
+        struct indexedCommas
+        {
+            const char     *text;       // Indexed text
+            const uint32_t *first;      // Structural positions within the value
+            const uint32_t *last;
+            uint32_t        offset;     // Position of the value in text
+
+            size_t next(size_t w_pos)
+            {
+                // Positions are requested in ascending order
+                while(first != last && (*first - offset < w_pos || text[*first] != ','))
+                {
+                    first++;
+                }
+
+                return first == last? std::string_view::npos : *first - offset;
+            }
+
+            size_t count(size_t w_pos) const
+            {
+                size_t n = 0;
+
+                for(const uint32_t *p = first; p != last; p++)
+                {
+                    n += *p - offset >= w_pos && text[*p] == ',';
+                }
+
+                return n;
+            }
+        };
+
+       /*!
+        *  \brief  Parses the raw value string of a configuration entry.
+        *
+        *  \param  w_config Configuration entry with rawString already set
+        */
+        static void parseValue(config_struct &w_config)
+        {
+            parseValue(w_config, valueCommas{w_config.rawString});
+        }
+
+       /*!
+        *  \brief  Parses a single line and returns a paramtername-value pair.
+        *          Parameters names can be made up of multiple words separated
+        *          by white spaces. Indentations can be with white spaces or TABs.
+        *          TABS between white spaces (or vice versa) are not allowed.
+        *          Every TAB in indentations is counted as one white space.
+        *
+        *          Every parameter-value pair is separated with a colon.
+        *          A field might not be followed by a value after the colon
+        *          in which case the type is set to "NO_VAL", and a sub-field is
+        *          expected to exist.
+        *
+        *          Note: Every parameter name & value (including arrays) pair is
+        *                expected to span a single line.
+        *
+        *  \param  w_line A view of the single-line string
+        *  \param  w_padding Number of indentation white spaces / TABs
+        *  \return An std::pair of paramter name & value
+        */
+        static paramValuePair  parseLine(std::string_view w_line, size_t &w_padding)
+        {
+            paramValuePair   pvPair;
+            std::string_view param;
+            std::string_view value;
+
+            if(tokenizeLine(w_line, w_padding, param, value))
+            {
+                pvPair.first.assign(param);
+                pvPair.second.rawString.assign(value);
+                parseValue(pvPair.second);
+            }
+
+            return pvPair;
+        }
+
+       /*!
+        *  \brief  Parses a single line and returns a paramtername-value pair.
+        *
+        *  \param  w_line A pointer to the single-line string
+        *  \param  w_padding Number of indentation white spaces / TABs
+        *  \return An std::pair of paramter name & value
+        */
+        static paramValuePair  parseLine(std::string *w_line, size_t &w_padding)
+        {
+            return parseLine(std::string_view(*w_line), w_padding);
+        }
+
+       /*!
+        *  \brief Tracks the full name of the current parameter while a
+        *         configuration is parsed line-by-line.
+        *
+        *  Every parameter is a sub-field of the closest preceeding parameter
+        *  with smaller indentation. Its full name is the concatenation of the
+        *  names of its parents and its own name, separated by a '.'
+        */
+        struct paramPath
+        {
+            std::string         fullParamName;
+            std::vector<size_t> paramLengths;
+            std::vector<size_t> paddingHistory;
+            size_t              lines = 0;      // Number of lines parsed
+
+           /*!
+            *  \brief  Checks whether a parameter at indentation w_padding ends
+            *          the current parameter (i.e. it is not a sub-field of it)
+            */
+            bool closedBy(size_t w_padding) const
+            {
+                return !paddingHistory.empty() && w_padding <= paddingHistory.back();
+            }
+
+           /*!
+            *  \brief  Removes the current parameter; its parent becomes current
+            */
+            void leave()
+            {
+                paddingHistory.pop_back();
+                fullParamName.resize(fullParamName.size() - paramLengths.back());
+                paramLengths.pop_back();
+            }
+
+           /*!
+            *  \brief  Adds a sub-field to the current parameter
+            *
+            *  \param  w_param   Parameter name
+            *  \param  w_padding Indentation of the parameter
+            *  \return Full parameter name
+            */
+            const std::string & push(std::string_view w_param, size_t w_padding)
+            {
+                paddingHistory.push_back(w_padding);
+                paramLengths.push_back(fullParamName.empty()? w_param.size() : 1 + w_param.size());
+
+                if(!fullParamName.empty())
+                {
+                    fullParamName += '.';
+                }
+
+                fullParamName += w_param;
+
+                return fullParamName;
+            }
+
+           /*!
+            *  \brief  Makes w_param the current parameter
+            *
+            *  \param  w_param   Parameter name
+            *  \param  w_padding Indentation of the parameter
+            *  \return Full parameter name
+            */
+            const std::string & enter(std::string_view w_param, size_t w_padding)
+            {
+                // Rewind until the parent of the parameter is found
+                while(closedBy(w_padding))
+                {
+                    leave();
+                }
+
+                return push(w_param, w_padding);
+            }
+        };
+
+       /*!
+        *  \brief  Clears a configuration value so that it can be reused.
+        *          Allocated capacity is kept.
+        */
+        static void resetValue(config_struct &w_config)
+        {
+            w_config.type = config_struct::type_::NO_VAL;
+            w_config.rawString.clear();
+            w_config.stringVal.clear();
+            w_config.boolVal.clear();
+            w_config.floatVal.clear();
+            w_config.intVal.clear();
+            w_config.int64Val.clear();
+            w_config.uint64Val.clear();
+            w_config.doubleVal.clear();
+        }
+
+       /*!
+        *  \brief Receiver of parse events.
+        *
+        *  The event-driven parse functions (parseBufferEvents, parseFileEvents)
+        *  call the following member functions of a handler object. A handler
+        *  can derive from parseHandler and define only the events it needs.
+        *  Every event returns false to stop parsing.
+        *
+        *  - onEnterSection(fullName): a parameter is found. Its sub-fields
+        *    (if any) follow until the matching onLeaveSection.
+        *  - onValue(fullName, value): the parameter just entered has a value.
+        *    The value object is reused for the next line; its contents may be
+        *    moved out.
+        *  - onLeaveSection(fullName): all sub-fields of a parameter are parsed.
+        *
+        *  Names are views which are valid during the call only.
+        *
+        *  A handler with a static constant decodeValues set to false gets
+        *  the values undecoded: onValue is called for every non-empty value
+        *  string, with the string in rawString and type NO_VAL. Its line and
+        *  column are those of the active parseLocation.
+        */
+        struct parseHandler
+        {
+            bool onEnterSection(std::string_view)
+            {
+                return true;
+            }
+
+            bool onLeaveSection(std::string_view)
+            {
+                return true;
+            }
+
+            bool onValue(std::string_view, config_struct &)
+            {
+                return true;
+            }
+        };
+
+       /*!
+        *  \brief Tells whether a parse event handler gets decoded values (see
+        *         parseHandler)
+        */
+        template<typename Handler, typename = void>
+        struct handlerDecodes : std::true_type
+        {
+        };
+
+        template<typename Handler>
+        struct handlerDecodes<Handler, std::void_t<decltype(Handler::decodeValues)>>
+            : std::integral_constant<bool, Handler::decodeValues>
+        {
+        };
+
+       /*!
+        *  \brief Parse event handler which adds every value to a configuration
+        *         list
+        */
+        struct configListBuilder : parseHandler
+        {
+            explicit configListBuilder(configList &w_config) : config(w_config)
+            {
+            }
+
+            bool onValue(std::string_view w_fullName, config_struct &w_value)
+            {
+                config.emplace(std::string(w_fullName), std::move(w_value));
+                return true;
+            }
+
+            configList &config;
+        };
+
+       /*!
+        *  \brief  Parses a single line and reports it to a parse event handler
+        *
+        *  \param  w_line    A view of the single-line string
+        *  \param  w_path    Parameter names of the preceeding lines
+        *  \param  w_value   Value object (reused for every line)
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether parsing should continue
+        */
+        template<typename Handler>
+        static bool parseLineEvents(std::string_view w_line, paramPath &w_path,
+                                    config_struct &w_value, Handler &w_handler)
+        {
+            size_t           padding;
+            std::string_view param;
+            std::string_view value;
+            bool             valid;
+            parseLocation      location;
+            parseLocationScope locationScope(location);
+
+            location.line = ++w_path.lines;
+            location.text = w_line;
+
+            statsCountLine(w_line.size());
+
+            {
+                statsTimer timer(parseStats::TOKENIZE);
+                valid = tokenizeLine(w_line, padding, param, value);
+            }
+
+            if(!valid)
+            {
+                return !location.stop; // Ignore
+            }
+
+            {
+                statsTimer timer(!value.empty() && value[0] == '['? parseStats::ARRAYS : parseStats::CLASSIFY);
+                resetValue(w_value);
+                w_value.rawString.assign(value);
+                location.value       = w_value.rawString;
+                location.valueColumn = (size_t)(value.data() - w_line.data());
+
+                if constexpr(handlerDecodes<Handler>::value)
+                {
+                    parseValue(w_value);
+                }
+            }
+
+            if(location.stop)
+            {
+                return false;
+            }
+
+            statsCountParam(w_value);
+
+            statsTimer timer(parseStats::INSERT);
+            return reportParam(padding, param, w_path, w_value, w_handler);
+        }
+
+       /*!
+        *  \brief  Reports a tokenized parameter, whose value is parsed
+        *          already, to a parse event handler
+        *
+        *  \param  w_padding Indentation of the parameter
+        *  \param  w_param   Parameter name
+        *  \param  w_path    Parameter names of the preceeding lines
+        *  \param  w_value   Parsed value
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether parsing should continue
+        */
+        template<typename Handler>
+        static bool reportParam(size_t w_padding, std::string_view w_param, paramPath &w_path,
+                                config_struct &w_value, Handler &w_handler)
+        {
+            // Rewind until the parent of the parameter is found
+            while(w_path.closedBy(w_padding))
+            {
+                if(!w_handler.onLeaveSection(w_path.fullParamName))
+                {
+                    return false;
+                }
+
+                w_path.leave();
+            }
+
+            const std::string &fullParamName = w_path.push(w_param, w_padding);
+
+            if(!w_handler.onEnterSection(fullParamName))
+            {
+                return false;
+            }
+
+            // Check if the current parameter has an associated value
+            if(w_value.type != config_struct::type_::NO_VAL ||
+               (!handlerDecodes<Handler>::value && !w_value.rawString.empty()))
+            {
+                return w_handler.onValue(fullParamName, w_value);
+            }
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Parses lines of text and reports them to a parse event
+        *          handler.
+        *
+        *  The text is processed in blocks of whole lines. The structural
+        *  characters of a block are indexed in one vectorized pass (see
+        *  scanStructural), and the lines, their first colon and the commas of
+        *  array values are then taken from the index instead of being
+        *  searched for.
+        *
+        *  \param  w_text    Lines of text. The last line may lack a line end.
+        *  \param  w_index   Index of a block (reused to keep its capacity)
+        *  \param  w_path    Parameter names of the preceeding lines
+        *  \param  w_value   Value object (reused for every line)
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether parsing should continue
+        */
+        template<typename Handler>
+        static bool parseLinesEvents(std::string_view w_text, structuralIndex &w_index, paramPath &w_path,
+                                     config_struct &w_value, Handler &w_handler)
+        {
+            const size_t       blockSize = 256 * 1024;
+            parseLocation      location;
+            parseLocationScope locationScope(location);
+
+            while(!w_text.empty())
+            {
+                // Blocks end after a line end, so that no line spans two blocks
+                size_t size = w_text.size();
+
+                if(size > blockSize)
+                {
+                    size_t n = w_text.rfind('\n', blockSize - 1);
+                    n        = n == std::string_view::npos? w_text.find('\n', blockSize) : n;
+                    size     = n == std::string_view::npos? w_text.size() : n + 1;
+                }
+
+                std::string_view block = w_text.substr(0, size);
+                w_text.remove_prefix(size);
+
+                if(block.size() > UINT32_MAX)
+                {
+                    // A line too long to be indexed
+                    if(!parseLineEvents(block.substr(0, block.find('\n')), w_path, w_value, w_handler))
+                    {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                {
+                    statsTimer timer(parseStats::SCAN);
+                    w_index.build(block);
+                }
+
+                const uint32_t *p   = w_index.begin();
+                const uint32_t *end = w_index.end();
+                size_t          lineStart = 0;
+
+                while(lineStart < block.size())
+                {
+                    const uint32_t *lineFirst = p;
+                    size_t          colon     = std::string_view::npos;
+
+                    for(; p != end && block[*p] != '\n'; p++)
+                    {
+                        if(colon == std::string_view::npos && block[*p] == ':')
+                        {
+                            colon = *p - lineStart;
+                        }
+                    }
+
+                    size_t           lineEnd = p == end? block.size() : *p;
+                    std::string_view line    = block.substr(lineStart, lineEnd - lineStart);
+                    size_t           padding;
+                    std::string_view param;
+                    std::string_view value;
+                    bool             valid;
+
+                    location.line = ++w_path.lines;
+                    location.text = line;
+
+                    statsCountLine(line.size());
+
+                    {
+                        statsTimer timer(parseStats::TOKENIZE);
+                        valid = tokenizeLine(line, colon, padding, param, value);
+                    }
+
+                    if(valid)
+                    {
+                        {
+                            statsTimer timer(!value.empty() && value[0] == '['? parseStats::ARRAYS : parseStats::CLASSIFY);
+                            resetValue(w_value);
+                            w_value.rawString.assign(value);
+
+                            if(!value.empty())
+                            {
+                                location.value       = w_value.rawString;
+                                location.valueColumn = (size_t)(value.data() - line.data());
+
+                                if constexpr(handlerDecodes<Handler>::value)
+                                {
+                                    uint32_t offset = (uint32_t)(value.data() - block.data());
+
+                                    while(lineFirst != p && *lineFirst < offset)
+                                    {
+                                        lineFirst++;
+                                    }
+
+                                    parseValue(w_value, indexedCommas{block.data(), lineFirst, p, offset});
+                                }
+                            }
+                        }
+
+                        if(location.stop)
+                        {
+                            return false;
+                        }
+
+                        statsCountParam(w_value);
+
+                        statsTimer timer(parseStats::INSERT);
+
+                        if(!reportParam(padding, param, w_path, w_value, w_handler))
+                        {
+                            return false;
+                        }
+                    }
+                    else if(location.stop)
+                    {
+                        return false;
+                    }
+
+                    lineStart = lineEnd + 1;
+
+                    if(p != end)
+                    {
+                        p++;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Reports the end of all open parameters to a parse event
+        *          handler
+        *
+        *  \param  w_path    Parameter names of the preceeding lines
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether parsing should continue
+        */
+        template<typename Handler>
+        static bool leaveAllSections(paramPath &w_path, Handler &w_handler)
+        {
+            while(!w_path.paddingHistory.empty())
             {
-                return pvPair;
+                if(!w_handler.onLeaveSection(w_path.fullParamName))
+                {
+                    return false;
+                }
+
+                w_path.leave();
             }
-            
-            // Every valid parameter-value pair should be separated by a colon (:)
-            std::string::size_type n;
-            
-            n = trimmed.find(':');
-            
-            if(n == std::string::npos || n == 0)
+
+            return true;
+        }
+
+       /*!
+        *  \brief  Parses a configuration held in memory and reports its
+        *          contents to a parse event handler
+        *
+        *  No configuration list is built; memory use does not depend on the
+        *  size of the configuration.
+        *
+        *  \param  w_buffer  Configuration text (owned by the caller)
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether the whole buffer is parsed (i.e.
+        *          neither the handler nor a strict diagnostic
+        *          collector stopped parsing)
+        */
+        template<typename Handler>
+        static bool parseBufferEvents(std::string_view w_buffer, Handler &w_handler)
+        {
+            paramPath       path;
+            config_struct   value;
+            structuralIndex index;
+
+            if(!parseLinesEvents(w_buffer, index, path, value, w_handler))
             {
-                fprintf(stderr, "%s\n", ("Invalid    ---" + *w_line).c_str());
-                return pvPair;  // Invalid
+                return false;
             }
-            
-            std::string paramString = trimmWhiteSpaces(trimmed.substr(0,n));
-            std::string valString   = n < trimmed.size()? trimmWhiteSpaces(trimmed.substr(n+1)) : "";
-            
-            if(paramString.empty())
+
+            return leaveAllSections(path, w_handler);
+        }
+
+       /*!
+        *  \brief  Parses a configuration read from a stream and reports its
+        *          contents to a parse event handler
+        *
+        *  The stream is read in blocks, and the lines are tokenized in the
+        *  read buffer. No configuration list is built; memory use depends only
+        *  on the block size and the length of the longest line.
+        *
+        *  \param  w_stream  Input stream
+        *  \param  w_handler Parse event handler
+        *  \return Flag indicates whether the whole stream is parsed (i.e. no
+        *          read error occured, and neither the handler nor a strict
+        *          diagnostic collector stopped parsing)
+        */
+        template<typename Handler>
+        static bool parseStreamEvents(std::istream &w_stream, Handler &w_handler)
+        {
+            const size_t  blockSize = 64 * 1024;
+            std::string   buffer;
+            size_t        used = 0;    // Bytes of a partial line at the start of buffer
+            paramPath       path;
+            config_struct   value;
+            structuralIndex index;
+
+            while(w_stream)
             {
-                fprintf(stderr, "Invalid: Missing param");
-                return pvPair;
+                if(buffer.size() < used + blockSize)
+                {
+                    buffer.resize(used + blockSize);
+                }
+
+                {
+                    statsTimer timer(parseStats::READ);
+                    w_stream.read(&buffer[used], blockSize);
+                }
+
+                size_t end = used + (size_t)w_stream.gcount();
+
+                // Parse all complete lines
+                std::string_view lines(buffer.data(), end);
+                size_t           n = lines.rfind('\n');
+
+                if(n != std::string_view::npos)
+                {
+                    if(!parseLinesEvents(lines.substr(0,n+1), index, path, value, w_handler))
+                    {
+                        return false;
+                    }
+
+                    lines.remove_prefix(n+1);
+                }
+
+                // Move the partial line to the start of the buffer
+                used = lines.size();
+                memmove(&buffer[0], lines.data(), used);
             }
-            
-            pvPair.first = paramString;
-            pvPair.second.rawString = valString;
-            
-            std::vector<std::string> stringVals(1,"");
-            std::vector<uint8_t>     boolVals(1,false);
-            std::vector<float>       floatVals(1,0.0);
-            std::vector<int>         intVals(1,0);
-            
-            // Parse value
-            if(valString.empty())
+
+            if(w_stream.bad())
             {
-                // No val
+                return false;
+            }
+
+            if(used > 0 && !parseLineEvents(std::string_view(buffer.data(), used), path, value, w_handler))
+            {
+                return false;
             }
-            else if (parseAsString(valString, stringVals.back()))
+
+            return leaveAllSections(path, w_handler);
+        }
+
+       /*!
+        *  \brief  Parses a configuration file and reports its contents to a
+        *          parse event handler
+        *
+        *  No configuration list is built; memory use depends only on the
+        *  length of the longest line.
+        *
+        *  \param  w_fileName Configuration file name
+        *  \param  w_handler  Parse event handler
+        *  \return Flag indicates whether the whole file is parsed (i.e. it
+        *          could be read, and neither the handler nor a strict
+        *          diagnostic collector stopped parsing)
+        */
+        template<typename Handler>
+        static bool parseFileEvents(const std::string &w_fileName, Handler &w_handler)
+        {
+            std::ifstream file (w_fileName.c_str());
+
+            // Check if the file is open
+            if (!file.is_open())
             {
-                pvPair.second.type      = config_struct::type_::STRING;
-                pvPair.second.stringVal = stringVals;
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return false;
             }
-            else if(valString[0] == '[' && valString.back() == ']')
+
+            bool retVal = parseStreamEvents(file, w_handler);
+
+            // Check whether error has occured while reading the file
+            if (file.bad())
             {
-                // Array
-                if(valString.size() < 3)
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_READ, nullptr,
+                             "Error while reading file %s\n", w_fileName.c_str());
+            }
+
+            return retVal;
+        }
+
+       /*!
+        *  \brief  Parses a single line and adds its value (if any) to a
+        *          configuration list.
+        *
+        *  \param  w_line   A view of the single-line string
+        *  \param  w_path   Parameter names of the preceeding lines
+        *  \param  w_config Configuration list to be updated
+        */
+        static void parseLine(std::string_view w_line, paramPath &w_path, configList &w_config)
+        {
+            config_struct     value;
+            configListBuilder builder(w_config);
+
+            parseLineEvents(w_line, w_path, value, builder);
+        }
+
+       /*!
+        *  \brief  Parses a configuration held in memory and adds its values to
+        *          a configuration list.
+        *
+        *  \param  w_buffer Configuration text (owned by the caller)
+        *  \param  w_path   Parameter names of the preceeding lines
+        *  \param  w_config Configuration list to be updated
+        *  \return Flag indicates whether the whole buffer was parsed (false
+        *          if a strict diagnostic collector stopped it)
+        */
+        static bool parseBuffer(std::string_view w_buffer, paramPath &w_path, configList &w_config)
+        {
+            config_struct     value;
+            structuralIndex   index;
+            configListBuilder builder(w_config);
+
+            return parseLinesEvents(w_buffer, index, w_path, value, builder);
+        }
+
+       /*!
+        *  \brief  Parses a configuration held in memory
+        *
+        *  The buffer is tokenized in place, and copies are made only for the
+        *  parameter names and values stored in the returned list. The format
+        *  is the same as for parseFile.
+        *
+        *  \param  w_buffer Configuration text (owned by the caller)
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseBuffer(std::string_view w_buffer)
+        {
+            configList        config;
+            configListBuilder builder(config);
+
+            parseBufferEvents(w_buffer, builder);
+            return config;
+        }
+
+       /*!
+        *  \brief  Parses a configuration held in a contiguous buffer, e.g. a
+        *          byte array embedded in the binary with #embed or xxd -i.
+        *
+        *  \param  w_data Configuration text (owned by the caller)
+        *  \param  w_size Size of the text in bytes
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseBuffer(const void *w_data, size_t w_size)
+        {
+            return parseBuffer(std::string_view(static_cast<const char*>(w_data), w_size));
+        }
+
+       /*!
+        *  \brief  Parses a configuration read from a stream
+        *
+        *  \param  w_stream Input stream (e.g. std::cin or std::istringstream)
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseStream(std::istream &w_stream)
+        {
+            configList        config;
+            configListBuilder builder(config);
+
+            parseStreamEvents(w_stream, builder);
+            return config;
+        }
+
+       /*!
+        *  \brief Read-only view of a whole file.
+        *
+        *  The file is memory-mapped where the platform supports it, and read
+        *  into memory otherwise.
+        */
+        class mappedFile
+        {
+        public:
+            mappedFile() = default;
+            mappedFile(const mappedFile&) = delete;
+            mappedFile& operator=(const mappedFile&) = delete;
+
+            ~mappedFile()
+            {
+                close();
+            }
+
+           /*!
+            *  \brief  Maps a file
+            *
+            *  \param  w_fileName File name
+            *  \return Flag indicates success or failure
+            */
+            bool open(const std::string &w_fileName)
+            {
+                close();
+
+                #ifdef YCONFPARSER_HAS_MMAP
+                int fd = ::open(w_fileName.c_str(), O_RDONLY);
+
+                if(fd < 0)
                 {
-                    return pvPair; // Empty array
+                    return false;
                 }
-                
-                std::string elements = valString.substr(1,valString.size()-2);
-                config_struct::type_ elementType = config_struct::type_::NO_VAL;
-                
-                while(true)
+
+                struct stat st;
+                bool        retVal = fstat(fd, &st) == 0;
+
+                if(retVal && st.st_size > 0)
                 {
-                    std::string::size_type n = elements.find(',');
-                    std::string element      = n==std::string::npos? elements : elements.substr(0,n);
-                    
-                    element = trimmWhiteSpaces(element);
-                    
-                    if (parseAsString(element, stringVals.back()))
-                    {
-                        elementType = config_struct::type_::STRING;
-                        stringVals.push_back("");
-                    }
-                    else if (parseAsBoolean(element, boolVals.back()))
-                    {
-                        // Boolean TRUE
-                        elementType = config_struct::type_::BOOLEAN;
-                        boolVals.push_back(false);
-                    }
-                    else if (parseAsFloat(element, floatVals.back()))
-                    {
-                        // Floating-point number
-                        elementType = config_struct::type_::FLOAT;
-                        floatVals.push_back(0);
-                    }
-                    else if (parseAsInteger(element, intVals.back()))
+                    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                    if(addr == MAP_FAILED)
                     {
-                        // Integer
-                        elementType = config_struct::type_::INTEGER;
-                        intVals.push_back(0);
+                        retVal = false;
                     }
                     else
                     {
-                        fprintf(stderr, "Unknown type: %s\n", element.c_str());
-                        break;
-                    }
-                    
-                    if(pvPair.second.type == config_struct::type_::NO_VAL)
-                    {
-                        pvPair.second.type = elementType;
+                        madvise(addr, st.st_size, MADV_SEQUENTIAL);
+                        mapped = static_cast<const char*>(addr);
+                        length = st.st_size;
                     }
-                    else if(pvPair.second.type != elementType)
-                    {
-                        fprintf(stderr, "Array entries should have the same type\n");
-                        break;
-                    }
-                    
-                    if(n==std::string::npos)
-                    {
-                        break;
-                    }
-                    
-                    if((n+1) >= elements.size())
-                    {
-                        break;
-                    }
-                    
-                    elements = trimmWhiteSpaces(elements.substr(n+1));
                 }
-                
-                // Copy parsed array elements
-                if(elementType != config_struct::type_::NO_VAL)
+
+                ::close(fd);
+                return retVal;
+                #else
+                std::ifstream file (w_fileName.c_str(), std::ios::binary);
+
+                if(!file.is_open())
                 {
-                    switch (elementType)
-                    {
-                        case config_struct::type_::STRING:
-                            stringVals.pop_back(); // Remove the last unassigned element
-                            pvPair.second.stringVal = stringVals;
-                            break;
-                        case config_struct::type_::BOOLEAN:
-                            boolVals.pop_back(); // Remove the last unassigned element
-                            pvPair.second.boolVal = boolVals;
-                            break;
-                        case config_struct::type_::FLOAT:
-                            floatVals.pop_back(); // Remove the last unassigned element
-                            pvPair.second.floatVal = floatVals;
-                            break;
-                        default: // config_struct::type_::INTEGER:
-                            intVals.pop_back(); // Remove the last unassigned element
-                            pvPair.second.intVal = intVals;
-                            break;
-                    }
+                    return false;
                 }
-                
+
+                contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                return !file.bad();
+                #endif
             }
-            else if (parseAsBoolean(valString, boolVals.back()))
+
+           /*!
+            *  \brief Unmaps the file (if any)
+            */
+            void close()
             {
-                // Boolean TRUE
-                pvPair.second.type    = config_struct::type_::BOOLEAN;
-                pvPair.second.boolVal = boolVals;
+                #ifdef YCONFPARSER_HAS_MMAP
+                if(mapped != nullptr)
+                {
+                    munmap(const_cast<char*>(mapped), length);
+                }
+
+                mapped = nullptr;
+                length = 0;
+                #else
+                contents.clear();
+                #endif
+            }
+
+           /*!
+            *  \brief  View of the file contents
+            */
+            std::string_view view() const
+            {
+                #ifdef YCONFPARSER_HAS_MMAP
+                return std::string_view(mapped, length);
+                #else
+                return contents;
+                #endif
             }
-            else if (parseAsFloat(valString, floatVals.back()))
+
+        private:
+            #ifdef YCONFPARSER_HAS_MMAP
+            const char *mapped = nullptr;
+            size_t      length = 0;
+            #else
+            std::string contents;
+            #endif
+        };
+
+       /*!
+        *  \brief  Parses a configuration file without reading it line-by-line
+        *
+        *  The file is memory-mapped and parsed with parseBuffer. The result
+        *  is the same as for parseFile.
+        *
+        *  \param  w_fileName Configuration file name
+        *  \return A dictionary of paramter names and associated values
+        */
+        static configList parseFileMapped(const std::string &w_fileName)
+        {
+            mappedFile file;
+            bool       opened;
+
             {
-                // Floating-point number
-                pvPair.second.type     = config_struct::type_::FLOAT;
-                pvPair.second.floatVal = floatVals;
+                statsTimer timer(parseStats::READ);
+                opened = file.open(w_fileName);
             }
-            else if (parseAsInteger(valString, intVals.back()))
+
+            if(!opened)
             {
-                // Integer
-                pvPair.second.type      = config_struct::type_::INTEGER;
-                pvPair.second.intVal = intVals;
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return configList();
             }
-            
-            return pvPair;            
+
+            return parseBuffer(file.view());
         }
-        
+
        /*!
         *  \brief  Parses a configuration file
         *
@@ -533,69 +2895,10 @@ namespace ylibs
         */
         static configList parseFile(std::string w_fileName)
         {
-            std::ifstream       file (w_fileName.c_str());
-            std::string         line;
-            configList          config;
-            paramValuePair      pvPair;
-            std::string         fullParamName("");
-            std::vector<size_t> paramLengths;
-            std::vector<size_t> paddingHistory;
-            size_t              currentPadding = 0;
-            
-            // Check if the file is open
-            if (!file.is_open())
-            {
-                fprintf(stderr, "%s\n", ("error while opening file " + w_fileName).c_str());
-                return config;
-            }
+            configList        config;
+            configListBuilder builder(config);
 
-            // Parse the file line-by-line
-            while(getline(file, line))
-            {
-                pvPair = parseLine(&line, currentPadding);
-                
-                if(pvPair.first.empty() || pvPair.second.type == config_struct::type_::NO_VAL)
-                {
-                    continue; // Ignore
-                }
-                
-                if(!paddingHistory.empty())
-                {
-                    if(currentPadding <= paddingHistory.back()) // not sub-field
-                    { 
-                        // Rewind
-                        while(paddingHistory.size() > 0)
-                        {
-                            paddingHistory.pop_back();
-                            fullParamName = fullParamName.substr(0, fullParamName.size() - paramLengths.back());
-                            paramLengths.pop_back();
-                            
-                            if(currentPadding > paddingHistory.back())
-                            {
-                                break;
-                            }
-                        }
-                    }
-                }
-                    
-                paddingHistory.push_back(currentPadding);
-                paramLengths.push_back(1 + pvPair.first.size());
-                fullParamName += fullParamName.empty()? pvPair.first : "." + pvPair.first;
-                
-                // Check if the current parameter has an associated value
-                if(pvPair.second.type != config_struct::type_::NO_VAL)
-                {
-                    config.insert({fullParamName, pvPair.second});
-                }
-            }
-            
-            // Check whether error has occured while reading the file
-            if (file.bad())
-            {
-                fprintf(stderr, "%s\n", ("Error while reading file " + w_fileName).c_str());
-            }
-            
-            file.close();
+            parseFileEvents(w_fileName, builder);
             return config;
         }
 
@@ -658,6 +2961,45 @@ namespace ylibs
                         
                         std::cout << (c.second.intVal.size() > 1? "]" : "") << std::endl;
                         break;
+
+                    case ylibs::yconfparser::config_struct::type_::INT64:
+                    
+                        std::cout << (c.second.int64Val.size() > 1? " = <L>[" : " = <L>");
+                        
+                        for (unsigned n=0; n<c.second.int64Val.size(); n++)
+                        {
+                            std::cout << (n>0? ", " : "");
+                            std::cout << c.second.int64Val[n];
+                        }
+                        
+                        std::cout << (c.second.int64Val.size() > 1? "]" : "") << std::endl;
+                        break;
+
+                    case ylibs::yconfparser::config_struct::type_::UINT64:
+                    
+                        std::cout << (c.second.uint64Val.size() > 1? " = <U>[" : " = <U>");
+                        
+                        for (unsigned n=0; n<c.second.uint64Val.size(); n++)
+                        {
+                            std::cout << (n>0? ", " : "");
+                            std::cout << c.second.uint64Val[n];
+                        }
+                        
+                        std::cout << (c.second.uint64Val.size() > 1? "]" : "") << std::endl;
+                        break;
+
+                    case ylibs::yconfparser::config_struct::type_::DOUBLE:
+                    
+                        std::cout << (c.second.doubleVal.size() > 1? " = <D>[" : " = <D>");
+                        
+                        for (unsigned n=0; n<c.second.doubleVal.size(); n++)
+                        {
+                            std::cout << (n>0? ", " : "");
+                            std::cout << c.second.doubleVal[n];
+                        }
+                        
+                        std::cout << (c.second.doubleVal.size() > 1? "]" : "") << std::endl;
+                        break;
                 }
             }
         }
@@ -0,0 +1,474 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Configuration shared by many threads and updated at run time
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "YConfParser.hpp"
+#include "YConfFrozen.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Reader epochs shared by all configRegistry objects of the
+        *         process (epoch-based reclamation).
+        *
+        *  Every reading thread owns a slot for its lifetime, so announcing a
+        *  read is a plain store: no compare-and-swap, no retry, no lock. A
+        *  thread claims its slot on its first read (and waits there if more
+        *  than slotCount threads read at the same time).
+        */
+        class readerEpochs
+        {
+        public:
+            static constexpr size_t   slotCount = 1024;
+            static constexpr uint64_t idle      = UINT64_MAX;
+
+            struct alignas(64) slot
+            {
+                std::atomic<uint64_t> epoch{idle};
+                std::atomic<bool>     owned{false};
+                size_t                depth = 0;    // Nested reads (only used by the owner)
+            };
+
+           /*!
+            *  \brief Marks the calling thread as reading until leave() is
+            *         called. Calls can be nested.
+            */
+            static slot & enter()
+            {
+                slot &s = threadSlot();
+
+                if(s.depth++ == 0)
+                {
+                    s.epoch.store(current().load());
+                }
+
+                return s;
+            }
+
+            static void leave(slot &w_slot)
+            {
+                if(--w_slot.depth == 0)
+                {
+                    w_slot.epoch.store(idle, std::memory_order_release);
+                }
+            }
+
+           /*!
+            *  \brief  Starts a new epoch
+            *
+            *  \return The new epoch. Objects unpublished before are not used
+            *          by readers once oldest() reaches it.
+            */
+            static uint64_t advance()
+            {
+                return current().fetch_add(1) + 1;
+            }
+
+           /*!
+            *  \brief  Oldest epoch announced by a reader (idle if none)
+            */
+            static uint64_t oldest()
+            {
+                uint64_t epoch = idle;
+
+                for(size_t n=0; n<slotCount; n++)
+                {
+                    epoch = std::min(epoch, slots()[n].epoch.load());
+                }
+
+                return epoch;
+            }
+
+        private:
+
+            static std::atomic<uint64_t> & current()
+            {
+                static std::atomic<uint64_t> epoch{0};
+                return epoch;
+            }
+
+            static slot * slots()
+            {
+                static slot table[slotCount];
+                return table;
+            }
+
+            // Slot of the calling thread, released when the thread exits
+            struct owner
+            {
+                slot *claimed = nullptr;
+
+                ~owner()
+                {
+                    if(claimed != nullptr)
+                    {
+                        claimed->owned.store(false, std::memory_order_release);
+                    }
+                }
+            };
+
+            static slot & threadSlot()
+            {
+                static thread_local owner self;
+
+                if(self.claimed == nullptr)
+                {
+                    size_t n = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+                    for(;; n++)
+                    {
+                        slot &s = slots()[n % slotCount];
+                        bool  expected = false;
+
+                        if(!s.owned.load() && s.owned.compare_exchange_strong(expected, true))
+                        {
+                            self.claimed = &s;
+                            break;
+                        }
+
+                        if(n % slotCount == slotCount - 1)
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+
+                return *self.claimed;
+            }
+        };
+
+       /*!
+        *  \brief Configuration shared by many threads, which is read far more
+        *         often than it is changed.
+        *
+        *  The parameters are spread over shards by the hash of their name.
+        *  Every shard is published as an immutable frozenConfig through an
+        *  atomic pointer; a write copies the shard it changes (copy-on-write)
+        *  and publishes the copy, so readers never wait for a writer, and a
+        *  write copies about 1/shardCount of the configuration.
+        *
+        *  Reads take no lock and never retry: find() announces the reading
+        *  thread in its own reader slot (see readerEpochs) and looks the name
+        *  up in the published shard. A replaced shard is freed by a later
+        *  write once no reader can still use it. Writes are serialized by a
+        *  mutex.
+        *
+        *  A read sees every write completed before it started. Shards are
+        *  published one by one, so several reads made during reset() may see
+        *  old and new values; use reloadableConfig where whole configurations
+        *  have to be switched at once.
+        */
+        class configRegistry
+        {
+            static constexpr size_t shardCount = 256;
+
+        public:
+
+           /*!
+            *  \brief Access to a value of a configRegistry.
+            *
+            *  The value stays valid (and unchanged) while the reference exists.
+            *  References are meant to be short-lived, since they delay freeing
+            *  of replaced shards (but never block a writer).
+            */
+            class valueRef
+            {
+            public:
+                valueRef(const valueRef&) = delete;
+                valueRef& operator=(const valueRef&) = delete;
+
+                valueRef(valueRef &&w_other) : slot(w_other.slot), value(w_other.value)
+                {
+                    w_other.slot = nullptr;
+                }
+
+                ~valueRef()
+                {
+                    if(slot != nullptr)
+                    {
+                        readerEpochs::leave(*slot);
+                    }
+                }
+
+                // Flag indicates whether the parameter exists
+                explicit operator bool() const
+                {
+                    return value != nullptr;
+                }
+
+                const config_struct * operator->() const
+                {
+                    return value;
+                }
+
+                const config_struct & operator*() const
+                {
+                    return *value;
+                }
+
+                const config_struct * get() const
+                {
+                    return value;
+                }
+
+            private:
+                friend class configRegistry;
+
+                valueRef(readerEpochs::slot *w_slot, const config_struct *w_value) : slot(w_slot), value(w_value)
+                {
+                }
+
+                readerEpochs::slot  *slot;
+                const config_struct *value;
+            };
+
+            configRegistry()
+            {
+                for(auto &s : shards)
+                {
+                    s.published.store(new frozenConfig());
+                }
+            }
+
+           /*!
+            *  \brief Publishes a configuration list, e.g. from parseFile()
+            */
+            explicit configRegistry(configList w_config) : configRegistry()
+            {
+                reset(std::move(w_config));
+            }
+
+            configRegistry(const configRegistry&) = delete;
+            configRegistry& operator=(const configRegistry&) = delete;
+
+           /*!
+            *  \brief No reader may be active
+            */
+            ~configRegistry()
+            {
+                for(auto &s : shards)
+                {
+                    delete s.published.load();
+                }
+
+                for(auto &r : retired)
+                {
+                    delete r.shard;
+                }
+            }
+
+           /*!
+            *  \brief  Finds a value by its full parameter name without taking
+            *          a lock
+            *
+            *  \param  w_name Full parameter name
+            *  \return Reference to the value, which is empty if the parameter
+            *          does not exist
+            */
+            valueRef find(std::string_view w_name) const
+            {
+                paramKey            key(w_name);
+                readerEpochs::slot &slot = readerEpochs::enter();
+
+                return valueRef(&slot, shardOf(key.hash).published.load()->find(key));
+            }
+
+            bool contains(std::string_view w_name) const
+            {
+                return (bool)find(w_name);
+            }
+
+           /*!
+            *  \brief  Adds or replaces a parameter
+            *
+            *  \param  w_name  Full parameter name
+            *  \param  w_value New value
+            */
+            void set(std::string_view w_name, config_struct w_value)
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                shard &s = shardOf(hashString(w_name));
+
+                s.values[std::string(w_name)] = std::move(w_value);
+                publish(s);
+                reclaim();
+            }
+
+           /*!
+            *  \brief  Removes a parameter
+            *
+            *  \param  w_name Full parameter name
+            *  \return Flag indicates whether the parameter existed
+            */
+            bool erase(std::string_view w_name)
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                shard &s = shardOf(hashString(w_name));
+
+                if(s.values.erase(std::string(w_name)) == 0)
+                {
+                    return false;
+                }
+
+                publish(s);
+                reclaim();
+                return true;
+            }
+
+           /*!
+            *  \brief  Replaces the whole configuration (the values are moved)
+            */
+            void reset(configList w_config)
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+
+                for(auto &s : shards)
+                {
+                    s.values.clear();
+                }
+
+                for(auto &c : w_config)
+                {
+                    shardOf(hashString(c.first)).values.emplace(c.first, std::move(c.second));
+                }
+
+                for(auto &s : shards)
+                {
+                    publish(s);
+                }
+
+                reclaim();
+            }
+
+           /*!
+            *  \brief  Copy of the current configuration
+            */
+            configList list() const
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                configList                  config;
+
+                for(auto &s : shards)
+                {
+                    config.insert(s.values.begin(), s.values.end());
+                }
+
+                return config;
+            }
+
+            size_t size() const
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                size_t                      count = 0;
+
+                for(auto &s : shards)
+                {
+                    count += s.values.size();
+                }
+
+                return count;
+            }
+
+           /*!
+            *  \brief  Number of replaced shards which are not yet freed
+            */
+            size_t pendingShards()
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                reclaim();
+                return retired.size();
+            }
+
+        private:
+
+            struct shard
+            {
+                std::atomic<const frozenConfig*> published{nullptr};
+                configList                       values;     // Source of the next copy (writerMutex)
+            };
+
+            struct retiredShard
+            {
+                const frozenConfig *shard;
+                uint64_t            epoch;  // Epoch started after it was replaced
+            };
+
+            // Shard of a parameter (the low hash bits; frozenConfig uses the high ones)
+            shard & shardOf(uint64_t w_hash)
+            {
+                return shards[w_hash & (shardCount - 1)];
+            }
+
+            const shard & shardOf(uint64_t w_hash) const
+            {
+                return shards[w_hash & (shardCount - 1)];
+            }
+
+            // Publishes a copy of a shard (writerMutex is held)
+            void publish(shard &w_shard)
+            {
+                const frozenConfig *old = w_shard.published.exchange(new frozenConfig(w_shard.values));
+                retired.push_back({old, readerEpochs::advance()});
+            }
+
+            // Frees replaced shards which no reader can be using (writerMutex is held)
+            void reclaim()
+            {
+                // A reader that announced an epoch older than the one started
+                // after a shard was replaced may still be using it
+                uint64_t oldest = readerEpochs::oldest();
+                size_t   kept   = 0;
+
+                for(auto &r : retired)
+                {
+                    if(oldest >= r.epoch)
+                    {
+                        delete r.shard;
+                    }
+                    else
+                    {
+                        retired[kept++] = r;
+                    }
+                }
+
+                retired.resize(kept);
+            }
+
+            shard                     shards[shardCount];
+            std::vector<retiredShard> retired;
+            mutable std::mutex        writerMutex;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
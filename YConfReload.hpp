@@ -0,0 +1,447 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Configuration file which is reloaded when it changes
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "YConfParser.hpp"
+#include "YConfFrozen.hpp"
+
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Immutable parsed configuration published by reloadableConfig
+        */
+        struct configSnapshot
+        {
+            frozenConfig config;
+            uint64_t     version;   // 1 for the first load, incremented by every reload
+        };
+
+       /*!
+        *  \brief Configuration file which is re-parsed in the background when
+        *         it changes.
+        *
+        *  Every (re)load publishes a new immutable configSnapshot through an
+        *  atomic pointer. Readers never take a lock: read() marks the calling
+        *  thread as active in a reader slot, and a replaced snapshot is freed
+        *  only when no reader slot still refers to the epoch it was replaced
+        *  in (epoch-based reclamation). When all slots are taken, readers
+        *  share a counter instead, and no replaced snapshot is freed while it
+        *  is not zero.
+        *
+        *  The file is watched with inotify on Linux (the directory is watched,
+        *  so files replaced by rename are noticed too), and by polling its
+        *  modification time elsewhere. A file is reloaded when it is closed
+        *  after writing or moved in place, not while it is being written.
+        *
+        *  The file is read into memory before it is parsed, so truncating it
+        *  during a reload does not affect the parse. If a reload fails because
+        *  the file cannot be read, the current snapshot stays published. If
+        *  the first load fails, an empty snapshot of version 0 is published
+        *  (see loaded()), so read() always gives a snapshot.
+        */
+        class reloadableConfig
+        {
+            static constexpr size_t   slotCount = 128;
+            static constexpr uint64_t idle      = UINT64_MAX;
+
+            struct alignas(64) readerSlot
+            {
+                std::atomic<uint64_t> epoch{idle};
+            };
+
+        public:
+
+           /*!
+            *  \brief Access to the published snapshot.
+            *
+            *  The snapshot stays valid while the reference exists. References
+            *  are meant to be short-lived, since they delay freeing of replaced
+            *  snapshots (but never block a reload).
+            */
+            class snapshotRef
+            {
+            public:
+                snapshotRef(const snapshotRef&) = delete;
+                snapshotRef& operator=(const snapshotRef&) = delete;
+
+                snapshotRef(snapshotRef &&w_other) : slot(w_other.slot), shared(w_other.shared), snapshot(w_other.snapshot)
+                {
+                    w_other.slot   = nullptr;
+                    w_other.shared = nullptr;
+                }
+
+                ~snapshotRef()
+                {
+                    if(slot != nullptr)
+                    {
+                        slot->epoch.store(idle, std::memory_order_release);
+                    }
+
+                    if(shared != nullptr)
+                    {
+                        shared->fetch_sub(1);
+                    }
+                }
+
+                const configSnapshot * operator->() const
+                {
+                    return snapshot;
+                }
+
+                const configSnapshot & operator*() const
+                {
+                    return *snapshot;
+                }
+
+            private:
+                friend class reloadableConfig;
+
+                snapshotRef(readerSlot *w_slot, std::atomic<size_t> *w_shared, const configSnapshot *w_snapshot)
+                    : slot(w_slot), shared(w_shared), snapshot(w_snapshot)
+                {
+                }
+
+                readerSlot           *slot;
+                std::atomic<size_t>  *shared;     // Counter of readers without a slot
+                const configSnapshot *snapshot;
+            };
+
+           /*!
+            *  \brief Loads a configuration file
+            *
+            *  \param w_fileName Configuration file name
+            *  \param w_watch    Flag indicates whether the file is watched for
+            *                    changes. Without watching, reload() has to be
+            *                    called explicitly.
+            */
+            explicit reloadableConfig(const std::string &w_fileName, bool w_watch = true) : fileName(w_fileName)
+            {
+                if(!reload())
+                {
+                    std::lock_guard<std::mutex> lock(writerMutex);
+                    publish(new configSnapshot{frozenConfig(configList()), 0});
+                }
+
+                if(w_watch)
+                {
+                    watcher = std::thread(&reloadableConfig::watch, this);
+                }
+            }
+
+            reloadableConfig(const reloadableConfig&) = delete;
+            reloadableConfig& operator=(const reloadableConfig&) = delete;
+
+           /*!
+            *  \brief Stops watching. No reader may be active.
+            */
+            ~reloadableConfig()
+            {
+                stopping.store(true);
+
+                if(watcher.joinable())
+                {
+                    watcher.join();
+                }
+
+                delete current.load();
+
+                for(auto &r : retired)
+                {
+                    delete r.snapshot;
+                }
+            }
+
+           /*!
+            *  \brief  Gets the published snapshot without taking a lock
+            */
+            snapshotRef read() const
+            {
+                // Spread threads over the slots to avoid contention
+                size_t n = std::hash<std::thread::id>()(std::this_thread::get_id()) % slotCount;
+
+                for(size_t tries=0; tries<slotCount; tries++)
+                {
+                    uint64_t expected = idle;
+                    uint64_t epoch    = globalEpoch.load();
+
+                    if(slots[n].epoch.compare_exchange_strong(expected, epoch))
+                    {
+                        return snapshotRef(&slots[n], nullptr, current.load());
+                    }
+
+                    n = (n + 1) % slotCount;
+                }
+
+                // All slots are taken: the snapshot is loaded after the counter
+                // is raised, so reclaim() either sees the reader or has replaced
+                // the snapshot before it is loaded
+                sharedReaders.fetch_add(1);
+                return snapshotRef(nullptr, &sharedReaders, current.load());
+            }
+
+           /*!
+            *  \brief  Re-parses the file and publishes the result
+            *
+            *  \return Flag indicates success or failure (the file could not be
+            *          read)
+            */
+            bool reload()
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                std::ifstream               file(fileName.c_str(), std::ios::binary);
+
+                if(!file.is_open())
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                                 "error while opening file %s\n", fileName.c_str());
+                    return false;
+                }
+
+                // Read into an owned buffer: a mapping of the file would fault
+                // if the file were truncated while it is parsed
+                std::string contents;
+                char        block[64 * 1024];
+
+                while(file.read(block, sizeof(block)) || file.gcount() > 0)
+                {
+                    contents.append(block, (size_t)file.gcount());
+                }
+
+                if(file.bad())
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_READ, nullptr,
+                                 "Error while reading file %s\n", fileName.c_str());
+                    return false;
+                }
+
+                publish(new configSnapshot{frozenConfig(parseBuffer(contents)), ++loads});
+                return true;
+            }
+
+           /*!
+            *  \brief  Version of the published snapshot
+            */
+            uint64_t version() const
+            {
+                return read()->version;
+            }
+
+           /*!
+            *  \brief  Flag indicates whether the file was loaded at least once
+            *          (otherwise the published snapshot is empty)
+            */
+            bool loaded() const
+            {
+                return version() > 0;
+            }
+
+           /*!
+            *  \brief  Number of replaced snapshots which are not yet freed
+            */
+            size_t pendingSnapshots()
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                reclaim();
+                return retired.size();
+            }
+
+        private:
+
+            struct retiredSnapshot
+            {
+                const configSnapshot *snapshot;
+                uint64_t              epoch;    // Epoch in which it was replaced
+            };
+
+            // Publishes a new snapshot (writerMutex is held)
+            void publish(const configSnapshot *w_snapshot)
+            {
+                const configSnapshot *old = current.exchange(w_snapshot);
+
+                if(old != nullptr)
+                {
+                    retired.push_back({old, globalEpoch.fetch_add(1) + 1});
+                }
+
+                reclaim();
+            }
+
+            // Frees replaced snapshots which no reader can be using (writerMutex is held)
+            void reclaim()
+            {
+                uint64_t oldest = idle;
+
+                if(sharedReaders.load() > 0)
+                {
+                    return;
+                }
+
+                for(auto &slot : slots)
+                {
+                    oldest = std::min(oldest, slot.epoch.load());
+                }
+
+                // A reader that announced an epoch older than the one a snapshot
+                // was replaced in may still be using it
+                size_t kept = 0;
+
+                for(auto &r : retired)
+                {
+                    if(oldest >= r.epoch)
+                    {
+                        delete r.snapshot;
+                    }
+                    else
+                    {
+                        retired[kept++] = r;
+                    }
+                }
+
+                retired.resize(kept);
+            }
+
+            // Watches the file and reloads it when it changes
+            void watch()
+            {
+                const int interval = 100; // ms
+
+                #ifdef __linux__
+                size_t           slash     = fileName.rfind('/');
+                std::string      directory = slash == std::string::npos? "." : fileName.substr(0, slash + 1);
+                std::string_view baseName  = std::string_view(fileName).substr(slash == std::string::npos? 0 : slash + 1);
+
+                int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+                if(fd >= 0 && inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) >= 0)
+                {
+                    alignas(inotify_event) char events[4096];
+
+                    while(!stopping.load())
+                    {
+                        pollfd pfd = {fd, POLLIN, 0};
+
+                        if(poll(&pfd, 1, interval) <= 0)
+                        {
+                            std::lock_guard<std::mutex> lock(writerMutex);
+                            reclaim();
+                            continue;
+                        }
+
+                        bool    changed = false;
+                        ssize_t length;
+
+                        while((length = ::read(fd, events, sizeof(events))) > 0)
+                        {
+                            for(char *p = events; p < events + length; )
+                            {
+                                auto *event = reinterpret_cast<inotify_event*>(p);
+
+                                if(event->len > 0 && baseName == event->name)
+                                {
+                                    changed = true;
+                                }
+
+                                p += sizeof(inotify_event) + event->len;
+                            }
+                        }
+
+                        if(changed)
+                        {
+                            reload();
+                        }
+                    }
+
+                    ::close(fd);
+                    return;
+                }
+
+                if(fd >= 0)
+                {
+                    ::close(fd);
+                }
+                #endif
+
+                // Fall back to polling the modification time
+                auto modified = [this]()
+                {
+                    struct stat st;
+                    return stat(fileName.c_str(), &st) == 0? std::make_pair(st.st_mtime, st.st_size) : std::make_pair((time_t)0, (off_t)0);
+                };
+
+                auto last = modified();
+
+                while(!stopping.load())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+
+                    auto now = modified();
+
+                    if(now != last)
+                    {
+                        last = now;
+                        reload();
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock(writerMutex);
+                        reclaim();
+                    }
+                }
+            }
+
+            std::string                        fileName;
+            std::atomic<const configSnapshot*> current{nullptr};
+            mutable std::atomic<uint64_t>      globalEpoch{0};
+            mutable readerSlot                 slots[slotCount];
+            mutable std::atomic<size_t>        sharedReaders{0};
+            std::vector<retiredSnapshot>       retired;
+            std::mutex                         writerMutex;    // Serializes reloads
+            uint64_t                           loads = 0;
+            std::atomic<bool>                  stopping{false};
+            std::thread                        watcher;
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,298 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Vectorized scanning of structural characters
+ *
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define YCONFPARSER_HAS_SSE2
+#include <immintrin.h>
+#endif
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Instruction sets of the structural scanner
+        */
+        enum class scanLevel
+        {
+            SCALAR,
+            SSE2,
+            AVX2
+        };
+
+       /*!
+        *  \brief  Checks whether a character is structural, i.e. its position
+        *          is used by the parser: line ends, the colon separating a
+        *          parameter from its value and the commas separating array
+        *          elements.
+        *
+        *          Comments, quotes and brackets are recognized by the first or
+        *          last character of a trimmed token, so their positions are
+        *          not indexed.
+        */
+        static inline bool isStructural(char w_char)
+        {
+            return w_char == '\n' || w_char == ':' || w_char == ',';
+        }
+
+        namespace detail
+        {
+            static size_t scanScalar(const char *w_data, size_t w_size, uint32_t *w_out)
+            {
+                size_t n = 0;
+
+                for(size_t i=0; i<w_size; i++)
+                {
+                    if(isStructural(w_data[i]))
+                    {
+                        w_out[n++] = (uint32_t)i;
+                    }
+                }
+
+                return n;
+            }
+
+            #ifdef YCONFPARSER_HAS_SSE2
+            // Appends the positions of the bits set in w_mask
+            static inline size_t flattenMask(uint64_t w_mask, uint32_t w_base, uint32_t *w_out)
+            {
+                size_t n = 0;
+
+                while(w_mask != 0)
+                {
+                    w_out[n++] = w_base + (uint32_t)__builtin_ctzll(w_mask);
+                    w_mask &= w_mask - 1;
+                }
+
+                return n;
+            }
+
+            // Mask of the structural characters of 64 bytes
+            static inline uint64_t structuralMaskSSE2(const char *w_data)
+            {
+                const __m128i newline = _mm_set1_epi8('\n');
+                const __m128i colon   = _mm_set1_epi8(':');
+                const __m128i comma   = _mm_set1_epi8(',');
+
+                uint64_t mask = 0;
+
+                for(int k=0; k<4; k++)
+                {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w_data + 16 * k));
+                    __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, colon)),
+                                             _mm_cmpeq_epi8(v, comma));
+
+                    mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(m) << (16 * k);
+                }
+
+                return mask;
+            }
+
+            __attribute__((target("avx2")))
+            static inline uint64_t structuralMaskAVX2(const char *w_data)
+            {
+                const __m256i newline = _mm256_set1_epi8('\n');
+                const __m256i colon   = _mm256_set1_epi8(':');
+                const __m256i comma   = _mm256_set1_epi8(',');
+
+                __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w_data));
+                __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w_data + 32));
+
+                __m256i mlo = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(lo, newline), _mm256_cmpeq_epi8(lo, colon)),
+                                              _mm256_cmpeq_epi8(lo, comma));
+                __m256i mhi = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(hi, newline), _mm256_cmpeq_epi8(hi, colon)),
+                                              _mm256_cmpeq_epi8(hi, comma));
+
+                return (uint64_t)(uint32_t)_mm256_movemask_epi8(mlo) | ((uint64_t)(uint32_t)_mm256_movemask_epi8(mhi) << 32);
+            }
+
+            // Scans 64-byte blocks; the last partial block is copied into a
+            // zero-filled block, since zero is not structural
+            static size_t scanSSE2(const char *w_data, size_t w_size, uint32_t *w_out)
+            {
+                size_t n = 0;
+                size_t i = 0;
+
+                for(; i + 64 <= w_size; i += 64)
+                {
+                    n += flattenMask(structuralMaskSSE2(w_data + i), (uint32_t)i, w_out + n);
+                }
+
+                if(i < w_size)
+                {
+                    char tail[64] = {};
+                    memcpy(tail, w_data + i, w_size - i);
+                    n += flattenMask(structuralMaskSSE2(tail), (uint32_t)i, w_out + n);
+                }
+
+                return n;
+            }
+
+            // Same as scanSSE2 (the mask function has to be inlined into a
+            // function of the same target)
+            __attribute__((target("avx2")))
+            static size_t scanAVX2(const char *w_data, size_t w_size, uint32_t *w_out)
+            {
+                size_t n = 0;
+                size_t i = 0;
+
+                for(; i + 64 <= w_size; i += 64)
+                {
+                    n += flattenMask(structuralMaskAVX2(w_data + i), (uint32_t)i, w_out + n);
+                }
+
+                if(i < w_size)
+                {
+                    char tail[64] = {};
+                    memcpy(tail, w_data + i, w_size - i);
+                    n += flattenMask(structuralMaskAVX2(tail), (uint32_t)i, w_out + n);
+                }
+
+                return n;
+            }
+            #endif
+        }
+
+       /*!
+        *  \brief  Best instruction set supported by the CPU
+        */
+        static scanLevel supportedScanLevel()
+        {
+            #ifdef YCONFPARSER_HAS_SSE2
+            static const scanLevel level = __builtin_cpu_supports("avx2")? scanLevel::AVX2 : scanLevel::SSE2;
+            return level;
+            #else
+            return scanLevel::SCALAR;
+            #endif
+        }
+
+       /*!
+        *  \brief  Finds the positions of all structural characters (see
+        *          isStructural)
+        *
+        *  \param  w_data  Text
+        *  \param  w_size  Size of the text in bytes (less than 4 GiB)
+        *  \param  w_out   Positions in ascending order. Room for w_size
+        *                  positions is needed.
+        *  \param  w_level Instruction set to use. Levels not supported by the
+        *                  CPU fall back to the best supported one.
+        *  \return Number of positions
+        */
+        static size_t scanStructural(const char *w_data, size_t w_size, uint32_t *w_out,
+                                     scanLevel w_level = scanLevel::AVX2)
+        {
+            if(w_level > supportedScanLevel())
+            {
+                w_level = supportedScanLevel();
+            }
+
+            switch(w_level)
+            {
+                #ifdef YCONFPARSER_HAS_SSE2
+                case scanLevel::AVX2:
+                    return detail::scanAVX2(w_data, w_size, w_out);
+                case scanLevel::SSE2:
+                    return detail::scanSSE2(w_data, w_size, w_out);
+                #endif
+                default:
+                    return detail::scanScalar(w_data, w_size, w_out);
+            }
+        }
+
+       /*!
+        *  \brief Positions of the structural characters of a text (in the
+        *         spirit of the structural index of simdjson)
+        */
+        struct structuralIndex
+        {
+            std::vector<uint32_t> positions;
+            size_t                count = 0;
+            scanLevel             level = scanLevel::AVX2;  // Instruction set of build(w_text)
+
+           /*!
+            *  \brief  Indexes a text of less than 4 GiB. The capacity is kept
+            *          for the next text.
+            *
+            *  The text is scanned in segments, and the positions grow with the
+            *  number of structural characters found rather than with the size
+            *  of the text (e.g. of a single long line).
+            */
+            void build(std::string_view w_text)
+            {
+                build(w_text, level);
+            }
+
+            void build(std::string_view w_text, scanLevel w_level)
+            {
+                const size_t segmentSize = 16 * 1024;   // A multiple of the 64-byte scan blocks
+
+                count = 0;
+
+                for(size_t offset = 0; offset < w_text.size(); offset += segmentSize)
+                {
+                    size_t size = std::min(segmentSize, w_text.size() - offset);
+
+                    // Room for a whole segment of structural characters
+                    if(positions.size() < count + size)
+                    {
+                        positions.resize(std::max(count + size, 2 * positions.size()));
+                    }
+
+                    uint32_t *out   = positions.data() + count;
+                    size_t    found = scanStructural(w_text.data() + offset, size, out, w_level);
+
+                    for(size_t n=0; offset > 0 && n<found; n++)
+                    {
+                        out[n] += (uint32_t)offset;
+                    }
+
+                    count += found;
+                }
+            }
+
+            const uint32_t * begin() const
+            {
+                return positions.data();
+            }
+
+            const uint32_t * end() const
+            {
+                return positions.data() + count;
+            }
+        };
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
@@ -0,0 +1,476 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Typed configuration schemas bound into plain structs
+ *
+ */
+
+
+#pragma once
+
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+#include "YConfParser.hpp"
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief  Converts a configuration value into a C++ value.
+        *
+        *          Scalars (int, float, bool, std::string) require a single
+        *          value of the matching type; std::vector members take arrays
+        *          (and single values). Integers are accepted for float members,
+        *          and DOUBLE values are rounded for them. 64-bit and double
+        *          members take any number in their range (see bindNumbers).
+        *
+        *  \param  w_config Configuration value
+        *  \param  w_val    Converted value (if successful)
+        *  \return          Flag indicates success or failure (type mismatch)
+        */
+        static bool bindValue(const config_struct &w_config, int &w_val)
+        {
+            if(w_config.type != config_struct::type_::INTEGER || w_config.intVal.size() != 1)
+            {
+                return false;
+            }
+
+            w_val = w_config.intVal[0];
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, float &w_val)
+        {
+            if(w_config.type == config_struct::type_::INTEGER && w_config.intVal.size() == 1)
+            {
+                w_val = (float)w_config.intVal[0];
+                return true;
+            }
+
+            if(w_config.type == config_struct::type_::DOUBLE && w_config.doubleVal.size() == 1)
+            {
+                w_val = (float)w_config.doubleVal[0];
+                return true;
+            }
+
+            if(w_config.type != config_struct::type_::FLOAT || w_config.floatVal.size() != 1)
+            {
+                return false;
+            }
+
+            w_val = w_config.floatVal[0];
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, bool &w_val)
+        {
+            if(w_config.type != config_struct::type_::BOOLEAN || w_config.boolVal.size() != 1)
+            {
+                return false;
+            }
+
+            w_val = w_config.boolVal[0];
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, std::string &w_val)
+        {
+            if(w_config.type != config_struct::type_::STRING || w_config.stringVal.size() != 1)
+            {
+                return false;
+            }
+
+            w_val = w_config.stringVal[0];
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<int> &w_val)
+        {
+            if(w_config.type != config_struct::type_::INTEGER)
+            {
+                return false;
+            }
+
+            w_val = w_config.intVal;
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<float> &w_val)
+        {
+            if(w_config.type == config_struct::type_::INTEGER)
+            {
+                w_val.assign(w_config.intVal.begin(), w_config.intVal.end());
+                return true;
+            }
+
+            if(w_config.type == config_struct::type_::DOUBLE)
+            {
+                w_val.assign(w_config.doubleVal.begin(), w_config.doubleVal.end());
+                return true;
+            }
+
+            if(w_config.type != config_struct::type_::FLOAT)
+            {
+                return false;
+            }
+
+            w_val = w_config.floatVal;
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<bool> &w_val)
+        {
+            if(w_config.type != config_struct::type_::BOOLEAN)
+            {
+                return false;
+            }
+
+            w_val.assign(w_config.boolVal.begin(), w_config.boolVal.end());
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<std::string> &w_val)
+        {
+            if(w_config.type != config_struct::type_::STRING)
+            {
+                return false;
+            }
+
+            w_val = w_config.stringVal;
+            return true;
+        }
+
+       /*!
+        *  \brief  Converts the values of a number (of any numeric type) into
+        *          T (int64_t, uint64_t or double)
+        *
+        *          Integers convert to integer types whose range holds them.
+        *          Everything converts to double, where FLOAT values give the
+        *          double of their text (see widenFloat).
+        *
+        *  \param  w_config Configuration value
+        *  \param  w_val    Converted values (if successful)
+        *  \return          Flag indicates success or failure
+        */
+        template<typename T>
+        static bool bindNumbers(const config_struct &w_config, std::vector<T> &w_val)
+        {
+            auto convert = [&w_val](const auto &w_values)
+            {
+                typedef typename std::decay<decltype(w_values)>::type::value_type S;
+
+                std::vector<T> values;
+                values.reserve(w_values.size());
+
+                for(S v : w_values)
+                {
+                    if constexpr(std::is_floating_point<T>::value)
+                    {
+                        if constexpr(std::is_same<S, float>::value)
+                        {
+                            values.push_back(widenFloat(v));
+                        }
+                        else
+                        {
+                            values.push_back((T)v);
+                        }
+                    }
+                    else if constexpr(std::is_floating_point<S>::value)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        if(!integerInRange<T>(v))
+                        {
+                            return false;
+                        }
+
+                        values.push_back((T)v);
+                    }
+                }
+
+                w_val.swap(values);
+                return true;
+            };
+
+            switch(w_config.type)
+            {
+                case config_struct::type_::INTEGER: return convert(w_config.intVal);
+                case config_struct::type_::INT64:   return convert(w_config.int64Val);
+                case config_struct::type_::UINT64:  return convert(w_config.uint64Val);
+                case config_struct::type_::FLOAT:   return convert(w_config.floatVal);
+                case config_struct::type_::DOUBLE:  return convert(w_config.doubleVal);
+                default:                            return false;
+            }
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<int64_t> &w_val)
+        {
+            return bindNumbers(w_config, w_val);
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<uint64_t> &w_val)
+        {
+            return bindNumbers(w_config, w_val);
+        }
+
+        static bool bindValue(const config_struct &w_config, std::vector<double> &w_val)
+        {
+            return bindNumbers(w_config, w_val);
+        }
+
+        template<typename T>
+        static bool bindNumber(const config_struct &w_config, T &w_val)
+        {
+            std::vector<T> values;
+
+            if(!bindNumbers(w_config, values) || values.size() != 1)
+            {
+                return false;
+            }
+
+            w_val = values[0];
+            return true;
+        }
+
+        static bool bindValue(const config_struct &w_config, int64_t &w_val)
+        {
+            return bindNumber(w_config, w_val);
+        }
+
+        static bool bindValue(const config_struct &w_config, uint64_t &w_val)
+        {
+            return bindNumber(w_config, w_val);
+        }
+
+        static bool bindValue(const config_struct &w_config, double &w_val)
+        {
+            return bindNumber(w_config, w_val);
+        }
+
+       /*!
+        *  \brief  Name of a C++ type bound by bindValue (for messages)
+        */
+        static const char * bindTypeName(const int *)                      { return "integer"; }
+        static const char * bindTypeName(const float *)                    { return "float"; }
+        static const char * bindTypeName(const bool *)                     { return "boolean"; }
+        static const char * bindTypeName(const std::string *)              { return "string"; }
+        static const char * bindTypeName(const std::vector<int> *)         { return "integer array"; }
+        static const char * bindTypeName(const std::vector<float> *)       { return "float array"; }
+        static const char * bindTypeName(const std::vector<bool> *)        { return "boolean array"; }
+        static const char * bindTypeName(const std::vector<std::string> *) { return "string array"; }
+        static const char * bindTypeName(const int64_t *)                  { return "64-bit integer"; }
+        static const char * bindTypeName(const uint64_t *)                 { return "unsigned 64-bit integer"; }
+        static const char * bindTypeName(const double *)                   { return "double"; }
+        static const char * bindTypeName(const std::vector<int64_t> *)     { return "64-bit integer array"; }
+        static const char * bindTypeName(const std::vector<uint64_t> *)    { return "unsigned 64-bit integer array"; }
+        static const char * bindTypeName(const std::vector<double> *)      { return "double array"; }
+
+       /*!
+        *  \brief  Name of the type of a configuration value (for messages)
+        */
+        static const char * configTypeName(const config_struct &w_config)
+        {
+            size_t count = w_config.intVal.size() + w_config.floatVal.size() +
+                           w_config.boolVal.size() + w_config.stringVal.size() +
+                           w_config.int64Val.size() + w_config.uint64Val.size() + w_config.doubleVal.size();
+
+            switch(w_config.type)
+            {
+                case config_struct::type_::STRING:  return count > 1? "string array"  : "string";
+                case config_struct::type_::BOOLEAN: return count > 1? "boolean array" : "boolean";
+                case config_struct::type_::FLOAT:   return count > 1? "float array"   : "float";
+                case config_struct::type_::INTEGER: return count > 1? "integer array" : "integer";
+                case config_struct::type_::INT64:   return count > 1? "64-bit integer array" : "64-bit integer";
+                case config_struct::type_::UINT64:  return count > 1? "unsigned 64-bit integer array" : "unsigned 64-bit integer";
+                case config_struct::type_::DOUBLE:  return count > 1? "double array" : "double";
+                default:                            return "no value";
+            }
+        }
+
+       /*!
+        *  \brief A member of a struct bound to a configuration parameter
+        *
+        *  Use requiredField() and optionalField() to declare fields.
+        */
+        template<typename Struct, typename T>
+        struct schemaField
+        {
+            const char  *name;              // Full parameter name
+            T Struct::*  member;
+            T            defaultValue;
+            bool         required;
+        };
+
+       /*!
+        *  \brief  Declares a field which has to be present in the configuration
+        *
+        *  \param  w_name   Full parameter name
+        *  \param  w_member Struct member (int, float, bool, std::string,
+        *                   int64_t, uint64_t, double or a std::vector of these)
+        */
+        template<typename Struct, typename T>
+        schemaField<Struct, T> requiredField(const char *w_name, T Struct::*w_member)
+        {
+            return schemaField<Struct, T>{w_name, w_member, T(), true};
+        }
+
+       /*!
+        *  \brief  Declares a field which takes a default value if it is not
+        *          present in the configuration
+        *
+        *  \param  w_name         Full parameter name
+        *  \param  w_member       Struct member
+        *  \param  w_defaultValue Value if the parameter does not exist
+        */
+        template<typename Struct, typename T>
+        schemaField<Struct, T> optionalField(const char *w_name, T Struct::*w_member,
+                                             const typename std::common_type<T>::type &w_defaultValue)
+        {
+            return schemaField<Struct, T>{w_name, w_member, w_defaultValue, false};
+        }
+
+       /*!
+        *  \brief Schema binding a configuration list into a plain struct.
+        *
+        *  The schema is a list of fields, each a parameter name, a struct
+        *  member and (for optional fields) a default value:
+        *
+        *      struct serverConfig { int port; float timeout; std::vector<std::string> hosts; };
+        *
+        *      static const auto serverSchema = makeSchema(
+        *          requiredField("server.port",    &serverConfig::port),
+        *          optionalField("server.timeout", &serverConfig::timeout, 1.5f),
+        *          optionalField("server.hosts",   &serverConfig::hosts, {"localhost"}));
+        *
+        *  bind() looks every field up once and converts its value, so reads of
+        *  the struct afterwards are plain member loads. Missing required
+        *  fields and type mismatches are reported (once, through parseMessage)
+        *  while binding.
+        */
+        template<typename Struct, typename... Fields>
+        class configSchema
+        {
+        public:
+            explicit configSchema(Fields... w_fields) : fields(w_fields...)
+            {
+            }
+
+           /*!
+            *  \brief  Binds a configuration list into a struct
+            *
+            *  Every member of the schema is assigned: optional fields whose
+            *  parameter is missing or mismatching get their default value,
+            *  required fields with errors are left unchanged.
+            *
+            *  \param  w_config Configuration list
+            *  \param  w_struct Struct to be filled
+            *  \return Flag indicates success or failure (any field missing or
+            *          mismatching)
+            */
+            bool bind(const configList &w_config, Struct &w_struct) const
+            {
+                size_t errors = 0;
+
+                std::apply([&](const Fields&... w_field) {
+                    (void)((errors += (bindField(w_config, w_field, w_struct)? 0 : 1)), ...);
+                }, fields);
+
+                return errors == 0;
+            }
+
+           /*!
+            *  \brief  Binds a configuration list into a new struct
+            *
+            *  \param  w_config Configuration list
+            *  \param  w_valid  Flag indicates success or failure
+            *  \return Struct, value-initialized before binding
+            */
+            Struct bind(const configList &w_config, bool &w_valid) const
+            {
+                Struct s{};
+                w_valid = bind(w_config, s);
+                return s;
+            }
+
+            static constexpr size_t size()
+            {
+                return sizeof...(Fields);
+            }
+
+        private:
+
+            template<typename T>
+            static bool bindField(const configList &w_config, const schemaField<Struct, T> &w_field, Struct &w_struct)
+            {
+                T &member = w_struct.*(w_field.member);
+                auto it   = w_config.find(w_field.name);
+
+                if(it == w_config.end())
+                {
+                    if(w_field.required)
+                    {
+                        parseMessage(parseDiagnostic::ERROR, parseDiagnostic::MISSING_FIELD, nullptr,
+                                     "%s: missing required parameter\n", w_field.name);
+                        return false;
+                    }
+
+                    member = w_field.defaultValue;
+                    return true;
+                }
+
+                if(!bindValue(it->second, member))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FIELD_TYPE, nullptr,
+                                 "%s: expected %s, found %s\n", w_field.name,
+                                 bindTypeName(&member), configTypeName(it->second));
+
+                    if(!w_field.required)
+                    {
+                        member = w_field.defaultValue;
+                    }
+
+                    return false;
+                }
+
+                return true;
+            }
+
+            std::tuple<Fields...> fields;
+        };
+
+       /*!
+        *  \brief  Creates a schema from a list of fields of the same struct
+        */
+        template<typename Struct, typename... T>
+        configSchema<Struct, schemaField<Struct, T>...> makeSchema(schemaField<Struct, T>... w_fields)
+        {
+            return configSchema<Struct, schemaField<Struct, T>...>(w_fields...);
+        }
+
+    } // namespace yconfparser
+
+} // namespace ylibs
+
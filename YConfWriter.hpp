@@ -0,0 +1,626 @@
+/*
+ *  Copyright 2018 Yihenew Beyene
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ */
+
+
+/*!
+ *  \brief Writing of configuration lists as configuration text
+ *
+ */
+
+
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include "YConfParser.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace ylibs
+{
+    namespace yconfparser
+    {
+
+       /*!
+        *  \brief Writes configuration lists as hierarchical configuration text,
+        *         which parses back to the same parameters and values.
+        *
+        *  Parameters are written in the order of their names, and the parts
+        *  of a name separated by '.' become nested sections:
+        *
+        *      a.b: 1          a:
+        *      a.c: 2    =>        b: 1
+        *                          c: 2
+        *
+        *  Text goes to a file descriptor, in blocks of bufferSize bytes (one
+        *  write() per block), to a buffer provided by the caller or to the end
+        *  of a string. Numbers are formatted with std::to_chars, in the
+        *  shortest form which reads back to the same value, and nothing is
+        *  allocated per parameter (the writer keeps its work space between
+        *  calls of write()). UINT64 values are written in hexadecimal. INT64
+        *  and DOUBLE values which int and float keep read back as INTEGER and
+        *  FLOAT (which the parser never gives for them).
+        *
+        *  Values which have no text form are skipped and reported: strings
+        *  which are empty or hold a line break, strings of arrays which hold a
+        *  comma, floating-point values which are not finite, and names which
+        *  hold ':' or a line break (or which would be read as a comment or
+        *  lose white spaces).
+        */
+        class configWriter
+        {
+        public:
+            static constexpr size_t bufferSize = 64 * 1024;
+
+           /*!
+            *  \brief Writes to a file descriptor (which is not closed)
+            *
+            *  \param w_fd     File descriptor
+            *  \param w_indent Number of white spaces per section level
+            */
+            explicit configWriter(int w_fd, size_t w_indent = 4) :
+                fd(w_fd), indent(w_indent), block(new char[bufferSize])
+            {
+                begin = cur = block.get();
+                end   = begin + bufferSize;
+            }
+
+           /*!
+            *  \brief Writes into a buffer of the caller. Text which does not
+            *         fit is counted by length() but not written.
+            *
+            *  \param w_buffer Buffer
+            *  \param w_size   Size of the buffer in bytes
+            *  \param w_indent Number of white spaces per section level
+            */
+            configWriter(char *w_buffer, size_t w_size, size_t w_indent = 4) :
+                indent(w_indent), begin(w_buffer), cur(w_buffer), end(w_buffer + w_size)
+            {
+            }
+
+           /*!
+            *  \brief Appends to a string
+            *
+            *  \param w_text   String
+            *  \param w_indent Number of white spaces per section level
+            */
+            explicit configWriter(std::string &w_text, size_t w_indent = 4) :
+                text(&w_text), indent(w_indent)
+            {
+                begin = cur = end = &w_text[0] + w_text.size();
+                textSize = w_text.size();
+            }
+
+            configWriter(const configWriter&) = delete;
+            configWriter& operator=(const configWriter&) = delete;
+
+            ~configWriter()
+            {
+                flush();
+            }
+
+           /*!
+            *  \brief  Writes a configuration list
+            *
+            *  \param  w_config Configuration list
+            *  \return Flag indicates whether every parameter was written
+            *          (see failed() and overflow() for the output itself)
+            */
+            bool write(const configList &w_config)
+            {
+                bool complete = true;
+
+                order.clear();
+
+                for(auto &c : w_config)
+                {
+                    order.push_back({c.first, &c.second});
+                }
+
+                // A std::map is in order already
+                #ifndef USE_ORDERED_MAP
+                std::sort(order.begin(), order.end(), [](const param &w_a, const param &w_b)
+                {
+                    return w_a.first < w_b.first;
+                });
+                #endif
+
+                open.clear();
+
+                for(auto &c : order)
+                {
+                    complete &= writeParam(c.first, *c.second);
+                }
+
+                return complete;
+            }
+
+           /*!
+            *  \brief  Writes buffered text to the file descriptor, or sets the
+            *          length of the string
+            *
+            *  \return Flag indicates success or failure
+            */
+            bool flush()
+            {
+                if(text != nullptr)
+                {
+                    textSize += (size_t)(cur - begin);
+                    text->resize(textSize);
+                    begin = cur = end = &(*text)[0] + textSize;
+                }
+                else if(fd >= 0)
+                {
+                    writeAll(begin, (size_t)(cur - begin));
+                    cur = begin;
+                }
+
+                return !failed();
+            }
+
+           /*!
+            *  \brief  Number of bytes of text written so far (including text
+            *          which did not fit in the buffer of the caller)
+            */
+            size_t length() const
+            {
+                return total;
+            }
+
+           /*!
+            *  \brief  Flag indicates whether the buffer of the caller was too
+            *          small
+            */
+            bool overflow() const
+            {
+                return overflowed;
+            }
+
+           /*!
+            *  \brief  Flag indicates whether writing to the file descriptor
+            *          failed
+            */
+            bool failed() const
+            {
+                return writeError != 0;
+            }
+
+        private:
+
+            // Part of a name which can be written as a name of its own
+            static bool validSection(std::string_view w_section)
+            {
+                return !w_section.empty() && w_section[0] != ' ' && w_section[0] != '\t' &&
+                       w_section[0] != '#' && w_section.back() != ' ';
+            }
+
+            // Splits a full name into sections (see validSection); parts which
+            // are not valid on their own stay joined with their neighbours
+            bool splitName(std::string_view w_name)
+            {
+                if(w_name.find_first_of(":\n") != std::string_view::npos)
+                {
+                    return false;
+                }
+
+                sections.clear();
+
+                size_t first = 0;   // Start of the current section
+                size_t pos   = 0;
+
+                while(true)
+                {
+                    size_t           dot     = w_name.find('.', pos);
+                    std::string_view current = w_name.substr(first, dot == std::string_view::npos? dot : dot - first);
+
+                    if(dot == std::string_view::npos)
+                    {
+                        sections.push_back(current);
+                        break;
+                    }
+
+                    size_t           next = w_name.find('.', dot + 1);
+                    std::string_view part = w_name.substr(dot + 1, next == std::string_view::npos? next : next - dot - 1);
+
+                    if(validSection(current) && validSection(part))
+                    {
+                        sections.push_back(current);
+                        first = dot + 1;
+                    }
+
+                    pos = dot + 1;
+                }
+
+                for(auto &s : sections)
+                {
+                    if(!validSection(s))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            template<typename T>
+            static bool validValues(const std::vector<T> &w_values)
+            {
+                if constexpr(std::is_floating_point<T>::value)
+                {
+                    for(T v : w_values)
+                    {
+                        if(!std::isfinite(v))
+                        {
+                            return false;
+                        }
+                    }
+                }
+
+                return true;
+            }
+
+            static bool validValues(const std::vector<std::string> &w_values)
+            {
+                for(auto &v : w_values)
+                {
+                    if(v.empty() || v.find('\n') != std::string::npos ||
+                       (w_values.size() > 1 && v.find(',') != std::string::npos))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Flag indicates whether the value has elements which can be written
+            static bool validValue(const config_struct &w_value, bool &w_empty)
+            {
+                switch(w_value.type)
+                {
+                    case config_struct::type_::STRING:
+                        w_empty = w_value.stringVal.empty();
+                        return validValues(w_value.stringVal);
+                    case config_struct::type_::BOOLEAN:
+                        w_empty = w_value.boolVal.empty();
+                        return true;
+                    case config_struct::type_::FLOAT:
+                        w_empty = w_value.floatVal.empty();
+                        return validValues(w_value.floatVal);
+                    case config_struct::type_::INTEGER:
+                        w_empty = w_value.intVal.empty();
+                        return true;
+                    case config_struct::type_::INT64:
+                        w_empty = w_value.int64Val.empty();
+                        return true;
+                    case config_struct::type_::UINT64:
+                        w_empty = w_value.uint64Val.empty();
+                        return true;
+                    case config_struct::type_::DOUBLE:
+                        w_empty = w_value.doubleVal.empty();
+                        return validValues(w_value.doubleVal);
+                    default:
+                        w_empty = true;
+                        return true;
+                }
+            }
+
+            bool writeParam(std::string_view w_name, const config_struct &w_value)
+            {
+                bool empty;
+
+                if(!validValue(w_value, empty) || !splitName(w_name))
+                {
+                    parseMessage(parseDiagnostic::ERROR, parseDiagnostic::UNWRITABLE_PARAM, nullptr,
+                                 "parameter can not be written as text: %.*s\n", (int)w_name.size(), w_name.data());
+                    return false;
+                }
+
+                if(empty)
+                {
+                    return true;    // No value (as parameters without a value string)
+                }
+
+                // Sections shared with the previous parameter are open already
+                size_t shared = 0;
+
+                while(shared < open.size() && shared + 1 < sections.size() && open[shared] == sections[shared])
+                {
+                    shared++;
+                }
+
+                open.resize(shared);
+
+                for(size_t n=shared; n<sections.size(); n++)
+                {
+                    putIndent(n);
+                    put(sections[n]);
+                    put(':');
+                    open.push_back(sections[n]);
+
+                    if(n + 1 < sections.size())
+                    {
+                        put('\n');
+                    }
+                }
+
+                put(' ');
+                putValue(w_value);
+                put('\n');
+                return true;
+            }
+
+            void putValue(const config_struct &w_value)
+            {
+                switch(w_value.type)
+                {
+                    case config_struct::type_::STRING:  putElements(w_value.stringVal); break;
+                    case config_struct::type_::BOOLEAN: putElements(w_value.boolVal);   break;
+                    case config_struct::type_::FLOAT:   putElements(w_value.floatVal);  break;
+                    case config_struct::type_::INT64:   putElements(w_value.int64Val);  break;
+                    case config_struct::type_::UINT64:  putElements(w_value.uint64Val); break;
+                    case config_struct::type_::DOUBLE:  putElements(w_value.doubleVal); break;
+                    default:                            putElements(w_value.intVal);    break;
+                }
+            }
+
+            template<typename T>
+            void putElements(const std::vector<T> &w_values)
+            {
+                if(w_values.size() == 1)
+                {
+                    putElement(w_values[0]);
+                    return;
+                }
+
+                put('[');
+
+                for(size_t n=0; n<w_values.size(); n++)
+                {
+                    if(n > 0)
+                    {
+                        put(", ", 2);
+                    }
+
+                    putElement(w_values[n]);
+                }
+
+                put(']');
+            }
+
+            void putElement(const std::string &w_value)
+            {
+                put('"');
+                put(w_value);
+                put('"');
+            }
+
+            void putElement(uint8_t w_value)
+            {
+                w_value? put("TRUE", 4) : put("FALSE", 5);
+            }
+
+            void putElement(int w_value)
+            {
+                char number[16];
+                put(number, (size_t)(std::to_chars(number, number + sizeof(number), w_value).ptr - number));
+            }
+
+            void putElement(int64_t w_value)
+            {
+                char number[24];
+                put(number, (size_t)(std::to_chars(number, number + sizeof(number), w_value).ptr - number));
+            }
+
+            // In hexadecimal, which reads back as UINT64 whatever the value
+            void putElement(uint64_t w_value)
+            {
+                char number[24] = {'0', 'x'};
+                put(number, (size_t)(std::to_chars(number + 2, number + sizeof(number), w_value, 16).ptr - number));
+            }
+
+            template<typename T>
+            void putElement(T w_value)
+            {
+                static_assert(std::is_floating_point<T>::value, "float or double expected");
+
+                char  number[32];
+                char *last = std::to_chars(number, number + sizeof(number) - 2, w_value, std::chars_format::general).ptr;
+
+                // A floating-point value is told from an integer by its '.'
+                if(std::find(number, last, '.') == last)
+                {
+                    char *exponent = std::find(number, last, 'e');
+
+                    memmove(exponent + 2, exponent, (size_t)(last - exponent));
+                    exponent[0] = '.';
+                    exponent[1] = '0';
+                    last += 2;
+                }
+
+                put(number, (size_t)(last - number));
+            }
+
+            void putIndent(size_t w_level)
+            {
+                static const char spaces[] = "                                ";
+
+                for(size_t n = w_level * indent; n > 0; )
+                {
+                    size_t count = std::min(n, sizeof(spaces) - 1);
+
+                    put(spaces, count);
+                    n -= count;
+                }
+            }
+
+            void put(char w_char)
+            {
+                put(&w_char, 1);
+            }
+
+            void put(std::string_view w_text)
+            {
+                put(w_text.data(), w_text.size());
+            }
+
+            void put(const char *w_data, size_t w_size)
+            {
+                total += w_size;
+
+                if((size_t)(end - cur) >= w_size)
+                {
+                    memcpy(cur, w_data, w_size);
+                    cur += w_size;
+                }
+                else
+                {
+                    spill(w_data, w_size);
+                }
+            }
+
+            // Output which does not fit in the rest of the buffer
+            void spill(const char *w_data, size_t w_size)
+            {
+                if(text != nullptr)
+                {
+                    // Grow the string; its size is set by flush()
+                    size_t used = textSize + (size_t)(cur - begin);
+
+                    text->resize(std::max(2 * used, used + w_size + 4096));
+                    begin = &(*text)[0] + textSize;
+                    cur   = &(*text)[0] + used;
+                    end   = &(*text)[0] + text->size();
+
+                    memcpy(cur, w_data, w_size);
+                    cur += w_size;
+                }
+                else if(fd >= 0)
+                {
+                    writeAll(begin, (size_t)(cur - begin));
+                    cur = begin;
+
+                    if(w_size >= bufferSize)
+                    {
+                        writeAll(w_data, w_size);
+                    }
+                    else
+                    {
+                        memcpy(cur, w_data, w_size);
+                        cur += w_size;
+                    }
+                }
+                else
+                {
+                    memcpy(cur, w_data, (size_t)(end - cur));
+                    cur        = end;
+                    overflowed = true;
+                }
+            }
+
+            void writeAll(const char *w_data, size_t w_size)
+            {
+                while(w_size > 0 && writeError == 0)
+                {
+                    ssize_t n = ::write(fd, w_data, w_size);
+
+                    if(n < 0 && errno != EINTR)
+                    {
+                        writeError = errno;
+                        parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_WRITE, nullptr,
+                                     "error while writing configuration: %s\n", strerror(errno));
+                    }
+                    else if(n > 0)
+                    {
+                        w_data += n;
+                        w_size -= (size_t)n;
+                    }
+                }
+            }
+
+            int                         fd         = -1;
+            std::string                *text       = nullptr;
+            size_t                      textSize   = 0;      // Size of *text before the current block
+            size_t                      indent;
+            std::unique_ptr<char[]>     block;
+            char                       *begin      = nullptr;
+            char                       *cur        = nullptr;
+            char                       *end        = nullptr;
+            size_t                      total      = 0;
+            bool                        overflowed = false;
+            int                         writeError = 0;
+
+            typedef std::pair<std::string_view, const config_struct*> param;
+
+            std::vector<param>              order;      // Parameters in the order of their names
+            std::vector<std::string_view>   open;       // Sections of the last parameter
+            std::vector<std::string_view>   sections;
+        };
+
+       /*!
+        *  \brief  Appends a configuration list as configuration text to a
+        *          string
+        *
+        *  \param  w_config Configuration list
+        *  \param  w_text   String
+        *  \return Flag indicates whether every parameter was written
+        */
+        static bool writeConfiguration(const configList &w_config, std::string &w_text)
+        {
+            configWriter writer(w_text);
+            return writer.write(w_config);
+        }
+
+       /*!
+        *  \brief  Writes a configuration list to a configuration file
+        *
+        *  \param  w_config   Configuration list
+        *  \param  w_fileName Configuration file name
+        *  \return Flag indicates whether every parameter was written
+        */
+        static bool writeConfigurationFile(const configList &w_config, const std::string &w_fileName)
+        {
+            int fd = ::open(w_fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+            if(fd < 0)
+            {
+                parseMessage(parseDiagnostic::ERROR, parseDiagnostic::FILE_OPEN, nullptr,
+                             "error while opening file %s\n", w_fileName.c_str());
+                return false;
+            }
+
+            bool complete;
+            bool written;
+
+            {
+                configWriter writer(fd);
+                complete = writer.write(w_config);
+                written  = writer.flush();
+            }
+
+            return (::close(fd) == 0) && complete && written;
+        }
+
+    } // namespace yconfparser
+
+} // namespace ylibs
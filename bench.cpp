@@ -0,0 +1,1205 @@
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "YConfParser.hpp"
+#include "YConfArena.hpp"
+#include "YConfBinary.hpp"
+#include "YConfCompact.hpp"
+#include "YConfFrozen.hpp"
+#include "YConfLayers.hpp"
+#include "YConfLazy.hpp"
+#include "YConfParallel.hpp"
+#include "YConfRegistry.hpp"
+#include "YConfWriter.hpp"
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace ylibs::yconfparser;
+
+
+// Heap usage counters (maintained by the global operator new / delete below)
+static size_t allocCount = 0;
+static size_t liveBytes  = 0;
+
+void* operator new(size_t w_size)
+{
+    // The size is kept in front of the block for operator delete
+    void *ptr = malloc(w_size + alignof(std::max_align_t));
+
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    *static_cast<size_t*>(ptr) = w_size;
+    allocCount++;
+    liveBytes += w_size;
+    return static_cast<char*>(ptr) + alignof(std::max_align_t);
+}
+
+// GCC cannot tell that the block in front of w_ptr comes from malloc()
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+// Releases a block allocated by operator new
+static void release(void *w_ptr)
+{
+    if(w_ptr != nullptr)
+    {
+        char *ptr = static_cast<char*>(w_ptr) - alignof(std::max_align_t);
+        liveBytes -= *reinterpret_cast<size_t*>(ptr);
+        free(ptr);
+    }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete(void *w_ptr) noexcept
+{
+    release(w_ptr);
+}
+
+void operator delete(void *w_ptr, size_t) noexcept
+{
+    release(w_ptr);
+}
+
+
+// Prints a single measurement
+static void report(const std::string &w_name, double w_value, const char *w_unit)
+{
+    std::cout << w_name << "\t" << w_value << "\t" << w_unit << std::endl;
+}
+
+// Seconds elapsed since w_start
+static double secondsSince(std::chrono::steady_clock::time_point w_start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - w_start).count();
+}
+
+// Parses a configuration made up of arrays (calibration tables) with
+// w_elements numbers each
+static void benchArrays(size_t w_elements, bool w_float)
+{
+    const size_t keys = 100;
+    std::string  text;
+
+    for(size_t k=0; k<keys; k++)
+    {
+        text += "table" + std::to_string(k) + ": [";
+
+        for(size_t n=0; n<w_elements; n++)
+        {
+            text += (n>0? ", " : "");
+            text += w_float? std::to_string(n) + ".125" : std::to_string(n);
+        }
+
+        text += "]\n";
+    }
+
+    size_t repeat = 1 + 1000000 / (keys * w_elements);
+    size_t values = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t r=0; r<repeat; r++)
+    {
+        configList config = parseBuffer(text);
+        values += config.size();
+    }
+
+    double seconds = secondsSince(start);
+    std::string name = std::string("arrays/") + (w_float? "float/" : "int/") + std::to_string(w_elements);
+
+    report(name, 1e9 * seconds / (repeat * keys * w_elements), "ns/element");
+
+    if(values != repeat * keys)
+    {
+        std::cerr << name << ": unexpected number of entries" << std::endl;
+    }
+}
+
+// A configuration with w_keys parameters of mixed types, grouped in
+// sections of 100 parameters
+static std::string mixedConfig(size_t w_keys)
+{
+    std::string text;
+
+    for(size_t k=0; k<w_keys; k++)
+    {
+        if(k % 100 == 0)
+        {
+            text += "section" + std::to_string(k / 100) + ":\n";
+        }
+
+        text += "    param" + std::to_string(k % 100) + ": ";
+
+        switch(k % 5)
+        {
+            case 0:  text += std::to_string(k); break;
+            case 1:  text += std::to_string(k) + ".5"; break;
+            case 2:  text += "\"value " + std::to_string(k) + "\""; break;
+            case 3:  text += (k % 2? "TRUE" : "FALSE"); break;
+            default: text += "[1, 2, 3, 4]"; break;
+        }
+
+        text += "\n";
+    }
+
+    return text;
+}
+
+// Heap bytes per entry of configList, compactConfig and arenaConfig
+static void benchMemory(size_t w_keys)
+{
+    std::string text = mixedConfig(w_keys);
+
+    size_t before      = liveBytes;
+    size_t allocBefore = allocCount;
+    configList config  = parseBuffer(text);
+    size_t listBytes   = liveBytes - before;
+    size_t listAllocs  = allocCount - allocBefore;
+
+    before      = liveBytes;
+    allocBefore = allocCount;
+    compactConfig compact(config);
+    size_t compactBytes  = liveBytes - before;
+    size_t compactAllocs = allocCount - allocBefore;
+
+    report("memory/configList", (double)listBytes / config.size(), "bytes/entry");
+    report("memory/configList/allocations", (double)listAllocs / config.size(), "allocs/entry");
+    report("memory/compactConfig", (double)compactBytes / compact.size(), "bytes/entry");
+    report("memory/compactConfig/allocations", (double)compactAllocs / compact.size(), "allocs/entry");
+    before      = liveBytes;
+    allocBefore = allocCount;
+    arenaConfig arena = parseBufferToArena(text);
+    size_t arenaBytes  = liveBytes - before;
+    size_t arenaAllocs = allocCount - allocBefore;
+
+    report("memory/arenaConfig", (double)arenaBytes / arena.size(), "bytes/entry");
+    report("memory/arenaConfig/allocations", (double)arenaAllocs / arena.size(), "allocs/entry");
+    report("memory/compactConfig/arena", (double)compact.arenaSize() / compact.size(), "bytes/entry");
+}
+
+// Average lookup time of all keys (in random order) through w_find
+template<typename Find>
+static void benchLookup(const std::string &w_name, const std::vector<std::string> &w_keys, Find w_find)
+{
+    const size_t rounds = 20;
+    size_t       found  = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t r=0; r<rounds; r++)
+    {
+        for(auto &key : w_keys)
+        {
+            found += w_find(key);
+        }
+    }
+
+    report(w_name, 1e9 * secondsSince(start) / (rounds * w_keys.size()), "ns/lookup");
+
+    if(found != rounds * w_keys.size())
+    {
+        std::cerr << w_name << ": missing keys" << std::endl;
+    }
+}
+
+// Lookup latency of std::map, std::unordered_map, frozenConfig and paramHandle
+static void benchLookups(size_t w_keys)
+{
+    configList config = parseBuffer(mixedConfig(w_keys));
+
+    std::vector<std::string> keys;
+
+    for(auto &c : config)
+    {
+        keys.push_back(c.first);
+    }
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    std::map<std::string, config_struct>           ordered(config.begin(), config.end());
+    std::unordered_map<std::string, config_struct> unordered(config.begin(), config.end());
+    frozenConfig                                   frozen(config);
+
+    std::string suffix = "/" + std::to_string(w_keys);
+
+    benchLookup("lookup/std::map" + suffix, keys, [&](const std::string &k) { return ordered.count(k); });
+    benchLookup("lookup/std::unordered_map" + suffix, keys, [&](const std::string &k) { return unordered.count(k); });
+    benchLookup("lookup/frozenConfig" + suffix, keys, [&](std::string_view k) { return frozen.count(k); });
+
+    // Handles resolved once, in the same (random) order as the keys
+    std::vector<paramHandle> handles;
+
+    for(auto &key : keys)
+    {
+        handles.push_back(frozen.resolve(key));
+    }
+
+    const size_t rounds = 20;
+    size_t       found  = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t r=0; r<rounds; r++)
+    {
+        for(auto handle : handles)
+        {
+            found += frozen.value(handle).type != config_struct::type_::NO_VAL;
+        }
+    }
+
+    report("lookup/paramHandle" + suffix, 1e9 * secondsSince(start) / (rounds * handles.size()), "ns/lookup");
+
+    if(found != rounds * handles.size())
+    {
+        std::cerr << "lookup/paramHandle: missing keys" << std::endl;
+    }
+
+    start = std::chrono::steady_clock::now();
+    frozenConfig rebuilt(config);
+    report("freeze" + suffix, 1e3 * secondsSince(start), "ms");
+}
+
+// Throughput of parseBuffer and parseBufferParallel with 1 to N threads
+static void benchParallel(size_t w_keys)
+{
+    std::string text = mixedConfig(w_keys);
+    double      mb   = text.size() / 1e6;
+
+    auto start = std::chrono::steady_clock::now();
+    configList reference = parseBuffer(text);
+    report("parallel/sequential", mb / secondsSince(start), "MB/s");
+
+    unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        start = std::chrono::steady_clock::now();
+        configList config = parseBufferParallel(text, threads);
+        report("parallel/threads/" + std::to_string(threads), mb / secondsSince(start), "MB/s");
+
+        if(config != reference)
+        {
+            std::cerr << "parallel: result differs from parseBuffer" << std::endl;
+        }
+    }
+}
+
+// Loading a base file of w_keys parameters and w_layers-1 files overriding 1%
+// of them: parseFile of every file merged by hand (copying every value) and
+// layeredConfig (moving the values)
+static void benchLayers(size_t w_keys, size_t w_layers)
+{
+    std::vector<std::string> names;
+    std::string              suffix = "/" + std::to_string(w_layers) + "x" + std::to_string(w_keys);
+
+    for(size_t l=0; l<w_layers; l++)
+    {
+        names.push_back("bench-layer" + std::to_string(l) + ".tmp");
+        std::ofstream(names.back()) << mixedConfig(l == 0? w_keys : w_keys / 100);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    configList merged;
+
+    for(auto &name : names)
+    {
+        for(auto &c : parseFile(name))
+        {
+            merged[c.first] = c.second;
+        }
+    }
+
+    report("layers/parseFile+copy" + suffix, 1e3 * secondsSince(start), "ms");
+
+    start = std::chrono::steady_clock::now();
+    layeredConfig layered;
+    layered.load(names);
+    report("layers/layeredConfig" + suffix, 1e3 * secondsSince(start), "ms");
+
+    if(layered.size() != merged.size())
+    {
+        std::cerr << "layers: result differs from parseFile" << std::endl;
+    }
+
+    for(auto &name : names)
+    {
+        remove(name.c_str());
+    }
+}
+
+// Loading a configuration file from text (parseFile) and from a binary image
+static void benchBinary(size_t w_keys)
+{
+    const std::string textName  = "bench-binary.txt";
+    const std::string imageName = "bench-binary.bin";
+
+    {
+        std::ofstream file(textName, std::ios::binary);
+        file << mixedConfig(w_keys);
+    }
+
+    std::string suffix = "/" + std::to_string(w_keys);
+
+    auto start = std::chrono::steady_clock::now();
+    configList config = parseFile(textName);
+    report("binary/parseFile" + suffix, 1e3 * secondsSince(start), "ms");
+
+    start = std::chrono::steady_clock::now();
+    writeBinary(config, imageName);
+    report("binary/compile" + suffix, 1e3 * secondsSince(start), "ms");
+
+    binaryConfig binary;
+    size_t       allocBefore = allocCount;
+
+    start = std::chrono::steady_clock::now();
+    bool   loaded     = binary.open(imageName);
+    double seconds    = secondsSince(start);
+    size_t loadAllocs = allocCount - allocBefore;
+
+    report("binary/load" + suffix, 1e3 * seconds, "ms");
+    report("binary/load/allocations" + suffix, loadAllocs, "allocs");
+
+    if(!loaded || binary.list() != config)
+    {
+        std::cerr << "binary: image differs from parseFile" << std::endl;
+    }
+
+    std::vector<std::string> keys;
+
+    for(auto &c : config)
+    {
+        keys.push_back(c.first);
+    }
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    benchLookup("lookup/binaryConfig" + suffix, keys, [&](std::string_view k) { return binary.find(k) != nullptr; });
+
+    binary.clear();
+    std::remove(textName.c_str());
+    std::remove(imageName.c_str());
+}
+
+// Throughput of the structural scanner at every supported instruction set,
+// and of parsing with and without the structural index
+static void benchScan(size_t w_keys)
+{
+    std::string text = mixedConfig(w_keys);
+    double      gb   = text.size() / 1e9;
+
+    std::vector<uint32_t> positions(text.size());
+    const char           *levels[] = {"scalar", "sse2", "avx2"};
+    const size_t          rounds   = 10;
+
+    for(int level = 0; level <= (int)supportedScanLevel(); level++)
+    {
+        size_t found = 0;
+        auto   start = std::chrono::steady_clock::now();
+
+        for(size_t r=0; r<rounds; r++)
+        {
+            found += scanStructural(text.data(), text.size(), positions.data(), (scanLevel)level);
+        }
+
+        report(std::string("scan/") + levels[level], rounds * gb / secondsSince(start), "GB/s");
+
+        if(found != rounds * std::count_if(text.begin(), text.end(), isStructural))
+        {
+            std::cerr << "scan: wrong number of structural characters" << std::endl;
+        }
+    }
+
+    // Events only (no list is built), line by line searching every line end
+    // and colon, and with the structural index
+    parseHandler  handler;
+    paramPath     path;
+    config_struct value;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(std::string_view lines = text; !lines.empty(); )
+    {
+        size_t n = lines.find('\n');
+        parseLineEvents(lines.substr(0, n), path, value, handler);
+        lines.remove_prefix(n == std::string_view::npos? lines.size() : n + 1);
+    }
+
+    report("scan/events/lines", 1e3 * gb / secondsSince(start), "MB/s");
+
+    start = std::chrono::steady_clock::now();
+    parseBufferEvents(text, handler);
+    report("scan/events/indexed", 1e3 * gb / secondsSince(start), "MB/s");
+
+    // Complete parse
+    configList        reference;
+    configListBuilder builder(reference);
+    paramPath         referencePath;
+
+    start = std::chrono::steady_clock::now();
+
+    for(std::string_view lines = text; !lines.empty(); )
+    {
+        size_t n = lines.find('\n');
+        parseLineEvents(lines.substr(0, n), referencePath, value, builder);
+        lines.remove_prefix(n == std::string_view::npos? lines.size() : n + 1);
+    }
+
+    report("scan/parse/lines", 1e3 * gb / secondsSince(start), "MB/s");
+
+    start = std::chrono::steady_clock::now();
+    configList config = parseBuffer(text);
+    report("scan/parse/indexed", 1e3 * gb / secondsSince(start), "MB/s");
+
+    if(config != reference)
+    {
+        std::cerr << "scan: indexed parse differs" << std::endl;
+    }
+}
+
+// Time until w_keys parameters are ready, and until a share of them is read,
+// with parseBuffer and lazyConfig
+static void benchLazy(size_t w_keys)
+{
+    std::string text   = mixedConfig(w_keys);
+    std::string suffix = "/" + std::to_string(w_keys);
+
+    auto start = std::chrono::steady_clock::now();
+    configList config = parseBuffer(text);
+    report("lazy/parseBuffer" + suffix, 1e3 * secondsSince(start), "ms");
+
+    std::vector<std::string> keys;
+
+    for(auto &c : config)
+    {
+        keys.push_back(c.first);
+    }
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+
+    for(size_t percent : {0, 1, 10, 100})
+    {
+        size_t reads = keys.size() * percent / 100;
+        size_t found = 0;
+
+        start = std::chrono::steady_clock::now();
+
+        lazyConfig lazy;
+        lazy.load(text);
+
+        for(size_t n=0; n<reads; n++)
+        {
+            found += lazy.count(keys[n]);
+        }
+
+        report("lazy/lazyConfig/read " + std::to_string(percent) + "%" + suffix, 1e3 * secondsSince(start), "ms");
+
+        if(found != reads)
+        {
+            std::cerr << "lazy: missing keys" << std::endl;
+        }
+    }
+}
+
+// Byte sizes, 64-bit IDs, nanosecond timeouts and doubles: parsing, and reads
+// converting the raw string every time (as when such values were kept as
+// strings) against reads of the values parsed at load time
+static void benchNumbers(size_t w_keys)
+{
+    std::string text;
+    char        hex[24];
+
+    for(size_t k=0; k<w_keys; k++)
+    {
+        text += "n" + std::to_string(k) + ": ";
+
+        switch(k % 4)
+        {
+            case 0:  text += std::to_string(k % 1024 + 1) + "MiB"; break;
+            case 1:  text += std::string("0x") + std::string(hex, std::to_chars(hex, hex + sizeof(hex), mixHash(k), 16).ptr); break;
+            case 2:  text += std::to_string(1000000000ll * (k % 60 + 1) + (long long)k); break;
+            default: text += "0." + std::to_string(mixHash(k) % 1000000000000000ull); break;
+        }
+
+        text += "\n";
+    }
+
+    std::string suffix = "/" + std::to_string(w_keys);
+    size_t      repeat = 1 + 1000000 / w_keys;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(size_t r=0; r<repeat; r++)
+    {
+        configList config = parseBuffer(text);
+
+        if(config.size() != w_keys)
+        {
+            std::cerr << "numbers: unexpected number of entries" << std::endl;
+        }
+    }
+
+    report("numbers/parse" + suffix, 1e9 * secondsSince(start) / (repeat * w_keys), "ns/param");
+
+    configList                       config = parseBuffer(text);
+    std::vector<const config_struct*> values;
+
+    for(size_t k=0; k<w_keys; k++)
+    {
+        values.push_back(&config["n" + std::to_string(k)]);
+    }
+
+    const size_t reads = 10000000;
+    double       sum   = 0;
+
+    start = std::chrono::steady_clock::now();
+
+    for(size_t n=0; n<reads; n++)
+    {
+        const config_struct *value = values[n % values.size()];
+
+        switch(n % values.size() % 4)
+        {
+            case 0:  sum += (double)std::stoull(value->rawString); break;
+            case 1:  sum += (double)std::stoull(value->rawString, nullptr, 16); break;
+            case 2:  sum += (double)std::stoll(value->rawString); break;
+            default: sum += std::stod(value->rawString); break;
+        }
+    }
+
+    report("numbers/read converting strings" + suffix, 1e9 * secondsSince(start) / reads, "ns/read");
+
+    start = std::chrono::steady_clock::now();
+
+    for(size_t n=0; n<reads; n++)
+    {
+        const config_struct *value = values[n % values.size()];
+
+        switch(value->type)
+        {
+            case config_struct::type_::UINT64: sum += (double)value->uint64Val[0]; break;
+            case config_struct::type_::INT64:  sum += (double)value->int64Val[0]; break;
+            case config_struct::type_::DOUBLE: sum += value->doubleVal[0]; break;
+            default:                           sum += value->floatVal[0]; break;
+        }
+    }
+
+    report("numbers/read parsed values" + suffix, 1e9 * secondsSince(start) / reads, "ns/read");
+
+    if(sum == 0)
+    {
+        std::cerr << "numbers: no values read" << std::endl;
+    }
+}
+
+// Writing a configuration as text: printConfiguration (to a string stream)
+// and configWriter to a string and to a file descriptor (/dev/null)
+static void benchWrite(size_t w_keys)
+{
+    configList  config = parseBuffer(mixedConfig(w_keys));
+    std::string suffix = "/" + std::to_string(w_keys);
+
+    auto throughput = [&](const std::string &w_name, const std::function<size_t()> &w_write)
+    {
+        auto   start = std::chrono::steady_clock::now();
+        size_t bytes = w_write();
+
+        report("write/" + w_name + suffix, bytes / 1e6 / secondsSince(start), "MB/s");
+    };
+
+    throughput("printConfiguration", [&]()
+    {
+        std::ostringstream stream;
+        std::streambuf    *out = std::cout.rdbuf(stream.rdbuf());
+
+        printConfiguration(config);
+        std::cout.rdbuf(out);
+        return stream.str().size();
+    });
+
+    throughput("configWriter/string", [&]()
+    {
+        std::string dump;
+        writeConfiguration(config, dump);
+        return dump.size();
+    });
+
+    int fd = open("/dev/null", O_WRONLY);
+
+    throughput("configWriter/fd", [&]()
+    {
+        configWriter writer(fd);
+        writer.write(config);
+        writer.flush();
+        return writer.length();
+    });
+
+    close(fd);
+}
+
+// Enumerating the parameters of one of w_tenants sections: by a scan of
+// std::unordered_map, a lower_bound walk of std::map and a configView
+static void benchSubtree(size_t w_tenants)
+{
+    std::string text = "tenants:\n";
+
+    for(size_t t=0; t<w_tenants; t++)
+    {
+        text += "    tenant" + std::to_string(t) + ":\n";
+
+        for(int k=0; k<10; k++)
+        {
+            text += "        param" + std::to_string(k) + ": " + std::to_string(k) + "\n";
+        }
+    }
+
+    configList                                     config = parseBuffer(text);
+    std::map<std::string, config_struct>           ordered(config.begin(), config.end());
+    std::unordered_map<std::string, config_struct> unordered(config.begin(), config.end());
+    arenaConfig                                    arena = parseBufferToArena(text);
+
+    std::vector<std::string> prefixes;
+    std::mt19937             random(1);
+
+    for(int q=0; q<100; q++)
+    {
+        prefixes.push_back("tenants.tenant" + std::to_string(random() % w_tenants));
+    }
+
+    std::string suffix = "/" + std::to_string(w_tenants);
+
+    auto measure = [&](const std::string &w_name, size_t w_queries, const std::function<size_t(const std::string&)> &w_query)
+    {
+        size_t found = 0;
+        auto   start = std::chrono::steady_clock::now();
+
+        for(size_t q=0; q<w_queries; q++)
+        {
+            found += w_query(prefixes[q % prefixes.size()]);
+        }
+
+        report("subtree/" + w_name + suffix, 1e9 * secondsSince(start) / w_queries, "ns/query");
+
+        if(found != 10 * w_queries)
+        {
+            std::cerr << "subtree/" << w_name << ": wrong number of parameters" << std::endl;
+        }
+    };
+
+    measure("std::unordered_map", 20, [&](const std::string &w_prefix)
+    {
+        std::string dotted = w_prefix + ".";
+        size_t      count  = 0;
+
+        for(auto &c : unordered)
+        {
+            count += c.first.compare(0, dotted.size(), dotted) == 0;
+        }
+
+        return count;
+    });
+
+    measure("std::map", 100000, [&](const std::string &w_prefix)
+    {
+        std::string dotted = w_prefix + ".";
+        size_t      count  = 0;
+
+        for(auto it = ordered.lower_bound(dotted); it != ordered.end() && it->first.compare(0, dotted.size(), dotted) == 0; ++it)
+        {
+            count++;
+        }
+
+        return count;
+    });
+
+    measure("configView", 100000, [&](const std::string &w_prefix)
+    {
+        size_t count = 0;
+
+        for(configView param : arena.view(w_prefix))
+        {
+            count += param.value() != nullptr;
+        }
+
+        return count;
+    });
+}
+
+// Reads per second of w_threads threads looking up random keys through
+// w_find for w_seconds, while another thread writes one key per millisecond
+template<typename Find, typename Write>
+static double concurrentReads(unsigned w_threads, const std::vector<std::string> &w_keys, double w_seconds,
+                              Find w_find, Write w_write)
+{
+    std::atomic<bool>   done(false);
+    std::atomic<size_t> reads(0);
+    std::atomic<size_t> missing(0);
+
+    std::vector<std::thread> threads;
+
+    for(unsigned t=0; t<w_threads; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 random(t);
+            size_t       count = 0;
+            size_t       found = 0;
+
+            while(!done.load(std::memory_order_relaxed))
+            {
+                for(int n=0; n<256; n++)
+                {
+                    found += w_find(w_keys[random() % w_keys.size()]);
+                }
+
+                count += 256;
+            }
+
+            reads   += count;
+            missing += count - found;
+        });
+    }
+
+    std::thread writer([&]()
+    {
+        for(size_t n=0; !done.load(); n++)
+        {
+            w_write(w_keys[n % w_keys.size()], (int)n);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(w_seconds));
+    done.store(true);
+
+    for(auto &t : threads)
+    {
+        t.join();
+    }
+
+    writer.join();
+
+    if(missing.load() != 0)
+    {
+        std::cerr << "registry: missing keys" << std::endl;
+    }
+
+    return reads.load() / secondsSince(start);
+}
+
+// Reads per second of a mutex-guarded configList and of configRegistry with
+// 1 to N reader threads
+static void benchRegistry(size_t w_keys)
+{
+    configList config = parseBuffer(mixedConfig(w_keys));
+
+    std::vector<std::string> keys;
+
+    for(auto &c : config)
+    {
+        keys.push_back(c.first);
+    }
+
+    std::mutex     mutex;
+    configList     guarded(config);
+    configRegistry registry(config);
+
+    config_struct value;
+    value.type = config_struct::type_::INTEGER;
+
+    unsigned maxThreads = std::max(4u, 2 * std::thread::hardware_concurrency());
+
+    for(unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::string suffix = "/threads/" + std::to_string(threads);
+
+        double mutexReads = concurrentReads(threads, keys, 0.5,
+            [&](const std::string &k) { std::lock_guard<std::mutex> lock(mutex); return guarded.count(k); },
+            [&](const std::string &k, int v) { std::lock_guard<std::mutex> lock(mutex); guarded[k].intVal.assign(1, v); });
+
+        double registryReads = concurrentReads(threads, keys, 0.5,
+            [&](const std::string &k) { return (size_t)(bool)registry.find(k); },
+            [&](const std::string &k, int v) { value.intVal.assign(1, v); registry.set(k, value); });
+
+        report("registry/mutex" + suffix, mutexReads / 1e6, "Mreads/s");
+        report("registry/configRegistry" + suffix, registryReads / 1e6, "Mreads/s");
+    }
+}
+
+// Shape of a synthetic configuration (see generateConfig)
+struct generatorOptions
+{
+    size_t      depth     = 3;          // Levels of sections above the values
+    size_t      fanOut    = 8;          // Sub-fields of every section
+    size_t      keyLength = 12;         // Length of parameter names
+    size_t      arraySize = 8;          // Elements of array values
+    uint64_t    totalSize = 100 << 20;  // Approximate size in bytes
+    size_t      mix[5]    = {1, 1, 1, 1, 1};   // Weights of int, float, string, bool and array values
+    std::string fileName  = "bench-suite.txt";
+    bool        keep      = false;      // Keep the generated file
+};
+
+// Parses "key=value" arguments into w_options. Returns false for unknown keys.
+static bool parseGeneratorOptions(int argc, char **argv, generatorOptions &w_options)
+{
+    for(int n=2; n<argc; n++)
+    {
+        std::string arg   = argv[n];
+        size_t      eq    = arg.find('=');
+        std::string key   = arg.substr(0, eq);
+        std::string value = eq == std::string::npos? "" : arg.substr(eq + 1);
+
+        // Sizes accept K, M and G suffixes
+        auto number = [&value]()
+        {
+            char    *end;
+            uint64_t v = strtoull(value.c_str(), &end, 10);
+
+            switch(*end)
+            {
+                case 'K': case 'k': return v << 10;
+                case 'M': case 'm': return v << 20;
+                case 'G': case 'g': return v << 30;
+                default:            return v;
+            }
+        };
+
+        if(key == "depth")          w_options.depth     = number();
+        else if(key == "fanout")    w_options.fanOut    = std::max<uint64_t>(1, number());
+        else if(key == "keylen")    w_options.keyLength = std::max<uint64_t>(1, number());
+        else if(key == "array")     w_options.arraySize = std::max<uint64_t>(1, number());
+        else if(key == "size")      w_options.totalSize = number();
+        else if(key == "file")      w_options.fileName  = value;
+        else if(key == "keep")      w_options.keep      = true;
+        else if(key == "mix")
+        {
+            // int:float:string:bool:array weights, e.g. mix=4:1:1:1:0
+            std::istringstream weights(value);
+            std::string        weight;
+
+            for(size_t t=0; t<5 && std::getline(weights, weight, ':'); t++)
+            {
+                w_options.mix[t] = strtoul(weight.c_str(), nullptr, 10);
+            }
+        }
+        else
+        {
+            std::cerr << "unknown option " << key << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Writes a synthetic configuration: top-level sections, each a tree of
+// w_options.depth levels with w_options.fanOut sub-fields per level, until
+// the total size is reached. Returns the number of lines.
+static size_t generateConfig(const generatorOptions &w_options)
+{
+    std::ofstream file(w_options.fileName, std::ios::binary | std::ios::trunc);
+    std::mt19937  random(1);
+    std::string   text;
+    uint64_t      written = 0;
+    size_t        lines   = 0;
+    size_t        weights = 0;
+
+    for(size_t w : w_options.mix)
+    {
+        weights += w;
+    }
+
+    weights = std::max<size_t>(weights, 1);
+
+    // Name of the n-th field: letters followed by its number, w_options.keyLength
+    // characters (at least)
+    auto name = [&](size_t n)
+    {
+        std::string number = std::to_string(n);
+        std::string key(w_options.keyLength > number.size()? w_options.keyLength - number.size() : 0, 'k');
+
+        for(auto &c : key)
+        {
+            c = 'a' + random() % 26;
+        }
+
+        return key + number;
+    };
+
+    auto value = [&]()
+    {
+        size_t pick = random() % weights;
+        size_t type = 0;
+
+        while(type < 4 && pick >= w_options.mix[type])
+        {
+            pick -= w_options.mix[type++];
+        }
+
+        switch(type)
+        {
+            case 0:  return std::to_string((int)(random() % 100000));
+            case 1:  return std::to_string(random() % 1000) + "." + std::to_string(random() % 1000);
+            case 2:  return "\"" + name(random() % 1000) + "\"";
+            case 3:  return std::string(random() % 2? "TRUE" : "FALSE");
+            default:
+            {
+                std::string array = "[";
+
+                for(size_t n=0; n<w_options.arraySize; n++)
+                {
+                    array += (n > 0? ", " : "") + std::to_string((int)(random() % 1000));
+                }
+
+                return array + "]";
+            }
+        }
+    };
+
+    // Depth-first over one top-level section
+    std::function<void(size_t)> section = [&](size_t w_level)
+    {
+        for(size_t n=0; n<w_options.fanOut; n++)
+        {
+            text.append(4 * w_level, ' ');
+            text += name(n);
+            text += ':';
+            lines++;
+
+            if(w_level + 1 < w_options.depth)
+            {
+                text += '\n';
+                section(w_level + 1);
+            }
+            else
+            {
+                text += ' ';
+                text += value();
+                text += '\n';
+            }
+        }
+    };
+
+    for(size_t top = 0; written < w_options.totalSize; top++)
+    {
+        text  = "section" + std::to_string(top) + ":\n";
+        lines++;
+
+        if(w_options.depth > 0)
+        {
+            section(1);
+        }
+
+        file.write(text.data(), text.size());
+        written += text.size();
+    }
+
+    return lines;
+}
+
+// Peak resident set size of the process in bytes
+static size_t peakRSS()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (size_t)usage.ru_maxrss * 1024;
+}
+
+// parseFile throughput, peak memory, allocations per line and lookup latency
+// on a generated configuration. The configuration is parsed in a child
+// process, so that its peak RSS is not mixed up with that of the generator.
+static void benchSuite(const generatorOptions &w_options)
+{
+    #ifdef USE_ORDERED_MAP
+    const std::string prefix = "suite/std::map/";
+    #else
+    const std::string prefix = "suite/std::unordered_map/";
+    #endif
+
+    size_t lines = generateConfig(w_options);
+    double mb    = 0;
+
+    {
+        struct stat st;
+        stat(w_options.fileName.c_str(), &st);
+        mb = st.st_size / 1e6;
+    }
+
+    report(prefix + "size", mb, "MB");
+    report(prefix + "lines", lines, "lines");
+
+    std::cout.flush();
+
+    pid_t child = fork();
+
+    if(child == 0)
+    {
+        size_t rssBefore   = peakRSS();
+        size_t allocBefore = allocCount;
+
+        auto start = std::chrono::steady_clock::now();
+        configList config = parseFile(w_options.fileName);
+        double seconds = secondsSince(start);
+        size_t allocs  = allocCount - allocBefore;
+
+        report(prefix + "parseFile", mb / seconds, "MB/s");
+        report(prefix + "parseFile/lines", lines / seconds, "lines/s");
+        report(prefix + "parseFile/allocations", (double)allocs / lines, "allocs/line");
+        report(prefix + "parseFile/heap", (double)liveBytes, "bytes");
+        report(prefix + "parseFile/rss", (double)(peakRSS() - rssBefore), "bytes");
+
+        // Lookup of up to 100000 keys in random order
+        std::vector<std::string> keys;
+
+        for(auto &c : config)
+        {
+            keys.push_back(c.first);
+        }
+
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+        keys.resize(std::min<size_t>(keys.size(), 100000));
+
+        if(!keys.empty())
+        {
+            benchLookup(prefix + "lookup", keys, [&](const std::string &k) { return config.count(k); });
+        }
+
+        std::cout.flush();
+        _exit(0);
+    }
+
+    int           status;
+    struct rusage usage;
+
+    if(child < 0 || wait4(child, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        std::cerr << "suite: parsing failed" << std::endl;
+    }
+    else
+    {
+        report(prefix + "peakRSS", (double)usage.ru_maxrss * 1024, "bytes");
+    }
+
+    if(!w_options.keep)
+    {
+        std::remove(w_options.fileName.c_str());
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    std::string name = argc > 1? argv[1] : "all";
+
+    if(name == "suite")
+    {
+        generatorOptions options;
+
+        if(!parseGeneratorOptions(argc, argv, options))
+        {
+            return 1;
+        }
+
+        benchSuite(options);
+        return 0;
+    }
+
+    if(name == "arrays" || name == "all")
+    {
+        for(size_t n : {10, 100, 1000, 10000})
+        {
+            benchArrays(n, false);
+            benchArrays(n, true);
+        }
+    }
+
+    if(name == "memory" || name == "all")
+    {
+        benchMemory(100000);
+    }
+
+    if(name == "lookup" || name == "all")
+    {
+        for(size_t n : {1000, 100000})
+        {
+            benchLookups(n);
+        }
+    }
+
+    if(name == "parallel" || name == "all")
+    {
+        benchParallel(1000000);
+    }
+
+    if(name == "layers" || name == "all")
+    {
+        benchLayers(250000, 4);
+    }
+
+    if(name == "scan" || name == "all")
+    {
+        benchScan(1000000);
+    }
+
+    if(name == "lazy" || name == "all")
+    {
+        benchLazy(1000000);
+    }
+
+    if(name == "numbers" || name == "all")
+    {
+        benchNumbers(100000);
+    }
+
+    if(name == "write" || name == "all")
+    {
+        benchWrite(1000000);
+    }
+
+    if(name == "subtree" || name == "all")
+    {
+        benchSubtree(10000);
+    }
+
+    if(name == "registry" || name == "all")
+    {
+        benchRegistry(100000);
+    }
+
+    if(name == "binary" || name == "all")
+    {
+        for(size_t n : {100000, 1000000})
+        {
+            benchBinary(n);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,502 @@
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "YConfParser.hpp"
+#include "YConfArena.hpp"
+#include "YConfBinary.hpp"
+#include "YConfIncremental.hpp"
+#include "YConfLazy.hpp"
+#include "YConfParallel.hpp"
+#include "YConfWriter.hpp"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace ylibs::yconfparser;
+
+
+// Fuzz target and differential test of the parse engines. Every input is
+// parsed line by line with parseLine (the reference, as parseFile always did),
+// and by every other engine; their configuration lists (and, where the engine
+// reports them in order, their diagnostics) have to be the same.
+//
+// With libFuzzer (clang, -DYCONFPARSER_LIBFUZZER -fsanitize=fuzzer,...) only
+// LLVMFuzzerTestOneInput is built. Otherwise main() runs the inputs given as
+// files or directories, or random and mutated inputs built from a seed corpus
+// (config-sample.txt and generated configurations).
+
+static std::string lastInput;
+
+[[noreturn]] static void mismatch(const std::string &w_engine, const std::string &w_what)
+{
+    std::string name = "fuzz-failure-" + std::to_string(hashString(lastInput)) + ".txt";
+
+    std::ofstream(name, std::ios::binary) << lastInput;
+    fprintf(stdout, "%s differs from the reference: %s (input saved as %s)\n",
+            w_engine.c_str(), w_what.c_str(), name.c_str());
+    fflush(stdout);
+    abort();
+}
+
+// Floating-point values are compared by their bits, so that NaN (e.g. from
+// "nan.") equals itself
+template<typename T>
+static bool sameFloats(const std::vector<T> &w_a, const std::vector<T> &w_b)
+{
+    return w_a.size() == w_b.size() && (w_a.empty() || memcmp(w_a.data(), w_b.data(), w_a.size() * sizeof(T)) == 0);
+}
+
+static bool sameValue(const config_struct &w_a, const config_struct &w_b, bool w_raw)
+{
+    return w_a.type == w_b.type && (!w_raw || w_a.rawString == w_b.rawString) && w_a.stringVal == w_b.stringVal &&
+           w_a.boolVal == w_b.boolVal && sameFloats(w_a.floatVal, w_b.floatVal) && w_a.intVal == w_b.intVal &&
+           w_a.int64Val == w_b.int64Val && w_a.uint64Val == w_b.uint64Val && sameFloats(w_a.doubleVal, w_b.doubleVal);
+}
+
+static std::string describe(const config_struct &w_value)
+{
+    return "type " + std::to_string((int)w_value.type) + " raw '" + w_value.rawString + "'";
+}
+
+// w_raw: whether the engine keeps the raw value strings
+static void compare(const std::string &w_engine, const configList &w_expected, const configList &w_actual,
+                    bool w_raw = true)
+{
+    for(auto &e : w_expected)
+    {
+        auto it = w_actual.find(e.first);
+
+        if(it == w_actual.end())
+        {
+            mismatch(w_engine, "missing '" + e.first + "'");
+        }
+
+        if(!sameValue(e.second, it->second, w_raw))
+        {
+            mismatch(w_engine, "'" + e.first + "': " + describe(e.second) + " vs " + describe(it->second));
+        }
+    }
+
+    if(w_actual.size() != w_expected.size())
+    {
+        for(auto &a : w_actual)
+        {
+            if(w_expected.count(a.first) == 0)
+            {
+                mismatch(w_engine, "extra '" + a.first + "'");
+            }
+        }
+    }
+}
+
+static void compare(const std::string &w_engine, const diagnosticCollector &w_expected,
+                    const diagnosticCollector &w_actual)
+{
+    const auto &e = w_expected.records();
+    const auto &a = w_actual.records();
+
+    for(size_t n=0; n<std::max(e.size(), a.size()); n++)
+    {
+        if(n >= e.size() || n >= a.size() || e[n].code != a[n].code || e[n].line != a[n].line ||
+           e[n].column != a[n].column || e[n].message != a[n].message)
+        {
+            mismatch(w_engine, "diagnostic " + std::to_string(n));
+        }
+    }
+}
+
+static configList parseReference(const std::string &w_text)
+{
+    configList         config;
+    paramPath          path;
+    std::istringstream stream(w_text);
+    std::string        line;
+
+    while(std::getline(stream, line))
+    {
+        parseLine(line, path, config);
+    }
+
+    return config;
+}
+
+static configList parseAtLevel(const std::string &w_text, scanLevel w_level)
+{
+    configList        config;
+    configListBuilder builder(config);
+    paramPath         path;
+    config_struct     value;
+    structuralIndex   index;
+
+    index.level = w_level;
+    parseLinesEvents(w_text, index, path, value, builder);
+    leaveAllSections(path, builder);
+    return config;
+}
+
+static configList arenaList(const arenaConfig &w_arena)
+{
+    configList config;
+
+    w_arena.root().forEachValue([&](configView w_view)
+    {
+        const arenaValue *value = w_view.value();
+        config_struct    &c     = config[w_view.fullName()];
+
+        c.type = value->type;
+
+        for(size_t n=0; n<value->count; n++)
+        {
+            switch(value->type)
+            {
+                case config_struct::type_::STRING:  c.stringVal.emplace_back(value->stringArray()[n]); break;
+                case config_struct::type_::BOOLEAN: c.boolVal.push_back(value->boolArray()[n]); break;
+                case config_struct::type_::FLOAT:   c.floatVal.push_back(value->floatArray()[n]); break;
+                case config_struct::type_::INT64:   c.int64Val.push_back(value->int64Array()[n]); break;
+                case config_struct::type_::UINT64:  c.uint64Val.push_back(value->uint64Array()[n]); break;
+                case config_struct::type_::DOUBLE:  c.doubleVal.push_back(value->doubleArray()[n]); break;
+                default:                            c.intVal.push_back(value->intArray()[n]); break;
+            }
+        }
+    });
+
+    return config;
+}
+
+// Parses an input with every engine and compares the results
+static void checkInput(const std::string &w_text)
+{
+    lastInput = w_text;
+
+    diagnosticCollector reference;
+    configList          expected;
+
+    {
+        diagnosticScope scope(reference);
+        expected = parseReference(w_text);
+    }
+
+    // Single-threaded engines report the same diagnostics in the same order
+    auto checked = [&](const std::string &w_engine, const std::function<configList()> &w_parse)
+    {
+        diagnosticCollector collector;
+        configList          config;
+
+        {
+            diagnosticScope scope(collector);
+            config = w_parse();
+        }
+
+        compare(w_engine, expected, config);
+        compare(w_engine, reference, collector);
+    };
+
+    checked("parseBuffer", [&]() { return parseBuffer(w_text); });
+    checked("parseStream", [&]() { std::istringstream stream(w_text); return parseStream(stream); });
+
+    for(scanLevel level : {scanLevel::SCALAR, scanLevel::SSE2, scanLevel::AVX2})
+    {
+        checked("scan level " + std::to_string((int)level), [&]() { return parseAtLevel(w_text, level); });
+    }
+
+    // Engines whose diagnostics differ in order or time (or which print them)
+    diagnosticCollector quiet;
+    diagnosticScope     scope(quiet);
+
+    compare("parseBufferParallel", expected, parseBufferParallel(w_text, 3, 1));
+    compare("arenaConfig", expected, arenaList(parseBufferToArena(w_text)), false);
+
+    lazyConfig lazy;
+    lazy.load(w_text);
+    compare("lazyConfig", expected, lazy.list());
+
+    // Updates from another text and from the same one reuse sections
+    incrementalConfig incremental;
+    incremental.update(w_text.substr(0, w_text.size() / 2) + "\nextra: 1\n" + w_text.substr(w_text.size() / 2));
+    incremental.update(w_text);
+    compare("incrementalConfig", expected, incremental.list());
+
+    std::string  image;
+    binaryConfig binary;
+
+    if(compileBinary(expected, image) && binary.load(image.data(), image.size()))
+    {
+        compare("binaryConfig", expected, binary.list());
+    }
+
+    // The text written for the list reads back to the same values
+    std::string written;
+
+    if(writeConfiguration(expected, written))
+    {
+        compare("configWriter", expected, parseBuffer(written), false);
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *w_data, size_t w_size)
+{
+    checkInput(std::string(reinterpret_cast<const char*>(w_data), w_size));
+    return 0;
+}
+
+
+#ifndef YCONFPARSER_LIBFUZZER
+
+// Lines with the cases the parser is most particular about
+static const char *const specialLines[] = {
+    "a: 1", "\tb: 2", " \tc: 3", "\t d: 4", "  e: TRUE", "f: xTRUEy", "g: FALSETRUE", "h: \"\"", "i: \"",
+    "j: \"a\"b\"", "k: \"a, b: c\"", "l: []", "m: [ ]", "n: [,]", "o: [1,]", "p: [1, 2.5]", "q: [\"a\", b]",
+    "r: 1.5.5", "s: +5", "t: +-5", "u: 99999999999", "v: 1e40.", "w: nan.", "x: -inf.", "y: .5", "z: 5.",
+    "# comment", "  # indented comment", ": no name", "no colon", "a.b: dotted", "a b c: words", "   ",
+    "k2:", "k3: [TRUE, FALSE, xTRUE]", "k4: [\"a\"\"]", "k5: \"x\"  ", "k6: 1\r", "k7: [1, 2, 3\r]",
+    "k8: 0x1F", "k9: 0xg", "k10: 64MiB", "k11: 4 kB", "k12: -4KiB", "k13: 18446744073709551616", "k14: 5 apples",
+    "k15: [1, 3000000000]", "k16: [0x10, -1]", "k17: [-1, 0x10]", "k18: 3.141592653589793", "k19: 16777217.0",
+    "k20: [0.1, 1.2345678, 1e-40.]", "k21: [2.5, 1e300.]", "k22: [5, 1.5]", "k23: 20000000000000EiB",
+};
+
+// A generated configuration: sections, values of every type and special lines
+static std::string generateConfig(std::mt19937 &w_random)
+{
+    std::string text;
+    int         depth = 0;
+    size_t      lines = 1 + w_random() % 60;
+
+    for(size_t l=0; l<lines; l++)
+    {
+        depth = std::max(0, depth + (int)(w_random() % 3) - 1);
+
+        std::string indent(depth * (1 + w_random() % 4), w_random() % 8 == 0? '\t' : ' ');
+        std::string name = "p" + std::to_string(w_random() % 20);
+
+        switch(w_random() % 12)
+        {
+            case 0:  text += indent + name + ":\n"; break;
+            case 1:  text += indent + name + ": " + std::to_string((int)w_random()) + "\n"; break;
+            case 2:  text += indent + name + ": " + std::to_string((w_random() % 100000) / 7.0f) + "\n"; break;
+            case 7:  text += indent + name + ": " + std::to_string((int64_t)w_random() << (w_random() % 40)) + "\n"; break;
+            case 8:  text += indent + name + ": " + std::to_string((w_random() % 100000) / 7.0) + "e" + std::to_string(w_random() % 60) + "\n"; break;
+            case 3:  text += indent + name + ": \"s " + std::to_string(w_random() % 100) + "\"\n"; break;
+            case 4:  text += indent + name + (w_random() % 2? ": TRUE\n" : ": FALSE\n"); break;
+            case 5:  text += indent + name + ": [1, 2, " + std::to_string(w_random() % 9) + "]\n"; break;
+            case 6:  text += indent + name + ": [\"a\", \"b\"]\n"; break;
+            default: text += indent + specialLines[w_random() % (sizeof(specialLines) / sizeof(*specialLines))] + "\n"; break;
+        }
+    }
+
+    return text;
+}
+
+static std::vector<std::string> seedCorpus()
+{
+    std::vector<std::string> seeds;
+    std::ifstream            sample("config-sample.txt", std::ios::binary);
+    std::mt19937             random(7);
+
+    if(sample.is_open())
+    {
+        seeds.emplace_back((std::istreambuf_iterator<char>(sample)), std::istreambuf_iterator<char>());
+    }
+
+    for(auto line : specialLines)
+    {
+        seeds.push_back(std::string(line) + "\n");
+    }
+
+    for(int n=0; n<50; n++)
+    {
+        seeds.push_back(generateConfig(random));
+    }
+
+    return seeds;
+}
+
+// A random change of an input: bytes, tokens and lines are replaced, inserted,
+// removed or taken from another input
+static std::string mutate(std::string w_text, const std::vector<std::string> &w_seeds, std::mt19937 &w_random)
+{
+    static const char *const tokens[] = {" ", "\t", "\n", "\r\n", ":", ",", "#", "\"", "[", "]", ".", "-", "+",
+                                         "TRUE", "FALSE", "0", "1.5", "e", "nan", "  ", "\t ", " \t",
+                                         "0x", "MiB", "kB", "9999999999", "0.1234567891"};
+
+    for(unsigned m = 1 + w_random() % 4; m > 0; m--)
+    {
+        size_t pos = w_text.empty()? 0 : w_random() % (w_text.size() + 1);
+
+        switch(w_random() % 6)
+        {
+            case 0:
+                if(!w_text.empty())
+                {
+                    w_text[pos % w_text.size()] = (char)w_random();
+                }
+                break;
+            case 1:
+                w_text.insert(pos, tokens[w_random() % (sizeof(tokens) / sizeof(*tokens))]);
+                break;
+            case 2:
+                w_text.erase(pos, w_random() % 8);
+                break;
+            case 3:
+            {
+                // Duplicates a line
+                size_t start = w_text.rfind('\n', pos == 0? 0 : pos - 1);
+                size_t end   = w_text.find('\n', pos);
+                start        = start == std::string::npos? 0 : start + 1;
+
+                if(start <= pos)
+                {
+                    w_text.insert(start, w_text.substr(start, end == std::string::npos? end : end - start + 1));
+                }
+                break;
+            }
+            case 4:
+            {
+                const std::string &other = w_seeds[w_random() % w_seeds.size()];
+                size_t             from  = other.empty()? 0 : w_random() % other.size();
+
+                w_text.insert(pos, other.substr(from, w_random() % 200));
+                break;
+            }
+            default:
+                w_text = w_text.substr(0, pos);
+                break;
+        }
+    }
+
+    return w_text.substr(0, 1 << 16);
+}
+
+static bool readFile(const std::string &w_name, std::string &w_text)
+{
+    std::ifstream file(w_name, std::ios::binary);
+
+    if(!file.is_open())
+    {
+        return false;
+    }
+
+    w_text.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static size_t runPath(const std::string &w_path)
+{
+    struct stat st;
+    size_t      count = 0;
+
+    if(stat(w_path.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        if(DIR *dir = opendir(w_path.c_str()))
+        {
+            while(dirent *entry = readdir(dir))
+            {
+                if(entry->d_name[0] != '.')
+                {
+                    count += runPath(w_path + "/" + entry->d_name);
+                }
+            }
+
+            closedir(dir);
+        }
+
+        return count;
+    }
+
+    std::string text;
+
+    if(!readFile(w_path, text))
+    {
+        std::cerr << "can not read " << w_path << std::endl;
+        return 0;
+    }
+
+    checkInput(text);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    size_t                   runs = 20000;
+    unsigned                 seed = 1;
+    std::vector<std::string> paths;
+
+    for(int n=1; n<argc; n++)
+    {
+        std::string arg = argv[n];
+
+        if(arg.compare(0, 6, "-runs=") == 0)
+        {
+            runs = std::stoul(arg.substr(6));
+        }
+        else if(arg.compare(0, 6, "-seed=") == 0)
+        {
+            seed = (unsigned)std::stoul(arg.substr(6));
+        }
+        else if(arg.compare(0, 12, "-write-seeds") == 0 && arg.size() > 13)
+        {
+            std::string dir   = arg.substr(13);
+            auto        seeds = seedCorpus();
+
+            mkdir(dir.c_str(), 0755);
+
+            for(size_t s=0; s<seeds.size(); s++)
+            {
+                std::ofstream(dir + "/seed-" + std::to_string(s), std::ios::binary) << seeds[s];
+            }
+
+            std::cout << seeds.size() << " seeds written to " << dir << std::endl;
+            return 0;
+        }
+        else
+        {
+            paths.push_back(arg);
+        }
+    }
+
+    // Worker threads of parseBufferParallel print their diagnostics
+    if(getenv("FUZZ_VERBOSE") == nullptr)
+    {
+        freopen("/dev/null", "w", stderr);
+    }
+
+    size_t count = 0;
+
+    if(!paths.empty())
+    {
+        for(auto &p : paths)
+        {
+            count += runPath(p);
+        }
+    }
+    else
+    {
+        std::vector<std::string> seeds = seedCorpus();
+        std::mt19937             random(seed);
+
+        for(auto &s : seeds)
+        {
+            checkInput(s);
+            count++;
+        }
+
+        for(size_t r=0; r<runs; r++)
+        {
+            checkInput(r % 2? mutate(seeds[random() % seeds.size()], seeds, random) : generateConfig(random));
+            count++;
+        }
+    }
+
+    std::cout << count << " inputs, no differences" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,204 @@
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "YConfParser.hpp"
+#include "YConfBinary.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Round-trip test of binary images: a configuration compiled into an image
+// and loaded again has to equal the parseFile() result, lookups have to find
+// every parameter, and damaged images have to be rejected, also if their
+// checksum is valid.
+
+static const char *imageName = "test-binary.bin";
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+// Compares every parameter of w_config with its lookup in w_binary
+static void checkLookups(const configList &w_config, const binaryConfig &w_binary, const std::string &w_name)
+{
+    check(w_binary.size() == w_config.size(), w_name + ": size");
+    check(w_binary.list() == w_config, w_name + ": list");
+
+    for(auto &c : w_config)
+    {
+        const binaryValue *value = w_binary.find(c.first);
+
+        if(value == nullptr)
+        {
+            check(false, w_name + ": find " + c.first);
+            continue;
+        }
+
+        check(w_binary.expand(*value) == c.second, w_name + ": value of " + c.first);
+    }
+
+    check(w_binary.find("no.such.parameter") == nullptr, w_name + ": unknown parameter");
+}
+
+// Loads an image whose header and contents are changed by w_change, with a
+// valid checksum
+template<typename Change>
+static bool loadChanged(const std::string &w_image, Change w_change)
+{
+    std::vector<uint64_t> aligned(w_image.size() / 8 + 1);
+    char                 *data = reinterpret_cast<char*>(aligned.data());
+    binaryHeader          header;
+
+    memcpy(data, w_image.data(), w_image.size());
+    memcpy(&header, data, sizeof(header));
+
+    w_change(header, data);
+
+    header.checksum = hashString(std::string_view(data + sizeof(header), w_image.size() - sizeof(header)));
+    memcpy(data, &header, sizeof(header));
+
+    binaryConfig binary;
+    return binary.load(data, w_image.size());
+}
+
+
+int main()
+{
+    // Sample file, through a file image
+    configList sample = parseFile("config-sample.txt");
+
+    check(writeBinary(sample, imageName), "writeBinary");
+
+    {
+        binaryConfig binary;
+        check(binary.open(imageName), "open");
+        checkLookups(sample, binary, "config-sample.txt");
+    }
+
+    // Every value type, arrays and empty values, through an image in memory
+    configList config = parseBuffer(
+        "empty:\n"
+        "numbers:\n"
+        "    int: -42\n"
+        "    float: 2.5\n"
+        "    ints: [1, 2, 3]\n"
+        "    floats: [0.5, 1.5]\n"
+        "flags: [TRUE, FALSE, TRUE]\n"
+        "names: [\"a\", \"bc\", \"long string value\"]\n"
+        "name: \"x\"\n");
+
+    std::string image;
+    check(compileBinary(config, image), "compileBinary");
+
+    {
+        std::vector<uint64_t> aligned(image.size() / 8 + 1);
+        memcpy(aligned.data(), image.data(), image.size());
+
+        binaryConfig binary;
+        check(binary.load(aligned.data(), image.size()), "load");
+        checkLookups(config, binary, "all types");
+
+        const binaryValue *ints = binary.find("numbers.ints");
+        check(ints != nullptr && binary.intArray(*ints).size() == 3 && binary.getInt(*ints, 2) == 3, "intArray");
+
+        const binaryValue *names = binary.find("names");
+        check(names != nullptr && binary.getString(*names, 2) == "long string value", "getString");
+
+        // Every single-byte change is detected
+        size_t rejected = 0;
+
+        for(size_t n=0; n<image.size(); n++)
+        {
+            reinterpret_cast<char*>(aligned.data())[n] ^= 0x20;
+            rejected += !binary.load(aligned.data(), image.size());
+            reinterpret_cast<char*>(aligned.data())[n] ^= 0x20;
+        }
+
+        check(rejected == image.size(), "corrupt image rejected");
+        check(!binary.load(aligned.data(), image.size() - 1), "truncated image rejected");
+        check(!binary.loaded(), "no image after a failed load");
+    }
+
+    // Offsets out of the image with a valid checksum
+    {
+        check(loadChanged(image, [](binaryHeader &, char *) {}), "unchanged image");
+
+        check(!loadChanged(image, [](binaryHeader &w_header, char *)
+        {
+            w_header.bucketsOffset = UINT64_MAX - 7;
+        }), "buckets out of the image");
+
+        check(!loadChanged(image, [](binaryHeader &w_header, char *w_data)
+        {
+            // As many more entries as make their offset wrap around
+            uint32_t count = w_header.entryCount + (1u << 26);
+
+            memcpy(w_data + w_header.bucketsOffset + w_header.bucketCount * sizeof(uint32_t), &count, sizeof(count));
+            w_header.entryCount    = count;
+            w_header.entriesOffset = w_header.valuesOffset - (uint64_t)count * sizeof(binaryValue);
+        }), "entries out of the image");
+
+        check(!loadChanged(image, [](binaryHeader &w_header, char *)
+        {
+            w_header.stringsOffset = w_header.size + 8;
+        }), "strings out of the image");
+
+        check(!loadChanged(image, [](binaryHeader &w_header, char *w_data)
+        {
+            binaryValue entry;
+            memcpy(&entry, w_data + w_header.entriesOffset, sizeof(entry));
+            entry.nameOffset = (uint32_t)(w_header.size - w_header.stringsOffset);
+            memcpy(w_data + w_header.entriesOffset, &entry, sizeof(entry));
+        }), "name out of the image");
+
+        check(!loadChanged(image, [](binaryHeader &w_header, char *)
+        {
+            w_header.version = binaryVersion - 1;
+        }), "image of an older version");
+    }
+
+    // Invalid image files are reported
+    {
+        std::string damaged = image;
+        damaged.back() ^= 1;
+
+        FILE *file = fopen(imageName, "wb");
+        fwrite(damaged.data(), 1, damaged.size(), file);
+        fclose(file);
+
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        binaryConfig        binary;
+
+        check(!binary.open(imageName) && collector.records().size() == 1 &&
+              collector.records()[0].code == parseDiagnostic::INVALID_IMAGE, "invalid image file reported");
+        check(!binary.open("no-such-image.bin") && collector.records().size() == 2 &&
+              collector.records()[1].code == parseDiagnostic::FILE_OPEN, "missing image file reported");
+    }
+
+    // Empty configuration
+    check(compileBinary(configList(), image), "compileBinary (empty)");
+
+    {
+        std::vector<uint64_t> aligned(image.size() / 8 + 1);
+        memcpy(aligned.data(), image.data(), image.size());
+
+        binaryConfig binary;
+        check(binary.load(aligned.data(), image.size()), "load (empty)");
+        checkLookups(configList(), binary, "empty");
+    }
+
+    std::remove(imageName);
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
@@ -0,0 +1,150 @@
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "YConfCache.hpp"
+
+#include <sys/stat.h>
+
+using namespace ylibs::yconfparser;
+
+
+// Test of parseCache: the same contents are loaded from the cache, changed
+// contents are parsed again, and a damaged cache entry is reported, deleted
+// and replaced, and contents with problems are never stored. Every result
+// equals the parseFile() result.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static const std::string dir      = "test-cache.tmp/";
+static const std::string fileName = dir + "service.conf";
+
+static void writeFile(const std::string &w_name, const std::string &w_text)
+{
+    std::ofstream file(w_name, std::ios::binary | std::ios::trunc);
+    file << w_text;
+}
+
+static std::string readFile(const std::string &w_name)
+{
+    std::ifstream file(w_name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static bool exists(const std::string &w_name)
+{
+    struct stat st;
+    return stat(w_name.c_str(), &st) == 0;
+}
+
+
+int main()
+{
+    mkdir(dir.c_str(), 0755);
+
+    const std::string text    = "a: 1\nb:\n    c: [\"x\", \"y\"]\n    d: 2.5\n";
+    const std::string changed = "a: 2\nb:\n    c: [\"x\", \"y\"]\n    d: 2.5\n";
+
+    writeFile(fileName, text);
+
+    parseCache  cache(dir);
+    std::string entry = cache.entryOf(text);
+
+    // Miss: the file is parsed and an entry is written
+    check(cache.parseFile(fileName) == parseFile(fileName), "miss: result");
+    check(cache.misses() == 1 && cache.hits() == 0 && exists(entry), "miss: entry written");
+
+    // Hit: the entry is loaded
+    check(cache.parseFile(fileName) == parseFile(fileName), "hit: result");
+    check(cache.misses() == 1 && cache.hits() == 1, "hit: counted");
+
+    // Changed contents do not match the entry
+    writeFile(fileName, changed);
+
+    configList config = cache.parseFile(fileName);
+
+    check(config == parseFile(fileName) && config.at("a").intVal == std::vector<int>{2}, "changed: result");
+    check(cache.misses() == 2 && cache.hits() == 1 && exists(cache.entryOf(changed)), "changed: parsed again");
+    check(cache.entryOf(changed) != entry, "changed: other entry");
+
+    // A damaged entry is reported, deleted and written again
+    writeFile(fileName, text);
+
+    std::string image = readFile(entry);
+    image[image.size() / 2] ^= 0x20;
+    writeFile(entry, image);
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        check(cache.parseFile(fileName) == parseFile(fileName), "damaged: result");
+        check(cache.corrupted() == 1 && cache.misses() == 3 && cache.hits() == 1, "damaged: counted");
+        check(collector.records().size() == 1 && collector.records()[0].code == parseDiagnostic::INVALID_IMAGE &&
+              collector.records()[0].severity == parseDiagnostic::WARNING, "damaged: reported");
+    }
+
+    check(readFile(entry) != image, "damaged: entry replaced");
+    check(cache.parseFile(fileName) == parseFile(fileName) && cache.hits() == 2, "damaged: hit after replacement");
+
+    // A cache directory which cannot be written to is reported, but the file is still parsed
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        parseCache          missing(dir + "no-such-dir");
+
+        check(missing.parseFile(fileName) == parseFile(fileName), "unwritable: result");
+
+        bool reported = false;
+
+        for(auto &d : collector.records())
+        {
+            reported |= d.code == parseDiagnostic::FILE_WRITE;
+        }
+
+        check(reported, "unwritable: reported");
+    }
+
+    // Contents with problems are not cached: a strict parse stopped early does
+    // not hide the rest of the file from later parses
+    {
+        const std::string broken = "a: 1\nbad line\nb: 2\n";
+
+        writeFile(fileName, broken);
+
+        {
+            diagnosticCollector collector(SIZE_MAX, true);
+            diagnosticScope     scope(collector);
+
+            check(cache.parseFile(fileName).size() == 1 && collector.stopped(), "problems: strict parse");
+        }
+
+        check(!exists(cache.entryOf(broken)), "problems: not stored");
+
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        check(cache.parseFile(fileName).size() == 2 && collector.errors() == 1, "problems: lenient parse");
+        check(cache.parseFile(fileName).size() == 2 && collector.errors() == 2, "problems: reported again");
+    }
+
+    std::remove(entry.c_str());
+    std::remove(cache.entryOf(changed).c_str());
+    std::remove(fileName.c_str());
+    rmdir(dir.c_str());
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
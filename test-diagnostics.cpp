@@ -0,0 +1,217 @@
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "YConfParser.hpp"
+#include "YConfArena.hpp"
+#include "YConfParallel.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of the diagnostic collector: every problem is recorded with its line,
+// column, severity and code instead of being printed, in all parse functions
+// (also by the worker threads of parseBufferParallel, in the order of the text).
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static const std::string text =
+    "a: 1\n"                    // 1
+    "no colon here\n"           // 2
+    "\t b: 2\n"                 // 3  space after TAB
+    "  \tc: 3\n"                // 4  TAB after space (warning)
+    "  : 4\n"                   // 5  missing colon (line starts with one)
+    "d: [1, 2, x]\n"            // 6  unknown type
+    "e: [1, 2.5]\n"             // 7  mixed array types
+    "f: TRUE\n";                // 8
+
+static void checkRecords(const diagnosticCollector &w_collector, const std::string &w_name)
+{
+    struct expected_ { parseDiagnostic::severity_ severity; parseDiagnostic::code_ code; size_t line, column; };
+
+    const expected_ expected[] = {
+        {parseDiagnostic::ERROR,   parseDiagnostic::MISSING_COLON,     2,  1},
+        {parseDiagnostic::ERROR,   parseDiagnostic::SPACE_AFTER_TAB,   3,  2},
+        {parseDiagnostic::WARNING, parseDiagnostic::TAB_AFTER_SPACE,   4,  3},
+        {parseDiagnostic::ERROR,   parseDiagnostic::MISSING_COLON,     5,  3},
+        {parseDiagnostic::ERROR,   parseDiagnostic::UNKNOWN_TYPE,      6, 11},
+        {parseDiagnostic::ERROR,   parseDiagnostic::MIXED_ARRAY_TYPES, 7,  8},
+    };
+
+    const auto &records = w_collector.records();
+
+    check(records.size() == 6, w_name + ": number of records");
+    check(w_collector.errors() == 5 && w_collector.warnings() == 1, w_name + ": counts");
+
+    for(size_t n=0; n<6 && n<records.size(); n++)
+    {
+        const std::string what = w_name + ": record " + std::to_string(n) + " (" +
+                                 parseDiagnostic::codeName(records[n].code) + " " + std::to_string(records[n].line) +
+                                 ":" + std::to_string(records[n].column) + ")";
+
+        check(records[n].severity == expected[n].severity, what + " severity");
+        check(records[n].code     == expected[n].code,     what + " code");
+        check(records[n].line     == expected[n].line,     what + " line");
+        check(records[n].column   == expected[n].column,   what + " column");
+        check(!records[n].message.empty() && records[n].message.back() != '\n', what + " message");
+    }
+}
+
+
+int main()
+{
+    // All parse functions locate the problems the same way
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer(text);
+
+        checkRecords(collector, "parseBuffer");
+        check(config.size() == 5 && config.count("f"), "parseBuffer: valid lines are kept");
+    }
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        std::istringstream  stream(text);
+
+        parseStream(stream);
+        checkRecords(collector, "parseStream");
+    }
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        paramPath           path;
+        configList          config;
+        std::istringstream  stream(text);
+        std::string         line;
+
+        while(std::getline(stream, line))
+        {
+            parseLine(line, path, config);
+        }
+
+        checkRecords(collector, "parseLine");
+    }
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        arenaConfig         config = parseBufferToArena(text);
+
+        checkRecords(collector, "parseBufferToArena");
+        check(config.size() == 5 && config.find("f") != nullptr, "parseBufferToArena: valid lines are kept");
+    }
+
+    // Parallel parse: every top-level parameter is a chunk of its own
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBufferParallel(text, 4, 1);
+
+        checkRecords(collector, "parseBufferParallel");
+        check(config == parseBuffer(text), "parseBufferParallel: same result");
+    }
+
+    {
+        std::string repeated;
+
+        for(size_t n=0; n<50; n++)
+        {
+            repeated += text;
+        }
+
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        parseBufferParallel(repeated, 4, 1);
+
+        const auto &records = collector.records();
+        bool        ordered = records.size() == 300;
+
+        for(size_t n=0; ordered && n<records.size(); n++)
+        {
+            ordered = records[n].line == records[n % 6].line + (n / 6) * 8;
+        }
+
+        check(ordered, "parseBufferParallel: lines in the whole buffer");
+
+        diagnosticCollector limited(2);
+        diagnosticScope     limitedScope(limited);
+
+        parseBufferParallel(repeated, 4, 1);
+        check(limited.records().size() == 2 && limited.records()[1].line == 3 && limited.dropped() == 298 &&
+              limited.errors() == 250 && limited.warnings() == 50, "parseBufferParallel: limit");
+    }
+
+    // Limit: problems beyond it are counted only
+    {
+        diagnosticCollector collector(2);
+        diagnosticScope     scope(collector);
+
+        parseBuffer(text);
+        check(collector.records().size() == 2 && collector.dropped() == 4, "limit");
+    }
+
+    // Strict mode stops at the first error
+    {
+        diagnosticCollector collector(SIZE_MAX, true);
+        diagnosticScope     scope(collector);
+        configList          config;
+        configListBuilder   builder(config);
+
+        check(!parseBufferEvents(text, builder), "strict: parse stopped");
+        check(collector.stopped() && collector.errors() == 1, "strict: one error");
+        check(config.size() == 1 && config.count("a"), "strict: lines before the error are kept");
+    }
+
+    {
+        diagnosticCollector collector(SIZE_MAX, true);
+        diagnosticScope     scope(collector);
+        arenaConfig         config = parseBufferToArena(text);
+
+        check(collector.stopped() && collector.errors() == 1, "strict arena: one error");
+        check(config.size() == 1 && config.find("a") != nullptr, "strict arena: lines before the error are kept");
+    }
+
+    {
+        std::string repeated;
+
+        for(size_t n=0; n<50; n++)
+        {
+            repeated += text;
+        }
+
+        diagnosticCollector collector(SIZE_MAX, true);
+        diagnosticScope     scope(collector);
+        configList          config = parseBufferParallel(repeated, 4, 1);
+
+        check(collector.stopped() && collector.records().size() == 1 && collector.records()[0].line == 2,
+              "strict parallel: first error of the text");
+        check(config.size() == 1 && config.count("a"), "strict parallel: lines before the error are kept");
+    }
+
+    // Missing files
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        parseFile("no-such-file.txt");
+        check(collector.records().size() == 1 && collector.records()[0].code == parseDiagnostic::FILE_OPEN &&
+              collector.records()[0].line == 0, "missing file");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
@@ -0,0 +1,244 @@
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "YConfIncremental.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of incrementalConfig: every update reports the added, removed and
+// changed parameters to its caller and subscribers, re-parses only the
+// top-level sections whose text changed, and ends with the same list as
+// parseBuffer (also with a strict collector). Problems are reported with
+// their line in the whole text.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static bool sameNames(std::vector<std::string> w_names, std::vector<std::string> w_expected)
+{
+    std::sort(w_names.begin(), w_names.end());
+    std::sort(w_expected.begin(), w_expected.end());
+    return w_names == w_expected;
+}
+
+static bool sameDiff(const configDiff &w_diff, const std::vector<std::string> &w_added,
+                     const std::vector<std::string> &w_removed, const std::vector<std::string> &w_changed)
+{
+    return sameNames(w_diff.added, w_added) && sameNames(w_diff.removed, w_removed) &&
+           sameNames(w_diff.changed, w_changed);
+}
+
+
+int main()
+{
+    incrementalConfig config;
+    size_t            notified = 0;
+    configDiff        lastDiff;
+
+    config.subscribe([&](const configDiff &w_diff, const configList &w_list)
+    {
+        notified++;
+        lastDiff = w_diff;
+        check(&w_list == &config.list(), "subscriber: list");
+    });
+
+    // First text: everything is added
+    std::string text = "a: 1\n"
+                       "b:\n"
+                       "    x: 2\n"
+                       "    y: \"y\"\n"
+                       "c:\n"
+                       "    z: [1, 2]\n";
+
+    configDiff diff = config.update(text);
+
+    check(sameDiff(diff, {"a", "b.x", "b.y", "c.z"}, {}, {}), "first: diff");
+    check(config.reparsedSections() == 3 && config.sectionCount() == 3, "first: all sections parsed");
+    check(notified == 1 && sameDiff(lastDiff, {"a", "b.x", "b.y", "c.z"}, {}, {}), "first: subscriber");
+    check(config.list() == parseBuffer(text), "first: list");
+
+    // A value of one section changes
+    text = "a: 1\n"
+           "b:\n"
+           "    x: 3\n"
+           "    y: \"y\"\n"
+           "c:\n"
+           "    z: [1, 2]\n";
+
+    diff = config.update(text);
+
+    check(sameDiff(diff, {}, {}, {"b.x"}), "change: diff");
+    check(config.reparsedSections() == 1, "change: one section parsed");
+    check(notified == 2 && sameDiff(lastDiff, {}, {}, {"b.x"}), "change: subscriber");
+    check(config.list() == parseBuffer(text), "change: list");
+
+    // The same text: nothing is parsed, subscribers are not called
+    diff = config.update(text);
+
+    check(diff.empty() && config.reparsedSections() == 0 && notified == 2, "same text");
+
+    // Sections are reordered: nothing is parsed
+    text = "c:\n"
+           "    z: [1, 2]\n"
+           "a: 1\n"
+           "b:\n"
+           "    x: 3\n"
+           "    y: \"y\"\n";
+
+    diff = config.update(text);
+
+    check(diff.empty() && config.reparsedSections() == 0 && notified == 2, "reordered");
+
+    // A section is removed and another one added
+    text = "a: 1\n"
+           "b:\n"
+           "    x: 3\n"
+           "    y: \"y\"\n"
+           "d:\n"
+           "    w: TRUE\n"
+           "    v: 1.5\n";
+
+    diff = config.update(text);
+
+    check(sameDiff(diff, {"d.w", "d.v"}, {"c.z"}, {}), "add and remove: diff");
+    check(config.reparsedSections() == 1 && config.sectionCount() == 3, "add and remove: one section parsed");
+    check(notified == 3 && sameDiff(lastDiff, {"d.w", "d.v"}, {"c.z"}, {}), "add and remove: subscriber");
+    check(config.list() == parseBuffer(text), "add and remove: list");
+
+    // A parameter moves from one section to another, and one is dropped
+    text = "a: 1\n"
+           "b:\n"
+           "    x: 3\n"
+           "d:\n"
+           "    w: TRUE\n"
+           "    y: \"y\"\n";
+
+    diff = config.update(text);
+
+    check(sameDiff(diff, {"d.y"}, {"b.y", "d.v"}, {}), "move: diff");
+    check(config.reparsedSections() == 2, "move: two sections parsed");
+    check(config.list() == parseBuffer(text), "move: list");
+
+    // A name defined by two sections: the first definition wins
+    text = "a: 1\n"
+           "b:\n"
+           "    x: 3\n"
+           "b.x: 4\n";
+
+    diff = config.update(text);
+
+    check(sameDiff(diff, {}, {"d.w", "d.y"}, {}), "duplicate: diff");
+    check(config.list() == parseBuffer(text) && config.list().at("b.x").intVal == std::vector<int>{3}, "duplicate: list");
+
+    // ... also after an update which changes another section
+    text = "a: 2\n"
+           "b:\n"
+           "    x: 3\n"
+           "b.x: 4\n";
+
+    diff = config.update(text);
+
+    check(sameDiff(diff, {}, {}, {"a"}), "duplicate update: diff");
+    check(config.list() == parseBuffer(text), "duplicate update: list");
+
+    // A file which cannot be read leaves the configuration unchanged
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        check(!config.updateFromFile("no-such-file.txt", diff), "missing file: failed");
+        check(collector.records().size() == 1 && config.list() == parseBuffer(text) && notified == 6, "missing file: unchanged");
+    }
+
+    // Problems of a changed section are reported with their line in the text
+    {
+        incrementalConfig located;
+
+        located.update("a: 1\n"
+                       "b:\n"
+                       "    x: 2\n"
+                       "c:\n"
+                       "    y: 3\n");
+
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+
+        located.update("a: 1\n"
+                       "b:\n"
+                       "    x: 2\n"
+                       "c:\n"
+                       "    bad line\n");
+
+        check(located.reparsedSections() == 1 && collector.records().size() == 1 &&
+              collector.records()[0].line == 5, "problems: line in the text");
+    }
+
+    // A strict collector stops the update where parseBuffer stops
+    {
+        const std::string broken = "a: 1\n"
+                                   "b:\n"
+                                   "    x: 2\n"
+                                   "bad line\n"
+                                   "c: 3\n"
+                                   "d: 4\n";
+
+        configList expected;
+
+        {
+            diagnosticCollector collector(SIZE_MAX, true);
+            diagnosticScope     scope(collector);
+
+            expected = parseBuffer(broken);
+        }
+
+        for(int first = 0; first < 2; first++)
+        {
+            incrementalConfig strict;
+
+            // Through a full parse, and through an update of some sections
+            if(first == 1)
+            {
+                strict.update("a: 1\n"
+                              "b:\n"
+                              "    x: 2\n"
+                              "c: 3\n"
+                              "d: 4\n");
+            }
+
+            const std::string name = first == 0? "strict: " : "strict update: ";
+
+            {
+                diagnosticCollector collector(SIZE_MAX, true);
+                diagnosticScope     scope(collector);
+
+                strict.update(broken);
+
+                check(collector.stopped() && collector.records().size() == 1 && collector.records()[0].line == 4,
+                      name + "first error");
+                check(strict.list() == expected && strict.list().size() == 2, name + "list");
+            }
+
+            // The next update parses the rest
+            diagnosticCollector collector;
+            diagnosticScope     scope(collector);
+
+            strict.update(broken);
+            check(strict.list() == parseBuffer(broken) && strict.list().size() == 4, name + "rest parsed later");
+        }
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
@@ -0,0 +1,188 @@
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "YConfLayers.hpp"
+
+#include <sys/stat.h>
+
+using namespace ylibs::yconfparser;
+
+
+// Test of layeredConfig: values of later layers override earlier ones, the
+// included files are layers right before the including file, and every value
+// knows its layer.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static const std::string dir = "test-layers.tmp/";
+
+static std::vector<std::string> files;
+
+static void writeFile(const std::string &w_name, const std::string &w_text)
+{
+    std::ofstream file(dir + w_name);
+    file << w_text;
+    files.push_back(dir + w_name);
+}
+
+static bool hasInt(const layeredConfig &w_config, const std::string &w_name, int w_value)
+{
+    const config_struct *value = w_config.find(w_name);
+    return value != nullptr && value->type == config_struct::type_::INTEGER && value->intVal == std::vector<int>{w_value};
+}
+
+static bool hasString(const layeredConfig &w_config, const std::string &w_name, const std::string &w_value)
+{
+    const config_struct *value = w_config.find(w_name);
+    return value != nullptr && value->stringVal == std::vector<std::string>{w_value};
+}
+
+
+int main()
+{
+    mkdir(dir.c_str(), 0755);
+    mkdir((dir + "extra").c_str(), 0755);
+
+    writeFile("common.conf",
+              "a: 0\n"
+              "c: TRUE\n"
+              "section:\n"
+              "    z: 5\n");
+    writeFile("base.conf",
+              "include: \"common.conf\"\n"
+              "a: 1\n"
+              "b: \"base\"\n"
+              "section:\n"
+              "    x: 1\n"
+              "    y: 2\n");
+    writeFile("env.conf",
+              "b: \"env\"\n"
+              "section:\n"
+              "    y: 3\n");
+    writeFile("extra/env-extra.conf",
+              "b: \"extra\"\n"
+              "d: 1.5\n");
+    writeFile("host.conf",
+              "include: [\"extra/env-extra.conf\"]\n"
+              "section.x: 9\n");
+
+    // Layers: common, base, env, extra/env-extra, host
+    {
+        layeredConfig config;
+
+        check(config.load({dir + "base.conf", dir + "env.conf", dir + "host.conf"}), "loaded");
+
+        const auto &layers = config.layers();
+
+        check(layers.size() == 5, "number of layers");
+
+        if(layers.size() == 5)
+        {
+            check(layers[0].fileName == dir + "common.conf" && layers[0].includedBy == 1, "layer 0");
+            check(layers[1].fileName == dir + "base.conf" && layers[1].includedBy == layeredConfig::npos, "layer 1");
+            check(layers[2].fileName == dir + "env.conf", "layer 2");
+            check(layers[3].fileName == dir + "extra/env-extra.conf" && layers[3].includedBy == 4, "layer 3");
+            check(layers[4].fileName == dir + "host.conf", "layer 4");
+
+            check(layers[0].params == 3 && layers[0].overridden == 1, "common: a is overridden");
+            check(layers[1].params == 4 && layers[1].overridden == 3, "base: b, x, y are overridden");
+            check(layers[2].params == 2 && layers[2].overridden == 1, "env: b is overridden");
+            check(layers[4].params == 1 && layers[4].overridden == 0, "host: include is not a parameter");
+        }
+
+        check(config.size() == 7 && !config.count("include"), "merged size");
+        check(hasInt(config, "a", 1) && config.layerOf("a") == 1, "a");
+        check(hasString(config, "b", "extra") && config.layerOf("b") == 3, "b");
+        check(config.find("c") && config.find("c")->boolVal[0] && config.layerOf("c") == 0, "c");
+        check(config.find("d") && config.find("d")->floatVal[0] == 1.5f && config.layerOf("d") == 3, "d");
+        check(hasInt(config, "section.x", 9) && config.layerOf("section.x") == 4, "section.x");
+        check(hasInt(config, "section.y", 3) && config.layerOf("section.y") == 2, "section.y");
+        check(hasInt(config, "section.z", 5) && config.layerOf("section.z") == 0, "section.z");
+        check(config.find("none") == nullptr && config.layerOf("none") == layeredConfig::npos, "missing parameter");
+
+        // Same result as merging parseFile results by hand (with one thread too)
+        configList expected;
+
+        for(auto l = layers.rbegin(); l != layers.rend(); ++l)
+        {
+            configList layer = parseFile(l->fileName);
+            layer.erase("include");
+            expected.insert(layer.begin(), layer.end());
+        }
+
+        layeredConfig single;
+        single.load({dir + "base.conf", dir + "env.conf", dir + "host.conf"}, 1);
+
+        for(auto &e : expected)
+        {
+            const config_struct *value = single.find(e.first);
+
+            check(value != nullptr && value->type == e.second.type && value->intVal == e.second.intVal &&
+                  value->stringVal == e.second.stringVal && value->floatVal == e.second.floatVal &&
+                  value->boolVal == e.second.boolVal, "by hand: " + e.first);
+        }
+
+        configList released = config.release();
+        check(released.size() == 7 && config.size() == 0 && config.find("a") == nullptr, "release");
+    }
+
+    // Cycles, invalid include directives and missing files are reported with their file
+    writeFile("loop1.conf", "include: \"loop2.conf\"\nl1: 1\n");
+    writeFile("loop2.conf", "include: \"loop1.conf\"\nl2: 2\n");
+    writeFile("invalid.conf", "include: 5\nv: 1\n  : x\n");
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        layeredConfig       config;
+
+        check(!config.load({dir + "loop1.conf", dir + "invalid.conf", dir + "none.conf"}), "problems: not complete");
+        check(hasInt(config, "l1", 1) && hasInt(config, "l2", 2) && hasInt(config, "v", 1), "problems: valid files merged");
+
+        size_t found = 0;
+
+        for(auto &d : collector.records())
+        {
+            found += (d.code == parseDiagnostic::INCLUDE_CYCLE && d.file == dir + "loop2.conf") ||
+                     (d.code == parseDiagnostic::INCLUDE_VALUE && d.file == dir + "invalid.conf") ||
+                     (d.code == parseDiagnostic::MISSING_COLON && d.file == dir + "invalid.conf" && d.line == 3) ||
+                     (d.code == parseDiagnostic::FILE_OPEN && d.file == dir + "none.conf");
+        }
+
+        check(collector.records().size() == 4 && found == 4, "problems: diagnostics");
+    }
+
+    // The record limit holds across files; the other problems are counted
+    {
+        diagnosticCollector collector(1);
+        diagnosticScope     scope(collector);
+        layeredConfig       config;
+
+        config.load({dir + "loop1.conf", dir + "invalid.conf", dir + "none.conf"});
+        check(collector.records().size() == 1 && collector.dropped() == 3, "problems: limit");
+    }
+
+    for(auto &f : files)
+    {
+        remove(f.c_str());
+    }
+
+    rmdir((dir + "extra").c_str());
+    rmdir(dir.c_str());
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
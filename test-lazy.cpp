@@ -0,0 +1,133 @@
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "YConfLazy.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of lazyConfig: decoding on first access has to give the same values as
+// parseBuffer, also when many threads read the same values first.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static void checkText(const std::string &w_text, const std::string &w_name)
+{
+    configList expected = parseBuffer(w_text);
+    lazyConfig lazy;
+
+    lazy.load(w_text);
+    check(lazy.decoded() == 0, w_name + ": nothing decoded by loading");
+
+    for(auto &c : expected)
+    {
+        const config_struct *value = lazy.find(c.first);
+        check(value != nullptr && *value == c.second, w_name + ": " + c.first);
+    }
+
+    check(lazy.list() == expected, w_name + ": list");
+}
+
+
+int main()
+{
+    // Random text made of the characters the parser cares about
+    const char   alphabet[] = " \t\n\r:,#\"[]TRUEFALSE0123456789.-+ab";
+    std::mt19937 random(1);
+
+    for(int n=0; n<2000; n++)
+    {
+        std::string text(random() % 300, ' ');
+
+        for(auto &c : text)
+        {
+            c = alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+
+        checkText(text, "random " + std::to_string(n));
+    }
+
+    // Names defined more than once: the first valid value is kept
+    checkText("a: x\na: 1\na: 2\nb:\n  c: [1, 2]\nb:\n  c: 3\n", "duplicates");
+
+    // A strict collector stops loading at the first line error, as parseBuffer
+    {
+        const std::string text = "a: 1\nb:\n  c: 2\nbad line\nd: 3\ne: [1, x]\n";
+
+        diagnosticCollector collector(SIZE_MAX, true);
+        diagnosticScope     scope(collector);
+        lazyConfig          lazy;
+
+        lazy.load(text);
+        check(collector.stopped() && collector.records().size() == 1 && collector.records()[0].line == 4,
+              "strict: first error");
+        check(lazy.size() == 2 && lazy.find("a") != nullptr && lazy.find("d") == nullptr, "strict: lines before the error");
+        check(lazy.list() == parseBuffer(text), "strict: list");
+    }
+
+    // Files
+    {
+        lazyConfig lazy;
+
+        check(lazy.open("config-sample.txt"), "open");
+        check(lazy.list() == parseFile("config-sample.txt"), "config-sample.txt");
+        check(lazy.find("no.such.name") == nullptr, "missing name");
+    }
+
+    // Concurrent first reads
+    {
+        std::string text;
+
+        for(int k=0; k<10000; k++)
+        {
+            text += "key" + std::to_string(k) + ": [" + std::to_string(k) + ", " + std::to_string(k) + "]\n";
+        }
+
+        lazyConfig lazy;
+        lazy.load(text);
+
+        std::atomic<size_t>      failures(0);
+        std::vector<std::thread> threads;
+
+        for(int t=0; t<8; t++)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for(int k=0; k<10000; k++)
+                {
+                    int                  n     = (k * 7 + t) % 10000;
+                    const config_struct *value = lazy.find("key" + std::to_string(n));
+
+                    if(value == nullptr || value->intVal != std::vector<int>{n, n})
+                    {
+                        failures++;
+                    }
+                }
+            });
+        }
+
+        for(auto &t : threads)
+        {
+            t.join();
+        }
+
+        check(failures.load() == 0, "concurrent reads");
+        check(lazy.decoded() == 10000, "every value decoded once");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
@@ -0,0 +1,351 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "YConfParser.hpp"
+#include "YConfArena.hpp"
+#include "YConfBinary.hpp"
+#include "YConfCompact.hpp"
+#include "YConfFrozen.hpp"
+#include "YConfSchema.hpp"
+#include "YConfWriter.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of the 64-bit and double value types: every number gets the narrowest
+// type which keeps its value, arrays take the widest type of their elements,
+// and every engine stores the values unchanged.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static config_struct parseOne(const std::string &w_value)
+{
+    configList config = parseBuffer("x: " + w_value + "\n");
+    return config.count("x")? config["x"] : config_struct();
+}
+
+static void checkInt64(const std::string &w_value, int64_t w_expected)
+{
+    config_struct value = parseOne(w_value);
+    check(value.type == config_struct::type_::INT64 && value.int64Val == std::vector<int64_t>{w_expected}, w_value);
+}
+
+static void checkUint64(const std::string &w_value, uint64_t w_expected)
+{
+    config_struct value = parseOne(w_value);
+    check(value.type == config_struct::type_::UINT64 && value.uint64Val == std::vector<uint64_t>{w_expected}, w_value);
+}
+
+static void checkType(const std::string &w_value, config_struct::type_ w_type)
+{
+    check(parseOne(w_value).type == w_type, w_value + ": type");
+}
+
+
+int main()
+{
+    typedef config_struct::type_ type_;
+
+    // Integers
+    check(parseOne("2147483647").intVal == std::vector<int>{2147483647}, "int max");
+    check(parseOne("-2147483648").intVal == std::vector<int>{-2147483647 - 1}, "int min");
+    checkInt64("2147483648", 2147483648ll);
+    checkInt64("-2147483649", -2147483649ll);
+    checkInt64("+9223372036854775807", INT64_MAX);
+    checkInt64("-9223372036854775808", INT64_MIN);
+    checkUint64("9223372036854775808", 9223372036854775808ull);
+    checkUint64("18446744073709551615", UINT64_MAX);
+    checkType("18446744073709551616", type_::NO_VAL);
+    checkType("-9223372036854775809", type_::NO_VAL);
+    checkType("5 apples", type_::INTEGER);
+
+    // Hexadecimal integers and byte sizes
+    checkUint64("0x1F", 31);
+    checkUint64("0Xffffffffffffffff", UINT64_MAX);
+    checkUint64("0x0", 0);
+    checkType("0x", type_::INTEGER);
+    checkType("0xg", type_::NO_VAL);
+    checkType("0x10000000000000000", type_::NO_VAL);
+    checkUint64("64MiB", 64ull << 20);
+    checkUint64("4 KiB", 4096);
+    checkUint64("3GiB", 3ull << 30);
+    checkUint64("2TiB", 2ull << 40);
+    checkUint64("1EiB", 1ull << 60);
+    checkType("16EiB", type_::NO_VAL);
+    checkUint64("4kB", 4000);
+    checkUint64("4KB", 4000);
+    checkUint64("10MB", 10000000);
+    checkUint64("512B", 512);
+    checkUint64("18446744073709551615B", UINT64_MAX);
+    checkType("-4KiB", type_::NO_VAL);
+    checkType("20000000000000EiB", type_::NO_VAL);
+    checkType("10 KiBs", type_::INTEGER);
+    checkType("1.5GiB", type_::NO_VAL);
+    checkType("0.5 KiB", type_::NO_VAL);
+
+    // Floating-point numbers: FLOAT if float keeps them as written
+    checkType("0.1", type_::FLOAT);
+    checkType("15.2453", type_::FLOAT);
+    checkType("1.2345678", type_::FLOAT);
+    checkType("1.000000000000000000001", type_::FLOAT);
+    checkType("100000000.0", type_::FLOAT);
+    checkType("221317.e4", type_::FLOAT);
+    checkType("nan.", type_::FLOAT);
+    checkType("-inf.", type_::FLOAT);
+    checkType("16777217.0", type_::DOUBLE);
+    checkType("3.141592653589793", type_::DOUBLE);
+    checkType("1e39.", type_::DOUBLE);
+    checkType("1.5e-300", type_::DOUBLE);
+    checkType("1e400.", type_::NO_VAL);
+    check(parseOne("3.141592653589793").doubleVal == std::vector<double>{3.141592653589793}, "double value");
+    check(parseOne("0.1").floatVal == std::vector<float>{0.1f}, "float value");
+
+    // Random decimals: FLOAT values are those of std::from_chars<float> and
+    // widen to the double of their text, DOUBLE values are those of strtod
+    std::mt19937_64 random(5);
+
+    for(int n=0; n<200000; n++)
+    {
+        std::string text = std::to_string(random() % 1000000000000ull);
+        size_t      point = random() % text.size();
+
+        text.insert(text.size() - point, ".");
+        text += random() % 4 == 0? "e" + std::to_string((int)(random() % 90) - 45) : "";
+
+        config_struct value = parseOne(text);
+        double        exact = strtod(text.c_str(), nullptr);
+
+        if(value.type == type_::FLOAT)
+        {
+            float expected = 0;
+            std::from_chars(text.data(), text.data() + text.size(), expected);
+            check(value.floatVal[0] == expected && widenFloat(value.floatVal[0]) == exact, "float " + text);
+        }
+        else
+        {
+            check(value.type == type_::DOUBLE && value.doubleVal[0] == exact &&
+                  widenFloat((float)exact) != exact, "double " + text);
+        }
+    }
+
+    // Arrays take the widest type
+    {
+        configList config = parseBuffer("a: [1, 3000000000, -5]\n"
+                                        "b: [1, 0x10, 64KiB]\n"
+                                        "c: [3000000000, 18446744073709551615]\n"
+                                        "d: [0.1, 3.141592653589793, 2.5]\n"
+                                        "e: [1, 2]\n"
+                                        "f: [0.5, 0.25]\n");
+
+        check(config["a"].type == type_::INT64 && config["a"].int64Val == std::vector<int64_t>{1, 3000000000ll, -5} &&
+              config["a"].intVal.empty(), "int64 array");
+        check(config["b"].type == type_::UINT64 && config["b"].uint64Val == std::vector<uint64_t>{1, 16, 65536}, "uint64 array");
+        check(config["c"].type == type_::UINT64 && config["c"].uint64Val == std::vector<uint64_t>{3000000000ull, UINT64_MAX}, "uint64 array of int64");
+        check(config["d"].type == type_::DOUBLE && config["d"].doubleVal == std::vector<double>{0.1, 3.141592653589793, 2.5} &&
+              config["d"].floatVal.empty(), "double array");
+        check(config["e"].type == type_::INTEGER && config["f"].type == type_::FLOAT, "narrow arrays");
+    }
+
+    // Negative numbers do not widen to UINT64, integers do not widen to floating-point
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer("a: [-1, 0x10]\n"
+                                                 "b: [0x10, -1, 2]\n"
+                                                 "c: [1, 2.5]\n");
+
+        check(config["a"].type == type_::INTEGER && config["a"].intVal == std::vector<int>{-1}, "mixed sign: kept");
+        check(config["b"].type == type_::UINT64 && config["b"].uint64Val == std::vector<uint64_t>{16}, "mixed sign: kept 2");
+        check(config["c"].type == type_::INTEGER && config["c"].intVal == std::vector<int>{1}, "int and float");
+        check(collector.records().size() == 3, "mixed types reported");
+
+        for(auto &d : collector.records())
+        {
+            check(d.code == parseDiagnostic::MIXED_ARRAY_TYPES, "mixed types code");
+        }
+    }
+
+    // Engines keep the values
+    const std::string text = "size: 64MiB\n"
+                             "id: 0xfedcba9876543210\n"
+                             "offset: -5000000000\n"
+                             "ratio: 0.333333333333\n"
+                             "ids: [1, 5000000000]\n"
+                             "sizes: [4KiB, 0x10]\n"
+                             "ratios: [0.1, 1e100.]\n";
+
+    configList config = parseBuffer(text);
+
+    {
+        std::string  image;
+        binaryConfig binary;
+
+        check(compileBinary(config, image) && binary.load(image.data(), image.size()), "binary: loaded");
+        check(binary.list() == config, "binary: list");
+        check(binary.getUint64(*binary.find("size")) == (64ull << 20) &&
+              binary.getInt64(*binary.find("ids"), 1) == 5000000000ll &&
+              binary.getDouble(*binary.find("ratios"), 1) == 1e100, "binary: accessors");
+    }
+
+    {
+        compactConfig compact(config);
+
+        for(auto &c : config)
+        {
+            config_struct expected = c.second;
+            expected.rawString.clear();
+
+            check(compact.expand(*compact.find(c.first)) == expected, "compact: " + c.first);
+        }
+
+        check(compact.getUint64(*compact.find("id")) == 0xfedcba9876543210ull &&
+              compact.getInt64(*compact.find("offset")) == -5000000000ll &&
+              compact.getDouble(*compact.find("ratio")) == 0.333333333333, "compact: accessors");
+    }
+
+    {
+        arenaConfig arena = parseBufferToArena(text);
+
+        check(arena.find("sizes")->uint64Array().size() == 2 && arena.find("sizes")->getUint64(0) == 4096 &&
+              arena.find("ids")->getInt64(1) == 5000000000ll && arena.find("ratios")->getDouble(0) == 0.1 &&
+              arena.find("ratio")->type == type_::DOUBLE, "arena: accessors");
+    }
+
+    {
+        frozenConfig frozen(config);
+
+        check(frozen.getUint64(frozen.resolve("size")) == (64ull << 20) &&
+              frozen.getDoubleArray(frozen.resolve("ratios")) == std::vector<double>{0.1, 1e100} &&
+              frozen.getInt64Array(frozen.resolve("ids")).size() == 2, "frozen: accessors");
+    }
+
+    {
+        std::string written;
+
+        check(writeConfiguration(config, written), "writer: written");
+
+        configList again = parseBuffer(written);
+
+        for(auto &c : config)
+        {
+            config_struct expected = c.second;
+            expected.rawString     = again[c.first].rawString;
+
+            check(again[c.first] == expected, "writer: " + c.first);
+        }
+    }
+
+    // The 64-bit and double getters convert narrower types, whatever the
+    // type a value got from its literal; other values read as 0
+    {
+        const std::string widen = "small: 5000\n"
+                                  "half: 0.5\n"
+                                  "neg: -3\n"
+                                  "name: \"x\"\n"
+                                  "smalls: [1, 2]\n";
+
+        configList   list = parseBuffer(widen);
+        std::string  image;
+        binaryConfig binary;
+
+        auto checkGetters = [](auto w_int64, auto w_uint64, auto w_double, const std::string &w_name)
+        {
+            check(w_int64("small", 0) == 5000 && w_uint64("small", 0) == 5000 && w_double("small", 0) == 5000.0,
+                  w_name + ": integer");
+            check(w_double("half", 0) == 0.5 && w_int64("half", 0) == 0, w_name + ": float");
+            check(w_int64("neg", 0) == -3 && w_uint64("neg", 0) == 0 && w_double("neg", 0) == -3.0, w_name + ": negative");
+            check(w_int64("name", 0) == 0 && w_double("name", 0) == 0.0, w_name + ": string");
+            check(w_int64("smalls", 1) == 2, w_name + ": array");
+        };
+
+        check(compileBinary(list, image) && binary.load(image.data(), image.size()), "widen: binary loaded");
+        checkGetters([&](const char *w_key, size_t n) { return binary.getInt64(*binary.find(w_key), n); },
+                     [&](const char *w_key, size_t n) { return binary.getUint64(*binary.find(w_key), n); },
+                     [&](const char *w_key, size_t n) { return binary.getDouble(*binary.find(w_key), n); }, "widen: binary");
+        check(binary.int64Array(*binary.find("small")).empty(), "widen: binary views of another type");
+
+        compactConfig compact(list);
+
+        checkGetters([&](const char *w_key, size_t n) { return compact.getInt64(*compact.find(w_key), n); },
+                     [&](const char *w_key, size_t n) { return compact.getUint64(*compact.find(w_key), n); },
+                     [&](const char *w_key, size_t n) { return compact.getDouble(*compact.find(w_key), n); }, "widen: compact");
+        check(compact.doubleArray(*compact.find("half")).empty(), "widen: compact views of another type");
+
+        arenaConfig arena = parseBufferToArena(widen);
+
+        checkGetters([&](const char *w_key, size_t n) { return arena.find(w_key)->getInt64(n); },
+                     [&](const char *w_key, size_t n) { return arena.find(w_key)->getUint64(n); },
+                     [&](const char *w_key, size_t n) { return arena.find(w_key)->getDouble(n); }, "widen: arena");
+        check(arena.find("smalls")->uint64Array().empty(), "widen: arena views of another type");
+
+        frozenConfig frozen(list);
+
+        checkGetters([&](const char *w_key, size_t n) { return frozen.getInt64(frozen.resolve(w_key), n); },
+                     [&](const char *w_key, size_t n) { return frozen.getUint64(frozen.resolve(w_key), n); },
+                     [&](const char *w_key, size_t n) { return frozen.getDouble(frozen.resolve(w_key), n); }, "widen: frozen");
+    }
+
+    // Schemas bind numbers to any numeric member which holds them
+    {
+        struct limits
+        {
+            uint64_t              size;
+            int64_t               offset;
+            double                ratio;
+            double                half;
+            float                 ratioFloat;
+            std::vector<uint64_t> ids;
+            std::vector<double>   ratios;
+        };
+
+        static const auto schema = makeSchema(
+            requiredField("size",   &limits::size),
+            requiredField("offset", &limits::offset),
+            requiredField("ratio",  &limits::ratio),
+            requiredField("half",   &limits::half),
+            requiredField("ratio",  &limits::ratioFloat),
+            requiredField("ids",    &limits::ids),
+            requiredField("ratios", &limits::ratios));
+
+        configList bound = config;
+        bound["half"]    = parseOne("0.1");
+
+        limits l{};
+        check(schema.bind(bound, l), "schema: bound");
+        check(l.size == (64ull << 20) && l.offset == -5000000000ll && l.ratio == 0.333333333333 &&
+              l.half == 0.1 && l.ratioFloat == 0.333333333333f &&
+              l.ids == std::vector<uint64_t>{1, 5000000000ull} && l.ratios == std::vector<double>{0.1, 1e100}, "schema: values");
+
+        struct narrow
+        {
+            uint64_t unsignedOffset;
+            int64_t  signedId;
+            int64_t  fromFloat;
+        };
+
+        static const auto narrowSchema = makeSchema(
+            requiredField("offset", &narrow::unsignedOffset),
+            requiredField("id",     &narrow::signedId),
+            requiredField("ratio",  &narrow::fromFloat));
+
+        narrow n{};
+        check(!narrowSchema.bind(config, n), "schema: out of range");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
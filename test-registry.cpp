@@ -0,0 +1,136 @@
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "YConfRegistry.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Stress test of configRegistry: reader threads check that every value they
+// see is consistent while a writer updates, removes and re-adds parameters.
+
+static const size_t keys = 1000;
+
+static config_struct intValue(int w_value)
+{
+    config_struct value;
+    value.type = config_struct::type_::INTEGER;
+    value.intVal.assign(2, w_value);    // Both elements are always equal
+    return value;
+}
+
+
+int main()
+{
+    const unsigned readers = 8;
+    const int      updates = 20000;
+
+    std::atomic<bool>   done(false);
+    std::atomic<size_t> errors(0);
+    std::atomic<size_t> reads(0);
+
+    std::vector<std::string> names;
+    configList               config;
+
+    for(size_t k=0; k<keys; k++)
+    {
+        names.push_back("values.key" + std::to_string(k));
+        config[names.back()] = intValue(0);
+    }
+
+    {
+        configRegistry registry(config);
+
+        if(registry.size() != keys || !registry.contains("values.key0") || registry.contains("values"))
+        {
+            std::cerr << "initial contents" << std::endl;
+            errors++;
+        }
+
+        std::vector<std::thread> threads;
+
+        for(unsigned r=0; r<readers; r++)
+        {
+            threads.emplace_back([&, r]()
+            {
+                std::vector<int> last(keys, 0);
+                size_t           n = r;
+
+                while(!done.load())
+                {
+                    n = (n + 7) % keys;
+
+                    auto value = registry.find(names[n]);
+
+                    // Removed parameters come back later
+                    if(!value)
+                    {
+                        continue;
+                    }
+
+                    // Values of a parameter only move forward, and are never torn
+                    if(value->intVal.size() != 2 || value->intVal[0] != value->intVal[1] || value->intVal[0] < last[n])
+                    {
+                        errors++;
+                    }
+
+                    last[n] = value->intVal[0];
+
+                    // Nested reads
+                    auto other = registry.find(names[(n + 1) % keys]);
+
+                    if(other && other->intVal.size() != 2)
+                    {
+                        errors++;
+                    }
+
+                    reads++;
+                }
+            });
+        }
+
+        for(int u=1; u<=updates; u++)
+        {
+            const std::string &name = names[(size_t)u % keys];
+
+            if(u % 10 == 0)
+            {
+                registry.erase(name);
+            }
+
+            registry.set(name, intValue(u));
+        }
+
+        done.store(true);
+
+        for(auto &t : threads)
+        {
+            t.join();
+        }
+
+        configList result = registry.list();
+
+        for(size_t k=0; k<keys; k++)
+        {
+            int expected = (int)(k + keys * ((updates - k) / keys));
+
+            if(result[names[k]].intVal[0] != expected)
+            {
+                std::cerr << names[k] << ": final value" << std::endl;
+                errors++;
+            }
+        }
+
+        if(registry.pendingShards() != 0)
+        {
+            std::cerr << "replaced shards are not freed" << std::endl;
+            errors++;
+        }
+    }
+
+    std::cout << reads.load() << " reads, " << errors.load() << " errors" << std::endl;
+    return errors.load() == 0? 0 : 1;
+}
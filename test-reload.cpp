@@ -0,0 +1,251 @@
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "YConfReload.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Stress test of reloadableConfig: reader threads check that every snapshot
+// they see is consistent while the file is rewritten and reloaded repeatedly.
+// Then a file written in place is only reloaded once it is complete,
+// readers beyond the reader slots still get snapshots, and a missing file
+// gives an empty snapshot until it can be loaded.
+
+static const char  *fileName = "test-reload.txt";
+static const size_t keys     = 100;
+
+// Writes a configuration in which every parameter has the value w_value
+static void writeConfig(int w_value)
+{
+    std::string tmpName = std::string(fileName) + ".tmp";
+
+    {
+        std::ofstream file(tmpName);
+        file << "values:\n";
+
+        for(size_t k=0; k<keys; k++)
+        {
+            file << "    key" << k << ": " << w_value << "\n";
+        }
+    }
+
+    std::rename(tmpName.c_str(), fileName);
+}
+
+
+int main()
+{
+    const unsigned readers = 8;
+    const int      updates = 200;
+
+    writeConfig(0);
+
+    std::atomic<bool>   done(false);
+    std::atomic<size_t> errors(0);
+    std::atomic<size_t> reads(0);
+
+    {
+        reloadableConfig config(fileName);
+
+        std::vector<paramKey> names;
+        std::vector<std::string> nameStrings;
+
+        for(size_t k=0; k<keys; k++)
+        {
+            nameStrings.push_back("values.key" + std::to_string(k));
+        }
+
+        for(auto &name : nameStrings)
+        {
+            names.emplace_back(name);
+        }
+
+        std::vector<std::thread> threads;
+
+        for(unsigned r=0; r<readers; r++)
+        {
+            threads.emplace_back([&]()
+            {
+                uint64_t lastVersion = 0;
+                int      lastValue   = 0;
+
+                while(!done.load())
+                {
+                    auto snapshot = config.read();
+
+                    // Versions and values only move forward
+                    if(snapshot->version < lastVersion)
+                    {
+                        errors++;
+                    }
+
+                    const config_struct *first = snapshot->config.find(names[0]);
+                    int value = first != nullptr? first->intVal[0] : -1;
+
+                    if(value < lastValue)
+                    {
+                        errors++;
+                    }
+
+                    // All parameters of a snapshot come from the same file
+                    for(auto &name : names)
+                    {
+                        const config_struct *c = snapshot->config.find(name);
+
+                        if(c == nullptr || c->intVal[0] != value)
+                        {
+                            errors++;
+                        }
+                    }
+
+                    lastVersion = snapshot->version;
+                    lastValue   = value;
+                    reads++;
+                }
+            });
+        }
+
+        // Updates are picked up by the watcher, and by explicit reloads
+        for(int u=1; u<=updates; u++)
+        {
+            writeConfig(u);
+
+            if(u % 2 == 0)
+            {
+                config.reload();
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+
+        config.reload();
+
+        done.store(true);
+
+        for(auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        if(config.read()->config.find("values.key0")->intVal[0] != updates)
+        {
+            std::cerr << "the last update is not published" << std::endl;
+            errors++;
+        }
+
+        if(config.pendingSnapshots() != 0)
+        {
+            std::cerr << "replaced snapshots are not freed" << std::endl;
+            errors++;
+        }
+
+        std::cout << reads.load() << " reads, " << config.version() << " loads, ";
+    }
+
+    // A file created and written in place is not published while it is empty
+    {
+        reloadableConfig config(fileName);
+        uint64_t         version = config.version();
+
+        std::remove(fileName);
+
+        std::ofstream file(fileName);
+        file.flush();
+
+        for(int n=0; n<30; n++)
+        {
+            if(config.read()->config.find("values.key0") == nullptr)
+            {
+                std::cerr << "a file being written is published" << std::endl;
+                errors++;
+                break;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        file << "values:\n    key0: -1\n";
+        file.close();
+
+        for(int n=0; n<100 && config.version() == version; n++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        const config_struct *value = config.read()->config.find("values.key0");
+
+        if(value == nullptr || value->intVal[0] != -1)
+        {
+            std::cerr << "a written file is not published" << std::endl;
+            errors++;
+        }
+    }
+
+    // Readers beyond the reader slots share a counter, which keeps replaced
+    // snapshots until they are done
+    {
+        reloadableConfig                         config(fileName, false);
+        std::vector<reloadableConfig::snapshotRef> refs;
+
+        for(int n=0; n<200; n++)
+        {
+            refs.push_back(config.read());
+        }
+
+        writeConfig(7);
+        config.reload();
+
+        if(refs.back()->config.find("values.key0")->intVal[0] != -1 || config.read()->version != 2 ||
+           config.pendingSnapshots() != 1)
+        {
+            std::cerr << "readers without a slot" << std::endl;
+            errors++;
+        }
+
+        refs.clear();
+
+        if(config.pendingSnapshots() != 0)
+        {
+            std::cerr << "snapshots of readers without a slot are not freed" << std::endl;
+            errors++;
+        }
+    }
+
+    // A file which cannot be loaded at first gives an empty snapshot
+    std::remove(fileName);
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        reloadableConfig    config(fileName, false);
+
+        if(config.loaded() || config.read()->version != 0 || config.read()->config.size() != 0 ||
+           collector.records().size() != 1)
+        {
+            std::cerr << "missing file" << std::endl;
+            errors++;
+        }
+
+        writeConfig(3);
+
+        if(!config.reload() || !config.loaded() || config.read()->version != 1 ||
+           config.read()->config.find("values.key0")->intVal[0] != 3)
+        {
+            std::cerr << "missing file loaded later" << std::endl;
+            errors++;
+        }
+    }
+
+    std::cout << errors.load() << " errors" << std::endl;
+
+    std::remove(fileName);
+
+    return errors.load() == 0? 0 : 1;
+}
@@ -0,0 +1,142 @@
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "YConfParser.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of the structural scanner: every instruction set has to find the same
+// positions as a plain loop, and parsing through the structural index has to
+// give the same result as parsing line by line.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+// Parses line by line, searching every line end and colon
+static configList parseLines(std::string_view w_text)
+{
+    configList        config;
+    configListBuilder builder(config);
+    paramPath         path;
+    config_struct     value;
+
+    while(!w_text.empty())
+    {
+        size_t n = w_text.find('\n');
+        parseLineEvents(w_text.substr(0, n), path, value, builder);
+        w_text.remove_prefix(n == std::string_view::npos? w_text.size() : n + 1);
+    }
+
+    return config;
+}
+
+static void checkScan(const std::string &w_text, const std::string &w_name)
+{
+    std::vector<uint32_t> expected;
+
+    for(size_t i=0; i<w_text.size(); i++)
+    {
+        if(isStructural(w_text[i]))
+        {
+            expected.push_back((uint32_t)i);
+        }
+    }
+
+    for(scanLevel level : {scanLevel::SCALAR, scanLevel::SSE2, scanLevel::AVX2})
+    {
+        std::vector<uint32_t> positions(w_text.size());
+        positions.resize(scanStructural(w_text.data(), w_text.size(), positions.data(), level));
+
+        check(positions == expected, w_name + ": scan at level " + std::to_string((int)level));
+
+        structuralIndex index;
+        index.build(w_text, level);
+
+        check(std::vector<uint32_t>(index.begin(), index.end()) == expected,
+              w_name + ": index at level " + std::to_string((int)level));
+    }
+}
+
+static void checkParse(const std::string &w_text, const std::string &w_name)
+{
+    configList         expected = parseLines(w_text);
+    std::istringstream stream(w_text);
+
+    check(parseBuffer(w_text) == expected, w_name + ": parseBuffer");
+    check(parseStream(stream) == expected, w_name + ": parseStream");
+}
+
+
+int main()
+{
+    // Random text made of the characters the parser cares about
+    const char   alphabet[] = " \t\n\r:,#\"[]TRUEFALSE0123456789.-+ab";
+    std::mt19937 random(1);
+
+    for(int n=0; n<2000; n++)
+    {
+        std::string text(random() % 300, ' ');
+
+        for(auto &c : text)
+        {
+            c = alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+
+        checkScan(text, "random " + std::to_string(n));
+        checkParse(text, "random " + std::to_string(n));
+    }
+
+    // A configuration spanning several blocks of the indexed parser, with
+    // commas and colons inside strings
+    std::string text;
+
+    for(int k=0; k<100000; k++)
+    {
+        if(k % 50 == 0)
+        {
+            text += "section" + std::to_string(k) + ":\n";
+        }
+
+        text += "    param" + std::to_string(k) + ": [1, 2, 3,4]\n";
+
+        if(k % 7 == 0)
+        {
+            text += "    text" + std::to_string(k) + ": \"a, b: c\"\n";
+        }
+    }
+
+    checkScan(text, "large");
+    checkParse(text, "large");
+    checkParse(text.substr(0, text.size() - 1), "large without final line end");
+
+    // The index of a long line grows with its structural characters, not its size
+    {
+        std::string line(1 << 20, 'a');
+        line[1000] = ':';
+        line += "\n";
+
+        structuralIndex index;
+        index.build(line);
+
+        check(index.end() - index.begin() == 2 && index.begin()[1] == (1u << 20), "long line: positions");
+        check(index.positions.size() * sizeof(uint32_t) < line.size() / 4, "long line: index size");
+        checkParse(line, "long line");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
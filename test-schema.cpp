@@ -0,0 +1,140 @@
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "YConfParser.hpp"
+#include "YConfSchema.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of typed schemas: required and optional fields are bound into a
+// struct, optional fields take their default when they are missing or
+// mismatching, and missing required fields and type mismatches are reported
+// to the diagnostic collector.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+struct serverConfig
+{
+    int                      port;
+    float                    timeout;
+    bool                     verbose;
+    std::string              name;
+    std::vector<std::string> hosts;
+    std::vector<int>         ports;
+    std::vector<float>       weights;
+};
+
+static const auto serverSchema = makeSchema(
+    requiredField("server.port",    &serverConfig::port),
+    optionalField("server.timeout", &serverConfig::timeout, 1.5f),
+    optionalField("server.verbose", &serverConfig::verbose, false),
+    requiredField("server.name",    &serverConfig::name),
+    optionalField("server.hosts",   &serverConfig::hosts, {"localhost"}),
+    optionalField("server.ports",   &serverConfig::ports, {80}),
+    optionalField("server.weights", &serverConfig::weights, {1.0f}));
+
+
+int main()
+{
+    check(serverSchema.size() == 7, "size");
+
+    // All fields present
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer("server:\n"
+                                                 "    port: 8080\n"
+                                                 "    timeout: 2.5\n"
+                                                 "    verbose: TRUE\n"
+                                                 "    name: \"main\"\n"
+                                                 "    hosts: [\"a\", \"b\"]\n"
+                                                 "    ports: 443\n"
+                                                 "    weights: [1, 2]\n");
+        serverConfig        server{};
+
+        check(serverSchema.bind(config, server), "present: bound");
+        check(server.port == 8080 && server.timeout == 2.5f && server.verbose && server.name == "main" &&
+              server.hosts == std::vector<std::string>{"a", "b"} && server.ports == std::vector<int>{443} &&
+              server.weights == std::vector<float>{1.0f, 2.0f}, "present: values");
+        check(collector.records().empty(), "present: nothing reported");
+    }
+
+    // Optional fields take their defaults, integers are accepted for floats
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer("server:\n"
+                                                 "    port: 8080\n"
+                                                 "    name: \"main\"\n"
+                                                 "    timeout: 3\n");
+        bool                valid  = false;
+        serverConfig        server = serverSchema.bind(config, valid);
+
+        check(valid, "defaults: bound");
+        check(server.timeout == 3.0f && !server.verbose && server.hosts == std::vector<std::string>{"localhost"} &&
+              server.ports == std::vector<int>{80} && server.weights == std::vector<float>{1.0f}, "defaults: values");
+        check(collector.records().empty(), "defaults: nothing reported");
+    }
+
+    // A missing required field is reported and left unchanged
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer("server:\n"
+                                                 "    name: \"main\"\n");
+        serverConfig        server{};
+
+        server.port = 7;
+
+        check(!serverSchema.bind(config, server), "missing: not bound");
+        check(server.port == 7 && server.name == "main" && server.timeout == 1.5f, "missing: values");
+        check(collector.records().size() == 1 && collector.records()[0].code == parseDiagnostic::MISSING_FIELD &&
+              collector.records()[0].severity == parseDiagnostic::ERROR &&
+              collector.records()[0].message == "server.port: missing required parameter", "missing: reported");
+    }
+
+    // Type mismatches are reported; optional fields take their defaults
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        configList          config = parseBuffer("server:\n"
+                                                 "    port: \"8080\"\n"
+                                                 "    name: \"main\"\n"
+                                                 "    verbose: 1\n"
+                                                 "    hosts: [1, 2]\n"
+                                                 "    ports: [1.5, 2.5]\n");
+        serverConfig        server{};
+
+        server.port = 7;
+
+        check(!serverSchema.bind(config, server), "mismatch: not bound");
+        check(server.port == 7 && !server.verbose && server.hosts == std::vector<std::string>{"localhost"} &&
+              server.ports == std::vector<int>{80}, "mismatch: values");
+
+        const auto &records = collector.records();
+
+        check(records.size() == 4, "mismatch: all reported");
+
+        for(auto &r : records)
+        {
+            check(r.code == parseDiagnostic::FIELD_TYPE && r.severity == parseDiagnostic::ERROR, "mismatch: code");
+        }
+
+        check(records.size() > 0 && records[0].message == "server.port: expected integer, found string", "mismatch: message");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
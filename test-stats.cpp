@@ -0,0 +1,175 @@
+
+// The statistics are only collected with this switch
+#define YCONFPARSER_STATS
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "YConfParser.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of parse statistics: a known configuration gives known line,
+// parameter, type and array counts, its problems are recorded with their
+// lines instead of being printed, and only parses inside the scope count.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static size_t allocationCount = 0;
+
+// The replacements are not inlined, so that the compiler does not pair a
+// free() with the operator new of the caller (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void* operator new(size_t w_size)
+{
+    allocationCount++;
+
+    if(void *p = malloc(w_size == 0? 1 : w_size))
+    {
+        return p;
+    }
+
+    throw std::bad_alloc();
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void *w_ptr) noexcept
+{
+    free(w_ptr);
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void *w_ptr, size_t) noexcept
+{
+    free(w_ptr);
+}
+
+static const std::string text =
+    "a: 1\n"                        // 1   INTEGER
+    "b:\n"                          // 2   no value
+    "    c: \"x\"\n"                // 3   STRING
+    "    d: [1.5, 2.5]\n"           // 4   FLOAT array
+    "e: TRUE\n"                     // 5   BOOLEAN
+    "f: 5000000000\n"               // 6   INT64
+    "g: 0x10\n"                     // 7   UINT64
+    "h: 3.141592653589793\n"        // 8   DOUBLE
+    "no colon\n"                    // 9   missing colon (error)
+    "i: [1, x]\n"                   // 10  unknown type (error), INTEGER array of one
+    "  \tj: 2\n";                   // 11  TAB after space (warning), INTEGER
+
+static void checkStats(const parseStats &w_stats, const std::string &w_name)
+{
+    typedef config_struct::type_ type_;
+
+    const uint64_t typeCounts[8] = {1, 1, 1, 1, 3, 1, 1, 1};
+
+    check(w_stats.lines == 11 && w_stats.params == 10 && w_stats.bytes == text.size(), w_name + ": lines");
+
+    for(size_t t=0; t<8; t++)
+    {
+        check(w_stats.typeCounts[t] == typeCounts[t], w_name + ": count of type " + std::to_string(t));
+    }
+
+    check(w_stats.typeCounts[(size_t)type_::DOUBLE] == 1, w_name + ": type order");
+    check(w_stats.arrays == 2 && w_stats.arrayElements == 3, w_name + ": arrays");
+
+    check(w_stats.errors.size() == 2 && w_stats.warnings.size() == 1, w_name + ": problems");
+
+    if(w_stats.errors.size() == 2 && w_stats.warnings.size() == 1)
+    {
+        check(w_stats.errors[0].code == parseDiagnostic::MISSING_COLON && w_stats.errors[0].line == 9, w_name + ": error 1");
+        check(w_stats.errors[1].code == parseDiagnostic::UNKNOWN_TYPE && w_stats.errors[1].line == 10 &&
+              w_stats.errors[1].column == 8, w_name + ": error 2");
+        check(w_stats.warnings[0].code == parseDiagnostic::TAB_AFTER_SPACE && w_stats.warnings[0].line == 11,
+              w_name + ": warning");
+    }
+
+    check(w_stats.phaseNanos[parseStats::TOKENIZE] > 0 && w_stats.phaseNanos[parseStats::CLASSIFY] > 0 &&
+          w_stats.phaseNanos[parseStats::ARRAYS] > 0 && w_stats.phaseNanos[parseStats::INSERT] > 0,
+          w_name + ": phases");
+}
+
+
+int main()
+{
+    {
+        parseStats stats;
+        configList config;
+
+        stats.allocationCounter = []() { return allocationCount; };
+
+        {
+            parseStatsScope scope(stats);
+            config = parseBuffer(text);
+        }
+
+        checkStats(stats, "parseBuffer");
+        check(stats.phaseNanos[parseStats::SCAN] > 0, "parseBuffer: scan phase");
+        check(stats.allocations > 0, "parseBuffer: allocations");
+        check(config.size() == 9, "parseBuffer: result");
+
+        // Parses outside of the scope are not counted
+        diagnosticCollector collector;
+        diagnosticScope     diagnostics(collector);
+
+        parseBuffer(text);
+        check(stats.lines == 11 && collector.records().size() == 3, "outside of the scope");
+    }
+
+    {
+        parseStats         stats;
+        std::istringstream stream(text);
+
+        {
+            parseStatsScope scope(stats);
+            parseStream(stream);
+        }
+
+        checkStats(stats, "parseStream");
+        check(stats.phaseNanos[parseStats::READ] > 0, "parseStream: read phase");
+        check(stats.allocations == 0, "parseStream: no allocation counter");
+    }
+
+    // Nested scopes: the inner one gets the inner parses
+    {
+        parseStats outer;
+        parseStats inner;
+
+        {
+            parseStatsScope outerScope(outer);
+            parseBuffer("a: 1\n");
+
+            {
+                parseStatsScope innerScope(inner);
+                parseBuffer(text);
+            }
+
+            parseBuffer("b: 2\n");
+        }
+
+        checkStats(inner, "inner scope");
+        check(outer.lines == 2 && outer.params == 2 && outer.errors.empty(), "outer scope");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
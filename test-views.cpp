@@ -0,0 +1,156 @@
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "YConfArena.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Test of configView: walking a subtree has to give exactly the parameters of
+// parseBuffer whose names start with the name of the subtree, and relative
+// lookups have to find the same values as full names.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+template<typename T, typename U>
+static bool sameElements(arrayView<T> w_view, const std::vector<U> &w_vals)
+{
+    if(w_view.size() != w_vals.size())
+    {
+        return false;
+    }
+
+    for(size_t n=0; n<w_vals.size(); n++)
+    {
+        if(!(w_view[n] == w_vals[n]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool sameValue(const arenaValue *w_value, const config_struct &w_config)
+{
+    if(w_value == nullptr || w_value->type != w_config.type)
+    {
+        return false;
+    }
+
+    switch(w_config.type)
+    {
+        case config_struct::type_::STRING:  return sameElements(w_value->stringArray(), w_config.stringVal);
+        case config_struct::type_::BOOLEAN: return sameElements(w_value->boolArray(), w_config.boolVal);
+        case config_struct::type_::FLOAT:   return sameElements(w_value->floatArray(), w_config.floatVal);
+        case config_struct::type_::INTEGER: return sameElements(w_value->intArray(), w_config.intVal);
+        case config_struct::type_::INT64:   return sameElements(w_value->int64Array(), w_config.int64Val);
+        case config_struct::type_::UINT64:  return sameElements(w_value->uint64Array(), w_config.uint64Val);
+        case config_struct::type_::DOUBLE:  return sameElements(w_value->doubleArray(), w_config.doubleVal);
+        default:                            return false;
+    }
+}
+
+// Parameters of w_config in the subtree of w_prefix (all of them for the root)
+static size_t countUnder(const configList &w_config, const std::string &w_prefix, bool w_root)
+{
+    size_t count = 0;
+
+    for(auto &c : w_config)
+    {
+        if(w_root || c.first == w_prefix || c.first.compare(0, w_prefix.size() + 1, w_prefix + ".") == 0)
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static void checkText(const std::string &w_text, const std::string &w_name)
+{
+    configList  expected = parseBuffer(w_text);
+    arenaConfig arena    = parseBufferToArena(w_text);
+
+    // Every subtree holds the parameters below its name
+    std::vector<configView> views = {arena.root()};
+
+    for(size_t n=0; n<views.size(); n++)
+    {
+        configView  view   = views[n];
+        std::string prefix = view.fullName();
+        size_t      count  = 0;
+        size_t      kids   = 0;
+
+        view.forEachValue([&](configView w_sub)
+        {
+            std::string name = w_sub.fullName();
+            auto        it   = expected.find(name);
+
+            count++;
+            check(it != expected.end() && sameValue(w_sub.value(), it->second), w_name + ": value of " + name);
+
+            // Relative lookup from the subtree
+            if(!view.isRoot() && w_sub != view)
+            {
+                check(view.find(name.substr(prefix.size() + 1)) == w_sub.value(), w_name + ": relative " + name);
+            }
+        });
+
+        check(count == countUnder(expected, prefix, view.isRoot()), w_name + ": subtree " + prefix);
+
+        for(configView child : view)
+        {
+            check(child.parent() == view, w_name + ": parent of " + child.fullName());
+            views.push_back(child);
+            kids++;
+        }
+
+        check(kids == view.childCount(), w_name + ": children of " + prefix);
+    }
+}
+
+
+int main()
+{
+    // Random text made of the characters the parser cares about
+    const char   alphabet[] = " \t\n\r:,#\"[]TRUEFALSE0123456789.-+ab";
+    std::mt19937 random(1);
+
+    for(int n=0; n<2000; n++)
+    {
+        std::string text(random() % 300, ' ');
+
+        for(auto &c : text)
+        {
+            c = alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+
+        checkText(text, "random " + std::to_string(n));
+    }
+
+    checkText("a:\n  b: 1\n  c:\n    d: 2\na.c.e: 3\nf: 4\n", "dotted names");
+
+    arenaConfig config = parseFileToArena("config-sample.txt");
+    configView  list   = config.view("glossary.GlossDiv.GlossList");
+
+    check(list.valid() && list.childCount() == 1 && list.at("GlossEntry").childCount() == 10, "config-sample.txt children");
+    check(list.find("GlossEntry.GlossDef.para") == config.find("glossary.GlossDiv.GlossList.GlossEntry.GlossDef.para"),
+          "config-sample.txt relative lookup");
+    check(!config.view("glossary.none").valid() && !list.at("none").at("x").valid(), "missing subtrees");
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}
@@ -0,0 +1,223 @@
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "YConfWriter.hpp"
+
+using namespace ylibs::yconfparser;
+
+
+// Round-trip test of configWriter: the text written for a configuration list
+// has to parse back to the same parameters and values, whatever the output.
+// Parameters and files which cannot be written are reported to the
+// diagnostic collector.
+
+static size_t errors = 0;
+
+static void check(bool w_condition, const std::string &w_what)
+{
+    if(!w_condition)
+    {
+        std::cerr << "failed: " << w_what << std::endl;
+        errors++;
+    }
+}
+
+static bool sameValue(const config_struct &w_a, const config_struct &w_b)
+{
+    return w_a.type == w_b.type && w_a.stringVal == w_b.stringVal && w_a.boolVal == w_b.boolVal &&
+           w_a.floatVal == w_b.floatVal && w_a.intVal == w_b.intVal && w_a.int64Val == w_b.int64Val &&
+           w_a.uint64Val == w_b.uint64Val && w_a.doubleVal == w_b.doubleVal;
+}
+
+static bool sameConfig(const configList &w_a, const configList &w_b)
+{
+    if(w_a.size() != w_b.size())
+    {
+        return false;
+    }
+
+    for(auto &c : w_a)
+    {
+        auto it = w_b.find(c.first);
+
+        if(it == w_b.end() || !sameValue(c.second, it->second))
+        {
+            std::cerr << "differs: " << c.first << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void checkRoundTrip(const configList &w_config, const std::string &w_name)
+{
+    std::string text;
+
+    check(writeConfiguration(w_config, text), w_name + ": written");
+    check(sameConfig(w_config, parseBuffer(text)), w_name + ": round trip");
+
+    // Writing the text of the text gives the same text
+    std::string again;
+
+    writeConfiguration(parseBuffer(text), again);
+    check(again == text, w_name + ": stable text");
+}
+
+static config_struct value(config_struct::type_ w_type)
+{
+    config_struct value;
+    value.type = w_type;
+    return value;
+}
+
+
+int main()
+{
+    // Random text made of the characters the parser cares about
+    const char   alphabet[] = " \t\n\r:,#\"[]TRUEFALSE0123456789.-+ab";
+    std::mt19937 random(1);
+
+    for(int n=0; n<2000; n++)
+    {
+        std::string text(random() % 300, ' ');
+
+        for(auto &c : text)
+        {
+            c = alphabet[random() % (sizeof(alphabet) - 1)];
+        }
+
+        checkRoundTrip(parseBuffer(text), "random " + std::to_string(n));
+    }
+
+    configList sample = parseFile("config-sample.txt");
+    checkRoundTrip(sample, "config-sample.txt");
+
+    // Values and names which need care
+    configList config;
+
+    config["floats"] = value(config_struct::type_::FLOAT);
+    config["floats"].floatVal = {1.0f, -0.0f, 0.1f, 3.4028235e38f, 1e-45f, 1e20f, 16777216.0f, 2213170048.0f};
+    config["ints"] = value(config_struct::type_::INTEGER);
+    config["ints"].intVal = {0, -1, 2147483647, -2147483647 - 1};
+    config["string"] = value(config_struct::type_::STRING);
+    config["string"].stringVal = {"a, \"b\": [c] # d "};
+    config["strings"] = value(config_struct::type_::STRING);
+    config["strings"].stringVal = {" x ", "TRUE", "1.5"};
+    config["int64s"] = value(config_struct::type_::INT64);
+    config["int64s"].int64Val = {0, -1, INT64_MAX, INT64_MIN};
+    config["uint64s"] = value(config_struct::type_::UINT64);
+    config["uint64s"].uint64Val = {0, 64u << 20, UINT64_MAX};
+    config["doubles"] = value(config_struct::type_::DOUBLE);
+    config["doubles"].doubleVal = {0.1, 1e300, 3.141592653589793, 16777217.0, 5e-324};
+    config["bools"] = value(config_struct::type_::BOOLEAN);
+    config["bools"].boolVal = {1, 0, 1};
+    config["a. b.#c..d"] = config["ints"];
+    config["a"] = config["bools"];
+    config["a.b"] = config["string"];
+    config["a.b c.d\t"] = config["floats"];
+    config["x."] = config["string"];
+
+    checkRoundTrip(config, "special values");
+
+    // Parameters without a text form are skipped
+    configList invalid = config;
+
+    invalid["line break"] = value(config_struct::type_::STRING);
+    invalid["line break"].stringVal = {"a\nb"};
+    invalid["not finite"] = value(config_struct::type_::FLOAT);
+    invalid["not finite"].floatVal = {1.0f, NAN};
+    invalid["not finite double"] = value(config_struct::type_::DOUBLE);
+    invalid["not finite double"].doubleVal = {INFINITY};
+    invalid["colon: in name"] = config["ints"];
+    invalid["#comment"] = config["ints"];
+    invalid["empty"] = value(config_struct::type_::STRING);
+    invalid["empty"].stringVal = {"a", ""};
+
+    {
+        diagnosticCollector collector;
+        diagnosticScope     scope(collector);
+        std::string         text;
+
+        check(!writeConfiguration(invalid, text), "invalid parameters are reported");
+        check(collector.records().size() == 6, "invalid parameters: diagnostics");
+
+        for(auto &d : collector.records())
+        {
+            check(d.code == parseDiagnostic::UNWRITABLE_PARAM && d.severity == parseDiagnostic::ERROR,
+                  "invalid parameters: code");
+        }
+
+        collector.clear();
+        check(sameConfig(config, parseBuffer(text)) && collector.records().empty(), "valid parameters are written");
+
+        check(!writeConfigurationFile(config, "no-such-dir/test-writer.tmp") && collector.records().size() == 1 &&
+              collector.records()[0].code == parseDiagnostic::FILE_OPEN, "unwritable file: diagnostics");
+    }
+
+    // Buffer of the caller: the length is known also when it is too small
+    {
+        std::string expected;
+        writeConfiguration(sample, expected);
+
+        std::vector<char> buffer(expected.size());
+        configWriter      fitting(buffer.data(), buffer.size());
+
+        fitting.write(sample);
+        check(!fitting.overflow() && fitting.length() == expected.size() &&
+              std::string(buffer.data(), buffer.size()) == expected, "buffer");
+
+        configWriter small(buffer.data(), 16);
+
+        small.write(sample);
+        check(small.overflow() && small.length() == expected.size(), "small buffer");
+    }
+
+    // File descriptor, with text of several blocks
+    {
+        configList large;
+
+        for(int k=0; k<20000; k++)
+        {
+            std::string section = "section" + std::to_string(k / 100) + ".param" + std::to_string(k % 100);
+
+            large[section] = value(config_struct::type_::FLOAT);
+            large[section].floatVal = {k * 0.37f, -k * 1e-7f};
+        }
+
+        std::string expected;
+        writeConfiguration(large, expected);
+        check(expected.size() > 4 * configWriter::bufferSize, "large text");
+
+        const char *name = "test-writer.tmp";
+
+        check(writeConfigurationFile(large, name), "file written");
+        check(sameConfig(large, parseFile(name)), "file round trip");
+
+        std::ifstream file(name, std::ios::binary);
+        std::string   content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        check(content == expected, "file text");
+        remove(name);
+    }
+
+    // Appending to a string
+    {
+        std::string text = "# header\n";
+        configWriter writer(text);
+
+        writer.write(sample);
+        writer.flush();
+        check(text.compare(0, 9, "# header\n") == 0 && sameConfig(sample, parseBuffer(text)), "append");
+    }
+
+    std::cout << (errors == 0? "passed" : "FAILED") << std::endl;
+    return errors == 0? 0 : 1;
+}